@@ -719,6 +719,20 @@ auto Binder::BindAExpr(duckdb_libpgquery::PGAExpr *root) -> std::unique_ptr<Boun
   BUSTUB_ASSERT(root, "nullptr");
   auto name = std::string((reinterpret_cast<duckdb_libpgquery::PGValue *>(root->name->head->data.ptr_value))->val.str);
 
+  if (root->kind == duckdb_libpgquery::PG_AEXPR_BETWEEN || root->kind == duckdb_libpgquery::PG_AEXPR_NOT_BETWEEN) {
+    // a BETWEEN x AND y 改写成 a >= x AND a <= y，NOT BETWEEN改写成 a < x OR a > y
+    auto bounds = reinterpret_cast<duckdb_libpgquery::PGList *>(root->rexpr);
+    auto bound_exprs = BindExpressionList(bounds);
+    if (bound_exprs.size() != 2) {
+      throw bustub::Exception("BETWEEN should have 2 bounds");
+    }
+    const bool negated = root->kind == duckdb_libpgquery::PG_AEXPR_NOT_BETWEEN;
+    auto lower = std::make_unique<BoundBinaryOp>(negated ? "<" : ">=", BindExpression(root->lexpr),
+                                                 std::move(bound_exprs[0]));
+    auto upper = std::make_unique<BoundBinaryOp>(negated ? ">" : "<=", BindExpression(root->lexpr),
+                                                 std::move(bound_exprs[1]));
+    return std::make_unique<BoundBinaryOp>(negated ? "or" : "and", std::move(lower), std::move(upper));
+  }
   if (root->kind != duckdb_libpgquery::PG_AEXPR_OP) {
     throw bustub::Exception("unsupported op in AExpr");
   }
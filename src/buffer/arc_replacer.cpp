@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/arc_replacer.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace bustub {
+
+ArcReplacer::ArcReplacer(size_t num_frames)
+    : queue_(num_frames, Queue::NONE),
+      pos_(num_frames),
+      page_ids_(num_frames, INVALID_PAGE_ID),
+      evictable_(num_frames, false),
+      replacer_size_(num_frames) {}
+
+auto ArcReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto &preferred = PreferredList();
+  auto &other = &preferred == &t1_ ? t2_ : t1_;
+  for (auto *list : {&preferred, &other}) {
+    for (auto rit = list->rbegin(); rit != list->rend(); ++rit) {
+      if (!evictable_[*rit]) {
+        continue;
+      }
+      *frame_id = *rit;
+      if (page_ids_[*frame_id] != INVALID_PAGE_ID) {
+        (list == &t1_ ? b1_ : b2_).PushFront(page_ids_[*frame_id]);
+      }
+      Untrack(*frame_id);
+      TrimGhosts();
+      return true;
+    }
+  }
+  return false;
+}
+
+void ArcReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_) {
+    throw std::invalid_argument(std::string("Invalid frame_id") + std::to_string(frame_id));
+  }
+  if (queue_[frame_id] != Queue::NONE) {
+    // 再次访问：移到T2的MRU端
+    (queue_[frame_id] == Queue::T1 ? t1_ : t2_).erase(pos_[frame_id]);
+    t2_.push_front(frame_id);
+    pos_[frame_id] = t2_.begin();
+    queue_[frame_id] = Queue::T2;
+    return;
+  }
+
+  if (page_id != INVALID_PAGE_ID && b1_.Contains(page_id)) {
+    // B1命中：T1给小了
+    const size_t delta = std::max<size_t>(b2_.Size() / b1_.Size(), 1);
+    target_t1_size_ = std::min(target_t1_size_ + delta, replacer_size_);
+    b1_.Erase(page_id);
+    queue_[frame_id] = Queue::T2;
+  } else if (page_id != INVALID_PAGE_ID && b2_.Contains(page_id)) {
+    // B2命中：T2给小了
+    const size_t delta = std::max<size_t>(b1_.Size() / b2_.Size(), 1);
+    target_t1_size_ = target_t1_size_ > delta ? target_t1_size_ - delta : 0;
+    b2_.Erase(page_id);
+    queue_[frame_id] = Queue::T2;
+  } else {
+    queue_[frame_id] = Queue::T1;
+  }
+  auto &list = queue_[frame_id] == Queue::T1 ? t1_ : t2_;
+  list.push_front(frame_id);
+  pos_[frame_id] = list.begin();
+  page_ids_[frame_id] = page_id;
+  evictable_[frame_id] = true;
+  curr_size_++;
+  TrimGhosts();
+}
+
+void ArcReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_) {
+    throw std::invalid_argument(std::string("Invalid frame_id") + std::to_string(frame_id));
+  }
+  if (queue_[frame_id] == Queue::NONE || evictable_[frame_id] == set_evictable) {
+    return;
+  }
+  evictable_[frame_id] = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+void ArcReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_ || queue_[frame_id] == Queue::NONE) {
+    return;
+  }
+  if (!evictable_[frame_id]) {
+    throw std::logic_error(std::string("Can't remove an inevictable frame ") + std::to_string(frame_id));
+  }
+  Untrack(frame_id);
+}
+
+auto ArcReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  std::vector<frame_id_t> candidates;
+  auto &preferred = PreferredList();
+  auto &other = &preferred == &t1_ ? t2_ : t1_;
+  for (auto *list : {&preferred, &other}) {
+    for (auto rit = list->rbegin(); rit != list->rend() && candidates.size() < max_frames; ++rit) {
+      if (evictable_[*rit]) {
+        candidates.push_back(*rit);
+      }
+    }
+  }
+  return candidates;
+}
+
+auto ArcReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return curr_size_;
+}
+
+auto ArcReplacer::GetTargetT1Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return target_t1_size_;
+}
+
+auto ArcReplacer::PreferredList() -> std::list<frame_id_t> & {
+  return !t1_.empty() && (t1_.size() > target_t1_size_ || t2_.empty()) ? t1_ : t2_;
+}
+
+void ArcReplacer::Untrack(frame_id_t frame_id) {
+  (queue_[frame_id] == Queue::T1 ? t1_ : t2_).erase(pos_[frame_id]);
+  queue_[frame_id] = Queue::NONE;
+  page_ids_[frame_id] = INVALID_PAGE_ID;
+  evictable_[frame_id] = false;
+  curr_size_--;
+}
+
+void ArcReplacer::TrimGhosts() {
+  while (!b1_.Empty() && t1_.size() + b1_.Size() > replacer_size_) {
+    b1_.PopBack();
+  }
+  while (t1_.size() + t2_.size() + b1_.Size() + b2_.Size() > 2 * replacer_size_) {
+    (b2_.Empty() ? b1_ : b2_).PopBack();
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,48 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_manager.cpp
+//
+// Identification: src/buffer/buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_pool_manager.h"
+
+#include "storage/page/page_guard.h"
+
+namespace bustub {
+
+auto BufferPoolManager::FetchPages(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> {
+  std::vector<Page *> pages;
+  pages.reserve(page_ids.size());
+  for (auto page_id : page_ids) {
+    pages.push_back(FetchPage(page_id));
+  }
+  return pages;
+}
+
+void BufferPoolManager::UnpinPages(const std::vector<page_id_t> &page_ids, bool is_dirty) {
+  for (auto page_id : page_ids) {
+    UnpinPage(page_id, is_dirty);
+  }
+}
+
+auto BufferPoolManager::FetchPageBasic(page_id_t page_id) -> BasicPageGuard { return {this, FetchPage(page_id)}; }
+
+auto BufferPoolManager::FetchPageRead(page_id_t page_id, BufferAccessStrategy *strategy) -> ReadPageGuard {
+  return {this, strategy == nullptr ? FetchPage(page_id) : FetchPageWithStrategy(page_id, strategy)};
+}
+
+auto BufferPoolManager::FetchPageWrite(page_id_t page_id) -> WritePageGuard { return {this, FetchPage(page_id)}; }
+
+auto BufferPoolManager::FetchPageOptimistic(page_id_t page_id) -> OptimisticPageGuard {
+  return {this, FetchPage(page_id)};
+}
+
+auto BufferPoolManager::NewPageGuarded(page_id_t *page_id) -> BasicPageGuard { return {this, NewPage(page_id)}; }
+
+}  // namespace bustub
@@ -12,18 +12,74 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+
+#include "buffer/arc_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/two_queue_replacer.h"
 #include "common/exception.h"
 #include "common/macros.h"
 
 namespace bustub {
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k,
-                                                     LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
-  // we allocate a consecutive memory space for the buffer pool
+                                                     LogManager *log_manager, ReplacerType replacer_type)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, replacer_k, log_manager, replacer_type) {}
+
+BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances,
+                                                     uint32_t instance_index, DiskManager *disk_manager,
+                                                     size_t replacer_k, LogManager *log_manager,
+                                                     ReplacerType replacer_type)
+    : pool_size_(pool_size),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      disk_manager_(disk_manager),
+      disk_scheduler_(new DiskScheduler(disk_manager)),
+      log_manager_(log_manager) {
+  BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
+  BUSTUB_ASSERT(
+      instance_index < num_instances,
+      "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 0.");
+  // we allocate a consecutive memory space for the buffer pool: the frame data in an arena of its own, the metadata in
+  // an array of cache-line-aligned Page objects
+  int numa_node = buffer_pool_numa_aware ? static_cast<int>(instance_index % FrameArena::NumaNodeCount()) : -1;
+  frame_arena_ = new FrameArena(pool_size_, buffer_pool_huge_pages, numa_node);
   pages_ = new Page[pool_size_];
-  page_table_ = new ExtendibleHashTable<page_id_t, frame_id_t>(bucket_size_);
-  replacer_ = new LRUKReplacer(pool_size, replacer_k);
+  for (size_t i = 0; i < pool_size_; ++i) {
+    pages_[i].data_ = frame_arena_->GetFrameData(static_cast<frame_id_t>(i));
+  }
+  page_table_ = new PageTable(pool_size);
+  switch (replacer_type) {
+    case ReplacerType::LRU_K:
+      replacer_ = new LRUKReplacer(pool_size, replacer_k);
+      break;
+    case ReplacerType::LRU:
+      replacer_ = new LRUReplacer(pool_size);
+      break;
+    case ReplacerType::CLOCK:
+      replacer_ = new ClockReplacer(pool_size);
+      break;
+    case ReplacerType::TWO_Q:
+      replacer_ = new TwoQueueReplacer(pool_size);
+      break;
+    case ReplacerType::ARC:
+      replacer_ = new ArcReplacer(pool_size);
+      break;
+  }
+  // 空闲的frame用pin_count_ = -1锁住，无锁的命中路径无法pin住它们
+  for (size_t i = 0; i < pool_size_; ++i) {
+    pages_[i].pin_count_ = -1;
+  }
+  size_t access_ring_size = 64;
+  while (access_ring_size < pool_size_) {
+    access_ring_size <<= 1;
+  }
+  access_ring_ = std::vector<std::atomic<frame_id_t>>(access_ring_size);
+  for (auto &slot : access_ring_) {
+    slot = -1;
+  }
 
   // Initially, every page is in the free list.
   // for (size_t i = 0; i < pool_size_; ++i) {
@@ -32,6 +88,7 @@ BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManag
 
   free_list_.resize(pool_size);
   std::iota(free_list_.begin(), free_list_.end(), 0);
+  io_in_progress_.resize(pool_size, false);
   // TODO(students): remove this line after you have implemented the buffer pool manager
   // throw NotImplementedException(
   //     "BufferPoolManager is not implemented yet. If you have finished implementing BPM, please remove the throw "
@@ -39,67 +96,231 @@ BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManag
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
+  StopPageCleanerThread();
+  StopPrefetchThreads();
+  delete disk_scheduler_;
   delete[] pages_;
+  delete frame_arena_;
   delete page_table_;
   delete replacer_;
 }
 
 auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
-  std::scoped_lock<std::mutex> lock(latch_);
+  auto *page = NewPageImpl(INVALID_PAGE_ID);
+  if (page != nullptr) {
+    *page_id = page->GetPageId();
+  }
+  return page;
+}
+
+auto BufferPoolManagerInstance::NewPageInExtent(page_id_t *page_id, ExtentAllocator *extent) -> Page * {
+  if (extent == nullptr) {
+    return NewPage(page_id);
+  }
+  const page_id_t new_page_id = extent->Allocate(disk_manager_->GetFreeSpaceMap());
+  auto *page = NewPageImpl(new_page_id);
+  if (page == nullptr) {
+    // 建不出来的page还给free space map，不能留在extent外面泄漏
+    DeallocatePage(new_page_id);
+    return nullptr;
+  }
+  *page_id = new_page_id;
+  return page;
+}
+
+auto BufferPoolManagerInstance::NewPageWithId(page_id_t page_id) -> Page * { return NewPageImpl(page_id); }
+
+auto BufferPoolManagerInstance::NewPageImpl(page_id_t page_id) -> Page * {
+  std::unique_lock<std::mutex> lock(latch_);
   frame_id_t available_frame_id = -1;
   // 找不到有效的
   if (!FindVictim(&available_frame_id)) {
+    failed_fetches_++;
     return nullptr;
   }
-  page_id_t new_page_id = AllocatePage();
-  pages_[available_frame_id].ResetMemory();
-  pages_[available_frame_id].page_id_ = new_page_id;
-  pages_[available_frame_id].pin_count_ = 1;
-  pages_[available_frame_id].is_dirty_ = false;
-  replacer_->RecordAccess(available_frame_id);
-  replacer_->SetEvictable(available_frame_id, false);
-  *page_id = new_page_id;
-  // std::cout << "new " << new_page_id << std::endl;
-  page_table_->Insert(new_page_id, available_frame_id);
+  const page_id_t new_page_id = page_id == INVALID_PAGE_ID ? AllocatePage() : page_id;
+  ValidatePageId(new_page_id);
+  ReserveFrame(&lock, available_frame_id, new_page_id);
+  // 新页面不需要从磁盘读取，直接结束I/O状态
+  FinishIo(available_frame_id);
   return &pages_[available_frame_id];
 }
 
-auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
-  std::scoped_lock<std::mutex> lock(latch_);
-  // std::cout << "fetch " << page_id << std::endl;
+auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * { return FetchPageImpl(page_id, nullptr); }
+
+auto BufferPoolManagerInstance::FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
+  return FetchPageImpl(page_id, strategy);
+}
+
+auto BufferPoolManagerInstance::FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
+  ValidatePageId(page_id);
+  std::unique_lock<std::mutex> lock(latch_, std::defer_lock);
   frame_id_t exist_frame_id = -1;
+  // 快速路径：不加latch查找page table，原子地pin住frame后再确认frame里确实是这个page
+  if (page_table_->Find(page_id, exist_frame_id) && TryPin(&pages_[exist_frame_id])) {
+    if (pages_[exist_frame_id].page_id_ == page_id) {
+      RecordAccessLossy(exist_frame_id);
+      RecordHit();
+      return &pages_[exist_frame_id];
+    }
+    // 读到了过期的表项，撤销pin后走慢速路径
+    lock.lock();
+    if (--pages_[exist_frame_id].pin_count_ == 0) {
+      replacer_->SetEvictable(exist_frame_id, true);
+    }
+  } else {
+    lock.lock();
+  }
+
   // 如果在缓存中找到了 直接返回找到的page
-  if (page_table_->Find(page_id, exist_frame_id)) {
-    replacer_->RecordAccess(exist_frame_id);
+  if (WaitForIo(&lock, page_id, &exist_frame_id)) {
+    replacer_->RecordAccess(exist_frame_id, page_id);
     replacer_->SetEvictable(exist_frame_id, false);
     pages_[exist_frame_id].pin_count_++;
+    RecordHit();
     return &pages_[exist_frame_id];
   }
 
+  const auto miss_start = std::chrono::steady_clock::now();
   frame_id_t available_frame_id = -1;
-  // 没有可用的frame分配 返回空
-  if (!FindVictim(&available_frame_id)) {
+  // 大扫描优先复用自己环里的frame，不去挤占其他页面；没有可用的frame分配 返回空
+  if ((strategy == nullptr || !RecycleRingFrame(strategy, &available_frame_id)) && !FindVictim(&available_frame_id)) {
+    failed_fetches_++;
     return nullptr;
   }
+  if (strategy != nullptr) {
+    strategy->Advance(page_id);
+  }
+  ReserveFrame(&lock, available_frame_id, page_id);
 
-  pages_[available_frame_id].ResetMemory();
-  pages_[available_frame_id].page_id_ = page_id;
-  pages_[available_frame_id].pin_count_ = 1;
-  pages_[available_frame_id].is_dirty_ = false;
-  // 从磁盘中读入数据
-  disk_manager_->ReadPage(page_id, pages_[available_frame_id].GetData());
-  replacer_->RecordAccess(available_frame_id);
-  // 有正在使用改page的用户 设置不可弹出
-  replacer_->SetEvictable(available_frame_id, false);
-  page_table_->Insert(page_id, available_frame_id);
+  // 从磁盘中读入数据，读取期间不持有latch，同一page的其他请求在该frame上等待
+  lock.unlock();
+  try {
+    disk_manager_->ReadPage(page_id, pages_[available_frame_id].GetData());
+  } catch (const Exception &) {
+    // 损坏的page不能留在pool里，归还frame后把错误交给调用者
+    lock.lock();
+    AbortIo(available_frame_id);
+    throw;
+  }
+  lock.lock();
+  FinishIo(available_frame_id);
+  RecordMiss(miss_start);
   return &pages_[available_frame_id];
 }
 
+auto BufferPoolManagerInstance::FetchPages(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> {
+  std::vector<Page *> pages(page_ids.size(), nullptr);
+  // 未命中的page在page_ids中的下标
+  std::vector<size_t> missing;
+  std::unique_lock<std::mutex> lock(latch_);
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    ValidatePageId(page_ids[i]);
+    frame_id_t frame_id = -1;
+    // 这时还没有为本批次预留任何frame，可以放心地等待别人的I/O
+    if (WaitForIo(&lock, page_ids[i], &frame_id)) {
+      replacer_->RecordAccess(frame_id, page_ids[i]);
+      replacer_->SetEvictable(frame_id, false);
+      pages_[frame_id].pin_count_++;
+      RecordHit();
+      pages[i] = &pages_[frame_id];
+    } else {
+      missing.push_back(i);
+    }
+  }
+  if (missing.empty()) {
+    return pages;
+  }
+
+  // 按page id排序，相同的page只读一次，读盘时也尽量顺序
+  std::stable_sort(missing.begin(), missing.end(), [&page_ids](size_t a, size_t b) { return page_ids[a] < page_ids[b]; });
+  const auto miss_start = std::chrono::steady_clock::now();
+  // 每次读盘对应missing中[first, last)这一段相同的page
+  struct BatchRead {
+    frame_id_t frame_id_;
+    size_t first_;
+    size_t last_;
+  };
+  std::vector<BatchRead> reads;
+  std::vector<size_t> deferred;
+  for (size_t first = 0, last = 0; first < missing.size(); first = last) {
+    const page_id_t page_id = page_ids[missing[first]];
+    while (last < missing.size() && page_ids[missing[last]] == page_id) {
+      last++;
+    }
+    frame_id_t frame_id = -1;
+    // ReserveFrame写回脏页时会放开latch，别的线程可能已经把这个page读进来或正在读，留到本批次的读完成之后再取
+    if (page_table_->Find(page_id, frame_id)) {
+      deferred.insert(deferred.end(), missing.begin() + first, missing.begin() + last);
+      continue;
+    }
+    if (!FindVictim(&frame_id)) {
+      failed_fetches_ += last - first;
+      continue;
+    }
+    ReserveFrame(&lock, frame_id, page_id);
+    reads.push_back({frame_id, first, last});
+  }
+
+  if (!reads.empty()) {
+    std::vector<page_id_t> read_page_ids;
+    std::vector<char *> read_data;
+    for (const auto &read : reads) {
+      read_page_ids.push_back(page_ids[missing[read.first_]]);
+      read_data.push_back(pages_[read.frame_id_].GetData());
+    }
+    lock.unlock();
+    try {
+      disk_scheduler_->ReadPages(read_page_ids, read_data);
+    } catch (const Exception &) {
+      // 不知道是哪个page坏了，整批都放弃：读入的frame全部归还，命中的page解除pin
+      lock.lock();
+      for (const auto &read : reads) {
+        AbortIo(read.frame_id_);
+      }
+      for (size_t i = 0; i < page_ids.size(); i++) {
+        if (pages[i] != nullptr) {
+          UnpinPageLocked(&lock, page_ids[i], false);
+        }
+      }
+      throw;
+    }
+    lock.lock();
+    for (const auto &read : reads) {
+      FinishIo(read.frame_id_);
+      // FinishIo只pin了一次，重复出现的page每次出现都要pin一次
+      pages_[read.frame_id_].pin_count_ += static_cast<int>(read.last_ - read.first_ - 1);
+      for (size_t k = read.first_; k < read.last_; k++) {
+        pages[missing[k]] = &pages_[read.frame_id_];
+      }
+      RecordMiss(miss_start);
+    }
+  }
+  lock.unlock();
+
+  for (auto i : deferred) {
+    pages[i] = FetchPageImpl(page_ids[i], nullptr);
+  }
+  return pages;
+}
+
 auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
+  std::unique_lock<std::mutex> lock(latch_);
+  return UnpinPageLocked(&lock, page_id, is_dirty);
+}
+
+void BufferPoolManagerInstance::UnpinPages(const std::vector<page_id_t> &page_ids, bool is_dirty) {
+  std::unique_lock<std::mutex> lock(latch_);
+  for (auto page_id : page_ids) {
+    UnpinPageLocked(&lock, page_id, is_dirty);
+  }
+}
+
+auto BufferPoolManagerInstance::UnpinPageLocked(std::unique_lock<std::mutex> *lock, page_id_t page_id, bool is_dirty)
+    -> bool {
   // std::cout << "unpin " << page_id << std::endl;
   frame_id_t frame_id = -1;
-  if (!page_table_->Find(page_id, frame_id)) {
+  if (!WaitForIo(lock, page_id, &frame_id)) {
     return false;
   }
   if (pages_[frame_id].GetPinCount() == 0) {
@@ -110,63 +331,116 @@ auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) ->
     replacer_->SetEvictable(frame_id, true);
   }
   if (is_dirty) {
-    pages_[frame_id].is_dirty_ = is_dirty;
+    MarkDirty(frame_id);
   }
   return true;
 }
 
 auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
+  std::unique_lock<std::mutex> lock(latch_);
   frame_id_t frame_id = -1;
-  if (!page_table_->Find(page_id, frame_id)) {
+  if (!WaitForIo(&lock, page_id, &frame_id)) {
     // page id is not present in the buffer pool
     return false;
   }
   // flush regardless of dirty or not
   disk_manager_->WritePage(page_id, pages_[frame_id].GetData());
-  pages_[frame_id].is_dirty_ = false;  // reset dirty flag regardless
+  MarkClean(frame_id);  // reset dirty flag regardless
 
   return true;
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
-  std::scoped_lock<std::mutex> lock(latch_);
-  for (size_t i = 0; i < pool_size_; i++) {
-    if (pages_[i].page_id_ != INVALID_PAGE_ID) {
-      // there is a valid physical page resides, regardless of dirty or not
-      disk_manager_->WritePage(pages_[i].page_id_, pages_[i].GetData());
-      pages_[i].is_dirty_ = false;
+  FlushDirtyPages();
+  // 刷盘之后的page分配情况与磁盘上的数据一致
+  disk_manager_->SaveFreeSpaceMap();
+}
+
+void BufferPoolManagerInstance::FlushDirtyPages() {
+  std::unique_lock<std::mutex> lock(latch_);
+  // 脏页表按page id有序，相邻的page合并成一个写请求，多个请求同时交给disk scheduler
+  std::vector<frame_id_t> frame_ids;
+  std::vector<bool> locked;
+  std::vector<page_id_t> page_ids;
+  std::vector<const char *> page_data;
+  for (const auto &[page_id, rec_lsn] : dirty_page_table_) {
+    frame_id_t frame_id = -1;
+    // frames with I/O in flight are being written back already
+    if (!page_table_->Find(page_id, frame_id) || io_in_progress_[frame_id]) {
+      continue;
+    }
+    // 没人pin住的frame和page cleaner一样锁成-1，写回期间不能被换出；被pin住的frame在写回完成前unpin会等待，也不会被换出
+    int expected = 0;
+    const bool unpinned = pages_[frame_id].pin_count_.compare_exchange_strong(expected, -1);
+    if (!unpinned && expected < 0) {
+      continue;
+    }
+    if (unpinned) {
+      replacer_->SetEvictable(frame_id, false);
     }
+    io_in_progress_[frame_id] = true;
+    frame_ids.push_back(frame_id);
+    locked.push_back(unpinned);
+    page_ids.push_back(page_id);
+    page_data.push_back(pages_[frame_id].GetData());
   }
+  // 和换出时的写回一样，写盘期间不持有latch
+  lock.unlock();
+  disk_scheduler_->WritePages(page_ids, page_data);
+  lock.lock();
+
+  for (size_t i = 0; i < frame_ids.size(); i++) {
+    MarkClean(frame_ids[i]);
+    if (locked[i]) {
+      pages_[frame_ids[i]].pin_count_ = 0;
+      replacer_->SetEvictable(frame_ids[i], true);
+    }
+    io_in_progress_[frame_ids[i]] = false;
+  }
+  io_cv_.notify_all();
 }
 
 auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
-  std::scoped_lock<std::mutex> lock(latch_);
+  std::unique_lock<std::mutex> lock(latch_);
   frame_id_t frame_id = -1;
-  if (!page_table_->Find(page_id, frame_id)) {
+  if (!WaitForIo(&lock, page_id, &frame_id)) {
+    // 不在缓存中的page也要归还给free space map
+    DeallocatePage(page_id);
     return true;
   }
-  if (pages_[frame_id].pin_count_ != 0) {
+  // 把pin_count_从0锁成-1，防止无锁路径在删除过程中pin住它
+  int expected = 0;
+  if (!pages_[frame_id].pin_count_.compare_exchange_strong(expected, -1)) {
     return false;
   }
 
-  if (pages_[frame_id].is_dirty_) {
-    disk_manager_->WritePage(pages_[frame_id].page_id_, pages_[frame_id].GetData());
-    pages_[frame_id].is_dirty_ = false;
-  }
+  // 删掉的page内容不再有用，不用写回，只从脏页表里去掉
+  MarkClean(frame_id);
 
   page_table_->Remove(page_id);
   replacer_->Remove(frame_id);
   free_list_.push_back(frame_id);
   pages_[frame_id].ResetMemory();
   pages_[frame_id].page_id_ = INVALID_PAGE_ID;
-  pages_[frame_id].pin_count_ = 0;
-  pages_[frame_id].is_dirty_ = false;
   DeallocatePage(page_id);
   return true;
 }
 
-auto BufferPoolManagerInstance::AllocatePage() -> page_id_t { return next_page_id_++; }
+auto BufferPoolManagerInstance::AllocatePage() -> page_id_t {
+  // 每个实例只分配与自己下标同余的page id，保证多个实例之间不会冲突；先复用删除过的page，文件不会无限增长
+  return disk_manager_->GetFreeSpaceMap()->Allocate(static_cast<page_id_t>(num_instances_),
+                                                    static_cast<page_id_t>(instance_index_));
+}
+
+void BufferPoolManagerInstance::DeallocatePage(page_id_t page_id) {
+  disk_manager_->GetFreeSpaceMap()->Deallocate(page_id);
+}
+
+void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
+  // allocated pages mod back to this BPI
+  BUSTUB_ASSERT(page_id % static_cast<page_id_t>(num_instances_) == static_cast<page_id_t>(instance_index_),
+                "page id does not belong to this buffer pool instance");
+}
 
 // 查找有效的frame   如果free_list为空且缓存中的都是不可evict的  则返回false
 auto BufferPoolManagerInstance::FindVictim(frame_id_t *available_frame_id) -> bool {
@@ -175,15 +449,350 @@ auto BufferPoolManagerInstance::FindVictim(frame_id_t *available_frame_id) -> bo
     free_list_.pop_back();
     return true;
   }
-  if (replacer_->Evict(available_frame_id)) {
-    if (pages_[*available_frame_id].IsDirty()) {
-      disk_manager_->WritePage(pages_[*available_frame_id].page_id_, pages_[*available_frame_id].GetData());
-      pages_[*available_frame_id].is_dirty_ = false;
+  DrainAccessRing();
+  while (replacer_->Evict(available_frame_id)) {
+    // 只有pin_count_能从0锁成-1的frame才能换出；失败说明无锁路径刚刚pin住了它，放回replacer
+    int expected = 0;
+    if (pages_[*available_frame_id].pin_count_.compare_exchange_strong(expected, -1)) {
+      evictions_++;
+      return true;
     }
-    page_table_->Remove(pages_[*available_frame_id].page_id_);
-    return true;
+    replacer_->RecordAccess(*available_frame_id, pages_[*available_frame_id].page_id_);
+    replacer_->SetEvictable(*available_frame_id, false);
   }
   return false;
 }
 
+auto BufferPoolManagerInstance::RecycleRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id) -> bool {
+  // 和PostgreSQL一样，只限制读入的page超过整个pool四分之一的扫描，小表反复扫描时仍然留在pool里
+  if (strategy->GetPagesRead() < pool_size_ * num_instances_ / 4) {
+    return false;
+  }
+  const page_id_t page_id = strategy->GetRecyclablePage();
+  if (page_id == INVALID_PAGE_ID || !page_table_->Find(page_id, *frame_id) || io_in_progress_[*frame_id] ||
+      pages_[*frame_id].page_id_ != page_id) {
+    return false;
+  }
+  // 和FindVictim一样，只有没人pin住的frame才能锁成-1后复用
+  int expected = 0;
+  if (!pages_[*frame_id].pin_count_.compare_exchange_strong(expected, -1)) {
+    return false;
+  }
+  replacer_->Remove(*frame_id);
+  evictions_++;
+  return true;
+}
+
+auto BufferPoolManagerInstance::TryPin(Page *page) -> bool {
+  int pin_count = page->pin_count_.load();
+  while (pin_count >= 0) {
+    if (page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void BufferPoolManagerInstance::RecordAccessLossy(frame_id_t frame_id) {
+  const size_t pos = access_ring_head_.fetch_add(1, std::memory_order_relaxed);
+  access_ring_[pos & (access_ring_.size() - 1)].store(frame_id, std::memory_order_relaxed);
+}
+
+void BufferPoolManagerInstance::DrainAccessRing() {
+  const size_t head = access_ring_head_.load();
+  size_t pos = head - access_ring_tail_ > access_ring_.size() ? head - access_ring_.size() : access_ring_tail_;
+  for (; pos != head; ++pos) {
+    frame_id_t frame_id = access_ring_[pos & (access_ring_.size() - 1)].exchange(-1, std::memory_order_relaxed);
+    // 记录之后frame可能已经被换出或删除，只有仍然持有page的frame才在replacer中
+    if (frame_id != -1 && pages_[frame_id].pin_count_ >= 0) {
+      replacer_->RecordAccess(frame_id, pages_[frame_id].page_id_);
+    }
+  }
+  access_ring_tail_ = head;
+}
+
+auto BufferPoolManagerInstance::WaitForIo(std::unique_lock<std::mutex> *lock, page_id_t page_id, frame_id_t *frame_id)
+    -> bool {
+  // 被唤醒后必须重新查找：等待期间该frame可能已经换成了其他page
+  while (page_table_->Find(page_id, *frame_id)) {
+    if (!io_in_progress_[*frame_id]) {
+      return true;
+    }
+    const auto wait_start = std::chrono::steady_clock::now();
+    io_cv_.wait(*lock);
+    pin_wait_ns_ += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - wait_start)
+                        .count();
+  }
+  return false;
+}
+
+void BufferPoolManagerInstance::ReserveFrame(std::unique_lock<std::mutex> *lock, frame_id_t frame_id,
+                                             page_id_t page_id) {
+  Page &page = pages_[frame_id];
+  const page_id_t old_page_id = page.page_id_;
+  io_in_progress_[frame_id] = true;
+  // 先把新page映射到该frame上，之后对同一page的请求会等待这次I/O而不是重复读取
+  page_table_->Insert(page_id, frame_id);
+
+  if (page.IsDirty()) {
+    foreground_cleaned_pages_++;
+    // 写回期间旧page仍然映射在该frame上，访问旧page的请求会等待写回完成后再从磁盘读取
+    lock->unlock();
+    disk_manager_->WritePage(old_page_id, page.GetData());
+    lock->lock();
+    MarkClean(frame_id);
+  }
+  if (old_page_id != INVALID_PAGE_ID) {
+    page_table_->Remove(old_page_id);
+  }
+
+  page.ResetMemory();
+  page.page_id_ = page_id;
+  page.is_dirty_ = false;
+  // 被换出的旧page的等待者需要重新查找
+  io_cv_.notify_all();
+}
+
+void BufferPoolManagerInstance::FinishIo(frame_id_t frame_id, bool pin) {
+  io_in_progress_[frame_id] = false;
+  pages_[frame_id].pin_count_ = pin ? 1 : 0;
+  replacer_->RecordAccess(frame_id, pages_[frame_id].page_id_);
+  // 有正在使用改page的用户 设置不可弹出
+  replacer_->SetEvictable(frame_id, !pin);
+  io_cv_.notify_all();
+}
+
+void BufferPoolManagerInstance::AbortIo(frame_id_t frame_id) {
+  Page &page = pages_[frame_id];
+  page_table_->Remove(page.page_id_);
+  page.ResetMemory();
+  page.page_id_ = INVALID_PAGE_ID;
+  io_in_progress_[frame_id] = false;
+  // 还是被锁住的空闲frame，等待这个page的请求醒来后找不到它，会自己去读
+  free_list_.push_back(frame_id);
+  io_cv_.notify_all();
+}
+
+void BufferPoolManagerInstance::PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) {
+  std::unique_lock<std::mutex> lock(latch_);
+  if (prefetch_threads_.empty()) {
+    for (int i = 0; i < PREFETCH_WORKER_NUM; i++) {
+      prefetch_threads_.emplace_back([this] { PrefetchLoop(); });
+    }
+  }
+  const page_id_t high_water_mark = disk_manager_->GetFreeSpaceMap()->GetNextPageId();
+  for (auto page_id : page_ids) {
+    // 拒绝还没有分配过的page id，否则会从磁盘读到垃圾数据
+    if (page_id < 0 || page_id >= high_water_mark ||
+        page_id % static_cast<page_id_t>(num_instances_) != static_cast<page_id_t>(instance_index_)) {
+      continue;
+    }
+    frame_id_t frame_id;
+    if (page_table_->Find(page_id, frame_id) ||
+        std::any_of(prefetch_queue_.begin(), prefetch_queue_.end(),
+                    [page_id](const auto &entry) { return entry.first == page_id; })) {
+      continue;
+    }
+    // 预读的page不应该把整个pool都冲掉
+    if (prefetch_queue_.size() >= std::max(pool_size_ / 2, static_cast<size_t>(1))) {
+      break;
+    }
+    // 为大扫描预读时当场从环里拿frame，worker直接读进这个frame
+    frame_id = -1;
+    if (strategy != nullptr) {
+      if (RecycleRingFrame(strategy, &frame_id)) {
+        ReserveFrame(&lock, frame_id, page_id);
+      }
+      strategy->Advance(page_id);
+    }
+    prefetch_queue_.emplace_back(page_id, frame_id);
+  }
+  prefetch_cv_.notify_all();
+}
+
+void BufferPoolManagerInstance::PrefetchLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    prefetch_cv_.wait(lock, [this] { return prefetch_shutdown_ || !prefetch_queue_.empty(); });
+    if (prefetch_shutdown_) {
+      return;
+    }
+    auto [page_id, frame_id] = prefetch_queue_.front();
+    prefetch_queue_.pop_front();
+    if (frame_id == -1) {
+      // 已经被别人读进来了，或者没有可以换出的frame，放弃这次预读
+      if (page_table_->Find(page_id, frame_id) || !FindVictim(&frame_id)) {
+        continue;
+      }
+      ReserveFrame(&lock, frame_id, page_id);
+    }
+    lock.unlock();
+    try {
+      disk_manager_->ReadPage(page_id, pages_[frame_id].GetData());
+    } catch (const Exception &) {
+      // 预读失败不报错，之后真正读这个page时会再读一次并报告错误
+      lock.lock();
+      AbortIo(frame_id);
+      continue;
+    }
+    lock.lock();
+    FinishIo(frame_id, false);
+    prefetched_pages_++;
+  }
+}
+
+auto BufferPoolManagerInstance::GetDirtyPageTable() -> std::map<page_id_t, lsn_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return dirty_page_table_;
+}
+
+void BufferPoolManagerInstance::MarkDirty(frame_id_t frame_id) {
+  Page &page = pages_[frame_id];
+  if (!page.is_dirty_) {
+    page.is_dirty_ = true;
+    // 第一次变脏时page上最新的LSN就是使它变脏的那条日志
+    dirty_page_table_.emplace(page.page_id_, page.GetLSN());
+  }
+}
+
+void BufferPoolManagerInstance::MarkClean(frame_id_t frame_id) {
+  Page &page = pages_[frame_id];
+  if (page.is_dirty_) {
+    page.is_dirty_ = false;
+    dirty_page_table_.erase(page.page_id_);
+  }
+}
+
+auto BufferPoolManagerInstance::GetStats() -> BufferPoolStats {
+  BufferPoolStats stats;
+  stats.pool_size_ = pool_size_;
+  stats.hits_ = hits_.Load();
+  stats.misses_ = misses_;
+  stats.miss_latency_ns_ = miss_latency_ns_;
+  stats.failed_fetches_ = failed_fetches_;
+  stats.evictions_ = evictions_;
+  stats.dirty_writes_ = foreground_cleaned_pages_;
+  stats.background_writes_ = background_cleaned_pages_;
+  stats.prefetched_pages_ = prefetched_pages_;
+  stats.pin_wait_ns_ = pin_wait_ns_;
+  return stats;
+}
+
+void BufferPoolManagerInstance::RecordHit() {
+  hits_.Add(1);
+  if (auto *object_stats = AccessStatsScope::Current(); object_stats != nullptr) {
+    object_stats->hits_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void BufferPoolManagerInstance::RecordMiss(std::chrono::steady_clock::time_point start) {
+  misses_++;
+  miss_latency_ns_ +=
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  if (auto *object_stats = AccessStatsScope::Current(); object_stats != nullptr) {
+    object_stats->misses_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+void BufferPoolManagerInstance::StopPrefetchThreads() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    prefetch_shutdown_ = true;
+  }
+  prefetch_cv_.notify_all();
+  for (auto &thread : prefetch_threads_) {
+    thread.join();
+  }
+  prefetch_threads_.clear();
+}
+
+void BufferPoolManagerInstance::RunPageCleanerThread(std::chrono::milliseconds interval, double target_clean_ratio) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (page_cleaner_enabled_) {
+    return;
+  }
+  page_cleaner_enabled_ = true;
+  page_cleaner_thread_ =
+      std::thread([this, interval, target_clean_ratio] { PageCleanerLoop(interval, target_clean_ratio); });
+}
+
+void BufferPoolManagerInstance::StopPageCleanerThread() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    page_cleaner_enabled_ = false;
+  }
+  page_cleaner_cv_.notify_all();
+  if (page_cleaner_thread_.joinable()) {
+    page_cleaner_thread_.join();
+  }
+}
+
+void BufferPoolManagerInstance::PageCleanerLoop(std::chrono::milliseconds interval, double target_clean_ratio) {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (page_cleaner_enabled_) {
+    page_cleaner_cv_.wait_for(lock, interval, [this] { return !page_cleaner_enabled_; });
+    if (!page_cleaner_enabled_) {
+      break;
+    }
+    CleanPages(&lock, target_clean_ratio);
+  }
+}
+
+void BufferPoolManagerInstance::CleanPages(std::unique_lock<std::mutex> *lock, double target_clean_ratio) {
+  // 从replacer的冷端开始，这些frame最先被换出
+  DrainAccessRing();
+  auto candidates = replacer_->EvictionCandidates(pool_size_);
+  size_t clean_cnt = 0;
+  for (auto frame_id : candidates) {
+    if (!pages_[frame_id].IsDirty()) {
+      clean_cnt++;
+    }
+  }
+  const auto target_clean_cnt = static_cast<size_t>(target_clean_ratio * static_cast<double>(candidates.size()));
+  if (clean_cnt >= target_clean_cnt) {
+    return;
+  }
+  const size_t batch_size = std::min(target_clean_cnt - clean_cnt, static_cast<size_t>(PAGE_CLEANER_BATCH_SIZE));
+
+  std::vector<frame_id_t> batch;
+  for (auto frame_id : candidates) {
+    if (batch.size() == batch_size) {
+      break;
+    }
+    if (!pages_[frame_id].IsDirty() || io_in_progress_[frame_id]) {
+      continue;
+    }
+    // 写回期间不允许换出也不允许pin，对该page的请求等待写回完成，保证写出的内容与清除的dirty标记一致
+    int expected = 0;
+    if (!pages_[frame_id].pin_count_.compare_exchange_strong(expected, -1)) {
+      continue;
+    }
+    io_in_progress_[frame_id] = true;
+    replacer_->SetEvictable(frame_id, false);
+    batch.push_back(frame_id);
+  }
+  // 按page id排序，让一批写尽量顺序
+  std::sort(batch.begin(), batch.end(),
+            [this](frame_id_t a, frame_id_t b) { return pages_[a].page_id_ < pages_[b].page_id_; });
+
+  std::vector<page_id_t> page_ids;
+  std::vector<const char *> page_data;
+  for (auto frame_id : batch) {
+    page_ids.push_back(pages_[frame_id].page_id_);
+    page_data.push_back(pages_[frame_id].GetData());
+  }
+  lock->unlock();
+  disk_scheduler_->WritePages(page_ids, page_data);
+  lock->lock();
+
+  for (auto frame_id : batch) {
+    MarkClean(frame_id);
+    pages_[frame_id].pin_count_ = 0;
+    io_in_progress_[frame_id] = false;
+    replacer_->SetEvictable(frame_id, true);
+  }
+  background_cleaned_pages_ += batch.size();
+  io_cv_.notify_all();
+}
+
 }  // namespace bustub
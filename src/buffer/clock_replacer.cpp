@@ -12,18 +12,112 @@
 
 #include "buffer/clock_replacer.h"
 
+#include <stdexcept>
+#include <string>
+
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : ref_(num_pages), tracked_(num_pages), evictable_(num_pages, false), replacer_size_(num_pages) {
+  for (size_t i = 0; i < num_pages; i++) {
+    ref_[i].store(false, std::memory_order_relaxed);
+    tracked_[i].store(false, std::memory_order_relaxed);
+  }
+}
 
 ClockReplacer::~ClockReplacer() = default;
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto ClockReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (curr_size_ == 0) {
+    return false;
+  }
+  // 转两圈后所有可换出frame的引用位都被清过一次；如果还有并发的访问不断把它们置位，就不再看引用位
+  const size_t max_steps = 2 * replacer_size_;
+  for (size_t step = 0;; step++) {
+    const auto candidate = static_cast<frame_id_t>(hand_);
+    hand_ = (hand_ + 1) % replacer_size_;
+    if (!tracked_[candidate].load(std::memory_order_relaxed) || !evictable_[candidate]) {
+      continue;
+    }
+    if (step < max_steps && ref_[candidate].exchange(false, std::memory_order_relaxed)) {
+      continue;
+    }
+    *frame_id = candidate;
+    tracked_[candidate].store(false, std::memory_order_release);
+    evictable_[candidate] = false;
+    curr_size_--;
+    return true;
+  }
+}
+
+void ClockReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id) {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_) {
+    throw std::invalid_argument(std::string("Invalid frame_id") + std::to_string(frame_id));
+  }
+  // 已经在跟踪的frame只需要置引用位，不用加锁
+  if (tracked_[frame_id].load(std::memory_order_acquire)) {
+    ref_[frame_id].store(true, std::memory_order_relaxed);
+    return;
+  }
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (!tracked_[frame_id].load(std::memory_order_relaxed)) {
+    tracked_[frame_id].store(true, std::memory_order_release);
+    evictable_[frame_id] = true;
+    curr_size_++;
+  }
+  ref_[frame_id].store(true, std::memory_order_relaxed);
+}
+
+void ClockReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_) {
+    throw std::invalid_argument(std::string("Invalid frame_id") + std::to_string(frame_id));
+  }
+  if (!tracked_[frame_id].load(std::memory_order_relaxed) || evictable_[frame_id] == set_evictable) {
+    return;
+  }
+  evictable_[frame_id] = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_ ||
+      !tracked_[frame_id].load(std::memory_order_relaxed)) {
+    return;
+  }
+  if (!evictable_[frame_id]) {
+    throw std::logic_error(std::string("Can't remove an inevictable frame ") + std::to_string(frame_id));
+  }
+  tracked_[frame_id].store(false, std::memory_order_release);
+  evictable_[frame_id] = false;
+  curr_size_--;
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+auto ClockReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  std::vector<frame_id_t> candidates;
+  // 从指针处开始，先是引用位已经清掉的frame，再是下一圈才会被换出的frame
+  for (bool referenced : {false, true}) {
+    for (size_t i = 0; i < replacer_size_ && candidates.size() < max_frames; i++) {
+      const auto frame_id = static_cast<frame_id_t>((hand_ + i) % replacer_size_);
+      if (tracked_[frame_id].load(std::memory_order_relaxed) && evictable_[frame_id] &&
+          ref_[frame_id].load(std::memory_order_relaxed) == referenced) {
+        candidates.push_back(frame_id);
+      }
+    }
+  }
+  return candidates;
+}
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+auto ClockReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return curr_size_;
+}
 
 }  // namespace bustub
@@ -0,0 +1,94 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <fstream>
+#include <string>
+
+#include "common/exception.h"
+
+#ifdef __linux__
+#include <linux/mempolicy.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+constexpr size_t HUGE_PAGE_SIZE = 2 << 20;
+
+}  // namespace
+
+FrameArena::FrameArena(size_t num_frames, HugePageMode mode, int numa_node) : mode_(mode) {
+  // 按大页大小对齐，使整个区域都能由大页映射
+  size_t bytes = std::max<size_t>(num_frames, 1) * BUSTUB_PAGE_SIZE;
+  length_ = mode == HugePageMode::NONE ? bytes : (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+
+  void *data = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  if (mode_ == HugePageMode::EXPLICIT) {
+    data = mmap(nullptr, length_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+  }
+#endif
+  if (data == MAP_FAILED) {
+    // 没有预留的大页时退回到透明大页
+    if (mode_ == HugePageMode::EXPLICIT) {
+      mode_ = HugePageMode::TRANSPARENT;
+    }
+    data = mmap(nullptr, length_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (data == MAP_FAILED) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "cannot map the frames of the buffer pool");
+    }
+#ifdef MADV_HUGEPAGE
+    if (mode_ == HugePageMode::TRANSPARENT && madvise(data, length_, MADV_HUGEPAGE) != 0) {
+      mode_ = HugePageMode::NONE;
+    }
+#else
+    mode_ = HugePageMode::NONE;
+#endif
+  }
+  data_ = static_cast<char *>(data);
+
+#if defined(__linux__) && defined(SYS_mbind)
+  // 绑定失败（单节点机器、容器限制等）时不影响正确性，只是不再保证内存的位置
+  if (numa_node >= 0 && numa_node < NumaNodeCount() && numa_node < static_cast<int>(8 * sizeof(uint64_t))) {
+    uint64_t node_mask = static_cast<uint64_t>(1) << numa_node;
+    if (syscall(SYS_mbind, data_, length_, MPOL_BIND, &node_mask, 8 * sizeof(node_mask), 0) == 0) {
+      numa_node_ = numa_node;
+    }
+  }
+#endif
+}
+
+FrameArena::~FrameArena() { munmap(data_, length_); }
+
+auto FrameArena::NumaNodeCount() -> int {
+  // 形如 "0" 或 "0-3" 或 "0,2-3"，最大的节点号加一即为节点数
+  std::ifstream online("/sys/devices/system/node/online");
+  std::string nodes;
+  if (!(online >> nodes)) {
+    return 1;
+  }
+  auto last = nodes.find_last_of(",-");
+  try {
+    return std::stoi(last == std::string::npos ? nodes : nodes.substr(last + 1)) + 1;
+  } catch (const std::logic_error &e) {
+    return 1;
+  }
+}
+
+}  // namespace bustub
@@ -12,105 +12,176 @@
 
 #include "buffer/lru_k_replacer.h"
 
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
 namespace bustub {
 
-LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k) : replacer_size_(num_frames), k_(k) {}
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k)
+    : access_count_(num_frames, 0),
+      history_(num_frames * k, 0),
+      evictable_(num_frames, false),
+      hist_heap_(num_frames),
+      cache_heap_(num_frames),
+      replacer_size_(num_frames),
+      k_(k) {
+  BUSTUB_ASSERT(k > 0, "k must be positive");
+}
 
 auto LRUKReplacer::Evict(frame_id_t *frame_id) -> bool {
   std::scoped_lock<std::mutex> lock(latch_);
-  bool victim_found = false;
-  if (!hist_list_.empty()) {
-    // rbegin():倒数第一个元素
-    for (auto rit = hist_list_.rbegin(); rit != hist_list_.rend(); ++rit) {
-      // 判断是否可以移除
-      if (entries_[*rit].evictable_) {
-        *frame_id = *rit;
-        // std::next会让反向迭代器指向下一个迭代器如【1，2，3，4，5】 当当前指向5 调用next指向4
-        // base会让反向迭代器转为正向迭代器，并指向正向的下一个  即5.
-        hist_list_.erase(std::next(rit).base());
-        victim_found = true;
-        break;
-      }
-    }
-  }
-  if (!victim_found && !cache_list_.empty()) {
-    for (auto rit = cache_list_.rbegin(); rit != cache_list_.rend(); ++rit) {
-      if (entries_[*rit].evictable_) {
-        *frame_id = *rit;
-        cache_list_.erase(std::next(rit).base());
-        victim_found = true;
-        break;
-      }
-    }
+  // 访问次数不足k次的frame的k-距离是+inf，总是先于其他frame被换出
+  FrameHeap *heap = !hist_heap_.Empty() ? &hist_heap_ : &cache_heap_;
+  if (heap->Empty()) {
+    return false;
   }
-  if (victim_found) {
-    entries_.erase(*frame_id);
-    --curr_size_;
-    return true;
-  }
-  return false;
+  *frame_id = heap->Top();
+  heap->Remove(*frame_id);
+  access_count_[*frame_id] = 0;
+  evictable_[*frame_id] = false;
+  return true;
 }
 
-void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id) {
   std::scoped_lock<std::mutex> lock(latch_);
-  if (frame_id > static_cast<int>(replacer_size_)) {
-    throw std::invalid_argument(std::string("Invalid frame_id") + std::to_string(frame_id));
-  }
+  CheckFrameId(frame_id);
 
-  size_t new_count = ++entries_[frame_id].hit_count_;
-  // 第一次加入
-  if (new_count == 1) {
-    ++curr_size_;
-    hist_list_.emplace_front(frame_id);
-    // list 不会因为list改变而使iterator发生改变
-    entries_[frame_id].pos_ = hist_list_.begin();
-  } else {
-    // 到达k次 加入到cache
-    if (new_count == k_) {
-      hist_list_.erase(entries_[frame_id].pos_);
-      cache_list_.emplace_front(frame_id);
-      entries_[frame_id].pos_ = cache_list_.begin();
-    } else if (new_count > k_) {  // k次以上，放到队头
-      cache_list_.erase(entries_[frame_id].pos_);
-      cache_list_.emplace_front(frame_id);
-      entries_[frame_id].pos_ = cache_list_.begin();
-    }
+  const size_t count = access_count_[frame_id]++;
+  history_[frame_id * k_ + count % k_] = current_timestamp_++;
+  if (count == 0) {
+    // 第一次加入，默认可以被换出
+    evictable_[frame_id] = true;
+    hist_heap_.Push(frame_id, KeyOf(frame_id));
+    return;
+  }
+  if (!evictable_[frame_id]) {
+    return;
+  }
+  if (count + 1 == k_) {
+    // 到达k次 从hist移到cache
+    hist_heap_.Remove(frame_id);
+    cache_heap_.Push(frame_id, KeyOf(frame_id));
+  } else if (count + 1 > k_) {
+    cache_heap_.Update(frame_id, KeyOf(frame_id));
   }
 }
 
 void LRUKReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
   std::scoped_lock<std::mutex> lock(latch_);
-  if (frame_id > static_cast<int>(replacer_size_)) {
-    throw std::invalid_argument(std::string("Invalid frame_id") + std::to_string(frame_id));
-  }
-  if (entries_.find(frame_id) == entries_.end()) {
+  CheckFrameId(frame_id);
+  if (access_count_[frame_id] == 0 || evictable_[frame_id] == set_evictable) {
     return;
   }
-  if (set_evictable && !entries_[frame_id].evictable_) {
-    ++curr_size_;
-  } else if (entries_[frame_id].evictable_ && !set_evictable) {
-    --curr_size_;
+  evictable_[frame_id] = set_evictable;
+  FrameHeap &heap = access_count_[frame_id] < k_ ? hist_heap_ : cache_heap_;
+  if (set_evictable) {
+    heap.Push(frame_id, KeyOf(frame_id));
+  } else {
+    heap.Remove(frame_id);
   }
-  entries_[frame_id].evictable_ = set_evictable;
 }
 
 void LRUKReplacer::Remove(frame_id_t frame_id) {
   std::scoped_lock<std::mutex> lock(latch_);
-  if (entries_.find(frame_id) == entries_.end()) {
+  CheckFrameId(frame_id);
+  if (access_count_[frame_id] == 0) {
     return;
   }
-  if (!entries_[frame_id].evictable_) {
+  if (!evictable_[frame_id]) {
     throw std::logic_error(std::string("Can't remove an inevictable frame ") + std::to_string(frame_id));
   }
-  if (entries_[frame_id].hit_count_ < k_) {
-    hist_list_.erase(entries_[frame_id].pos_);
-  } else {
-    cache_list_.erase(entries_[frame_id].pos_);
+  (access_count_[frame_id] < k_ ? hist_heap_ : cache_heap_).Remove(frame_id);
+  access_count_[frame_id] = 0;
+  evictable_[frame_id] = false;
+}
+
+auto LRUKReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  std::vector<frame_id_t> candidates;
+  // 与Evict的顺序一致：先hist_heap_，再cache_heap_，各自按key从小到大
+  for (auto *heap : {&hist_heap_, &cache_heap_}) {
+    if (candidates.size() >= max_frames) {
+      break;
+    }
+    auto entries = heap->Entries();
+    const size_t n = std::min(max_frames - candidates.size(), entries.size());
+    std::partial_sort(entries.begin(), entries.begin() + n, entries.end());
+    for (size_t i = 0; i < n; i++) {
+      candidates.push_back(entries[i].second);
+    }
   }
-  --curr_size_;
-  entries_.erase(frame_id);
+  return candidates;
 }
 
-auto LRUKReplacer::Size() -> size_t { return curr_size_; }
+auto LRUKReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return hist_heap_.Size() + cache_heap_.Size();
+}
+
+auto LRUKReplacer::KeyOf(frame_id_t frame_id) const -> size_t {
+  const size_t count = access_count_[frame_id];
+  // 不足k次时取最早的一次访问，否则取倒数第k次访问；环里下一个要写的位置正好是倒数第k次
+  return history_[frame_id * k_ + (count < k_ ? 0 : count % k_)];
+}
+
+void LRUKReplacer::CheckFrameId(frame_id_t frame_id) const {
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_) {
+    throw std::invalid_argument(std::string("Invalid frame_id") + std::to_string(frame_id));
+  }
+}
+
+void LRUKReplacer::FrameHeap::Push(frame_id_t frame_id, size_t key) {
+  pos_[frame_id] = static_cast<int64_t>(heap_.size());
+  heap_.emplace_back(key, frame_id);
+  SiftUp(heap_.size() - 1);
+}
+
+void LRUKReplacer::FrameHeap::Remove(frame_id_t frame_id) {
+  const auto i = static_cast<size_t>(pos_[frame_id]);
+  Swap(i, heap_.size() - 1);
+  heap_.pop_back();
+  pos_[frame_id] = -1;
+  if (i < heap_.size()) {
+    SiftUp(i);
+    SiftDown(i);
+  }
+}
+
+void LRUKReplacer::FrameHeap::Update(frame_id_t frame_id, size_t key) {
+  const auto i = static_cast<size_t>(pos_[frame_id]);
+  heap_[i].first = key;
+  SiftUp(i);
+  SiftDown(i);
+}
+
+void LRUKReplacer::FrameHeap::SiftUp(size_t i) {
+  while (i > 0 && heap_[i] < heap_[(i - 1) / 2]) {
+    Swap(i, (i - 1) / 2);
+    i = (i - 1) / 2;
+  }
+}
+
+void LRUKReplacer::FrameHeap::SiftDown(size_t i) {
+  while (true) {
+    size_t smallest = i;
+    for (size_t child = 2 * i + 1; child <= 2 * i + 2 && child < heap_.size(); child++) {
+      if (heap_[child] < heap_[smallest]) {
+        smallest = child;
+      }
+    }
+    if (smallest == i) {
+      return;
+    }
+    Swap(i, smallest);
+    i = smallest;
+  }
+}
+
+void LRUKReplacer::FrameHeap::Swap(size_t i, size_t j) {
+  std::swap(heap_[i], heap_[j]);
+  pos_[heap_[i].second] = static_cast<int64_t>(i);
+  pos_[heap_[j].second] = static_cast<int64_t>(j);
+}
 
 }  // namespace bustub
@@ -12,18 +12,91 @@
 
 #include "buffer/lru_replacer.h"
 
+#include <stdexcept>
+#include <string>
+
 namespace bustub {
 
-LRUReplacer::LRUReplacer(size_t num_pages) {}
+LRUReplacer::LRUReplacer(size_t num_pages)
+    : pos_(num_pages), tracked_(num_pages, false), evictable_(num_pages, false), replacer_size_(num_pages) {}
 
 LRUReplacer::~LRUReplacer() = default;
 
-auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto LRUReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (auto rit = lru_list_.rbegin(); rit != lru_list_.rend(); ++rit) {
+    if (evictable_[*rit]) {
+      *frame_id = *rit;
+      lru_list_.erase(std::next(rit).base());
+      tracked_[*frame_id] = false;
+      evictable_[*frame_id] = false;
+      curr_size_--;
+      return true;
+    }
+  }
+  return false;
+}
+
+void LRUReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_) {
+    throw std::invalid_argument(std::string("Invalid frame_id") + std::to_string(frame_id));
+  }
+  if (tracked_[frame_id]) {
+    lru_list_.erase(pos_[frame_id]);
+  } else {
+    tracked_[frame_id] = true;
+    evictable_[frame_id] = true;
+    curr_size_++;
+  }
+  lru_list_.push_front(frame_id);
+  pos_[frame_id] = lru_list_.begin();
+}
+
+void LRUReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_) {
+    throw std::invalid_argument(std::string("Invalid frame_id") + std::to_string(frame_id));
+  }
+  if (!tracked_[frame_id] || evictable_[frame_id] == set_evictable) {
+    return;
+  }
+  evictable_[frame_id] = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
 
-void LRUReplacer::Pin(frame_id_t frame_id) {}
+void LRUReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_ || !tracked_[frame_id]) {
+    return;
+  }
+  if (!evictable_[frame_id]) {
+    throw std::logic_error(std::string("Can't remove an inevictable frame ") + std::to_string(frame_id));
+  }
+  lru_list_.erase(pos_[frame_id]);
+  tracked_[frame_id] = false;
+  evictable_[frame_id] = false;
+  curr_size_--;
+}
 
-void LRUReplacer::Unpin(frame_id_t frame_id) {}
+auto LRUReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  std::vector<frame_id_t> candidates;
+  for (auto rit = lru_list_.rbegin(); rit != lru_list_.rend() && candidates.size() < max_frames; ++rit) {
+    if (evictable_[*rit]) {
+      candidates.push_back(*rit);
+    }
+  }
+  return candidates;
+}
 
-auto LRUReplacer::Size() -> size_t { return 0; }
+auto LRUReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return curr_size_;
+}
 
 }  // namespace bustub
@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_frames) {
+  // ReserveFrame可能让一个frame同时映射新旧两个page，所以最多有2 * num_frames个表项；
+  // 再留出一倍空间让装载因子不超过0.5
+  size_t capacity = 2;
+  int log2_capacity = 1;
+  while (capacity < 4 * num_frames) {
+    capacity <<= 1;
+    log2_capacity++;
+  }
+  slots_ = std::vector<std::atomic<uint64_t>>(capacity);
+  for (auto &slot : slots_) {
+    slot.store(EMPTY_SLOT, std::memory_order_relaxed);
+  }
+  mask_ = capacity - 1;
+  shift_ = 64 - log2_capacity;
+}
+
+auto PageTable::Find(page_id_t page_id, frame_id_t &frame_id) const -> bool {
+  for (size_t i = HomeOf(page_id);; i = (i + 1) & mask_) {
+    uint64_t slot = slots_[i].load(std::memory_order_acquire);
+    if (slot == EMPTY_SLOT) {
+      return false;
+    }
+    if (KeyOf(slot) == page_id) {
+      frame_id = ValueOf(slot);
+      return true;
+    }
+  }
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  BUSTUB_ASSERT(page_id != INVALID_PAGE_ID, "cannot map an invalid page id");
+  for (size_t i = HomeOf(page_id);; i = (i + 1) & mask_) {
+    uint64_t slot = slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT || KeyOf(slot) == page_id) {
+      slots_[i].store(Pack(page_id, frame_id), std::memory_order_release);
+      return;
+    }
+  }
+}
+
+auto PageTable::Remove(page_id_t page_id) -> bool {
+  size_t hole = HomeOf(page_id);
+  for (;; hole = (hole + 1) & mask_) {
+    uint64_t slot = slots_[hole].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      return false;
+    }
+    if (KeyOf(slot) == page_id) {
+      break;
+    }
+  }
+
+  // 线性探测的删除：把后面的表项往前移来填洞，而不是留下墓碑
+  for (size_t next = (hole + 1) & mask_;; next = (next + 1) & mask_) {
+    uint64_t slot = slots_[next].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      slots_[hole].store(EMPTY_SLOT, std::memory_order_release);
+      return true;
+    }
+    // 如果该表项的home位于(hole, next]之间，移动它会让它落到home之前，只能留在原地
+    size_t home = HomeOf(KeyOf(slot));
+    bool stays = hole <= next ? (hole < home && home <= next) : (hole < home || home <= next);
+    if (!stays) {
+      slots_[hole].store(slot, std::memory_order_release);
+      hole = next;
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,169 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include "common/exception.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                                                     DiskManager *disk_manager, size_t replacer_k,
+                                                     LogManager *log_manager, ReplacerType replacer_type)
+    : disk_manager_(disk_manager) {
+  BUSTUB_ENSURE(num_instances > 0, "ParallelBufferPoolManager needs at least one instance");
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; i++) {
+    instances_.emplace_back(std::make_unique<BufferPoolManagerInstance>(
+        pool_size, static_cast<uint32_t>(num_instances), static_cast<uint32_t>(i), disk_manager, replacer_k,
+        log_manager, replacer_type));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() = default;
+
+auto ParallelBufferPoolManager::GetPoolSize() -> size_t {
+  size_t pool_size = 0;
+  for (auto &instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+auto ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance * {
+  BUSTUB_ASSERT(page_id >= 0, "page id must be valid");
+  return instances_[static_cast<size_t>(page_id) % instances_.size()].get();
+}
+
+auto ParallelBufferPoolManager::FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
+  return GetBufferPoolManager(page_id)->FetchPageWithStrategy(page_id, strategy);
+}
+
+void ParallelBufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) {
+  std::vector<std::vector<page_id_t>> instance_page_ids(instances_.size());
+  for (auto page_id : page_ids) {
+    if (page_id >= 0) {
+      instance_page_ids[static_cast<size_t>(page_id) % instances_.size()].push_back(page_id);
+    }
+  }
+  for (size_t i = 0; i < instances_.size(); i++) {
+    if (!instance_page_ids[i].empty()) {
+      instances_[i]->PrefetchPages(instance_page_ids[i], strategy);
+    }
+  }
+}
+
+auto ParallelBufferPoolManager::FetchPages(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> {
+  // 记下每个page在page_ids中的位置，各实例取回后再放回原来的顺序
+  std::vector<std::vector<page_id_t>> instance_page_ids(instances_.size());
+  std::vector<std::vector<size_t>> instance_positions(instances_.size());
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    const size_t instance = static_cast<size_t>(page_ids[i]) % instances_.size();
+    instance_page_ids[instance].push_back(page_ids[i]);
+    instance_positions[instance].push_back(i);
+  }
+  std::vector<Page *> pages(page_ids.size(), nullptr);
+  for (size_t i = 0; i < instances_.size(); i++) {
+    if (instance_page_ids[i].empty()) {
+      continue;
+    }
+    auto instance_pages = instances_[i]->FetchPages(instance_page_ids[i]);
+    for (size_t j = 0; j < instance_pages.size(); j++) {
+      pages[instance_positions[i][j]] = instance_pages[j];
+    }
+  }
+  return pages;
+}
+
+void ParallelBufferPoolManager::UnpinPages(const std::vector<page_id_t> &page_ids, bool is_dirty) {
+  std::vector<std::vector<page_id_t>> instance_page_ids(instances_.size());
+  for (auto page_id : page_ids) {
+    instance_page_ids[static_cast<size_t>(page_id) % instances_.size()].push_back(page_id);
+  }
+  for (size_t i = 0; i < instances_.size(); i++) {
+    if (!instance_page_ids[i].empty()) {
+      instances_[i]->UnpinPages(instance_page_ids[i], is_dirty);
+    }
+  }
+}
+
+auto ParallelBufferPoolManager::GetDirtyPageTable() -> std::map<page_id_t, lsn_t> {
+  std::map<page_id_t, lsn_t> dirty_page_table;
+  for (auto &instance : instances_) {
+    dirty_page_table.merge(instance->GetDirtyPageTable());
+  }
+  return dirty_page_table;
+}
+
+auto ParallelBufferPoolManager::GetStats() -> BufferPoolStats {
+  BufferPoolStats stats;
+  for (auto &instance : instances_) {
+    stats += instance->GetStats();
+  }
+  return stats;
+}
+
+auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) -> Page * {
+  return GetBufferPoolManager(page_id)->FetchPage(page_id);
+}
+
+auto ParallelBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+auto ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+auto ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) -> Page * {
+  // 每次从不同的实例开始尝试，使新页面均匀分布到各个实例上
+  const size_t num_instances = instances_.size();
+  const size_t start = next_instance_.fetch_add(1) % num_instances;
+  for (size_t i = 0; i < num_instances; i++) {
+    auto *page = instances_[(start + i) % num_instances]->NewPage(page_id);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  return nullptr;
+}
+
+auto ParallelBufferPoolManager::NewPageInExtent(page_id_t *page_id, ExtentAllocator *extent) -> Page * {
+  if (extent == nullptr) {
+    return NewPage(page_id);
+  }
+  auto *free_space_map = disk_manager_->GetFreeSpaceMap();
+  const page_id_t new_page_id = extent->Allocate(free_space_map);
+  // extent里的page id是连续的，只能交给负责这个id的实例，不能换别的实例重试
+  auto *page = GetBufferPoolManager(new_page_id)->NewPageWithId(new_page_id);
+  if (page == nullptr) {
+    free_space_map->Deallocate(new_page_id);
+    return nullptr;
+  }
+  *page_id = new_page_id;
+  return page;
+}
+
+auto ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) -> bool {
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPgsImp() {
+  for (auto &instance : instances_) {
+    instance->FlushDirtyPages();
+  }
+  // 所有实例共享一个free space map，每次checkpoint只保存一次
+  disk_manager_->SaveFreeSpaceMap();
+}
+
+}  // namespace bustub
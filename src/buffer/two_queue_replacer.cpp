@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.cpp
+//
+// Identification: src/buffer/two_queue_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/two_queue_replacer.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace bustub {
+
+TwoQueueReplacer::TwoQueueReplacer(size_t num_frames)
+    : queue_(num_frames, Queue::NONE),
+      pos_(num_frames),
+      page_ids_(num_frames, INVALID_PAGE_ID),
+      evictable_(num_frames, false),
+      replacer_size_(num_frames),
+      kin_(std::max<size_t>(num_frames / 4, 1)),
+      kout_(std::max<size_t>(num_frames / 2, 1)) {}
+
+auto TwoQueueReplacer::Evict(frame_id_t *frame_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  auto &preferred = PreferredQueue();
+  auto &other = &preferred == &a1in_ ? am_ : a1in_;
+  for (auto *queue : {&preferred, &other}) {
+    for (auto rit = queue->rbegin(); rit != queue->rend(); ++rit) {
+      if (!evictable_[*rit]) {
+        continue;
+      }
+      *frame_id = *rit;
+      // 只有从A1in换出的page才记进A1out：它们只被访问过一次，再被读回来说明值得放进Am
+      if (queue == &a1in_ && page_ids_[*frame_id] != INVALID_PAGE_ID) {
+        a1out_.PushFront(page_ids_[*frame_id]);
+        if (a1out_.Size() > kout_) {
+          a1out_.PopBack();
+        }
+      }
+      Untrack(*frame_id);
+      return true;
+    }
+  }
+  return false;
+}
+
+void TwoQueueReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_) {
+    throw std::invalid_argument(std::string("Invalid frame_id") + std::to_string(frame_id));
+  }
+  switch (queue_[frame_id]) {
+    case Queue::AM:
+      am_.erase(pos_[frame_id]);
+      am_.push_front(frame_id);
+      pos_[frame_id] = am_.begin();
+      return;
+    case Queue::A1IN:
+      // A1in中的重复访问通常是相关的访问，不改变位置
+      return;
+    case Queue::NONE:
+      break;
+  }
+  if (page_id != INVALID_PAGE_ID && a1out_.Erase(page_id)) {
+    am_.push_front(frame_id);
+    pos_[frame_id] = am_.begin();
+    queue_[frame_id] = Queue::AM;
+  } else {
+    a1in_.push_front(frame_id);
+    pos_[frame_id] = a1in_.begin();
+    queue_[frame_id] = Queue::A1IN;
+  }
+  page_ids_[frame_id] = page_id;
+  evictable_[frame_id] = true;
+  curr_size_++;
+}
+
+void TwoQueueReplacer::SetEvictable(frame_id_t frame_id, bool set_evictable) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_) {
+    throw std::invalid_argument(std::string("Invalid frame_id") + std::to_string(frame_id));
+  }
+  if (queue_[frame_id] == Queue::NONE || evictable_[frame_id] == set_evictable) {
+    return;
+  }
+  evictable_[frame_id] = set_evictable;
+  if (set_evictable) {
+    curr_size_++;
+  } else {
+    curr_size_--;
+  }
+}
+
+void TwoQueueReplacer::Remove(frame_id_t frame_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (frame_id < 0 || static_cast<size_t>(frame_id) >= replacer_size_ || queue_[frame_id] == Queue::NONE) {
+    return;
+  }
+  if (!evictable_[frame_id]) {
+    throw std::logic_error(std::string("Can't remove an inevictable frame ") + std::to_string(frame_id));
+  }
+  Untrack(frame_id);
+}
+
+auto TwoQueueReplacer::EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  std::vector<frame_id_t> candidates;
+  auto &preferred = PreferredQueue();
+  auto &other = &preferred == &a1in_ ? am_ : a1in_;
+  for (auto *queue : {&preferred, &other}) {
+    for (auto rit = queue->rbegin(); rit != queue->rend() && candidates.size() < max_frames; ++rit) {
+      if (evictable_[*rit]) {
+        candidates.push_back(*rit);
+      }
+    }
+  }
+  return candidates;
+}
+
+auto TwoQueueReplacer::Size() -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return curr_size_;
+}
+
+auto TwoQueueReplacer::PreferredQueue() -> std::list<frame_id_t> & {
+  return a1in_.size() > kin_ || am_.empty() ? a1in_ : am_;
+}
+
+void TwoQueueReplacer::Untrack(frame_id_t frame_id) {
+  (queue_[frame_id] == Queue::A1IN ? a1in_ : am_).erase(pos_[frame_id]);
+  queue_[frame_id] = Queue::NONE;
+  page_ids_[frame_id] = INVALID_PAGE_ID;
+  evictable_[frame_id] = false;
+  curr_size_--;
+}
+
+}  // namespace bustub
@@ -33,6 +33,7 @@
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_manager_mmap.h"
 #include "type/value_factory.h"
 
 namespace bustub {
@@ -41,19 +42,24 @@ auto BustubInstance::MakeExecutorContext(Transaction *txn) -> std::unique_ptr<Ex
   return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_);
 }
 
-BustubInstance::BustubInstance(const std::string &db_file_name) {
+BustubInstance::BustubInstance(const std::string &db_file_name, size_t buffer_pool_size, bool read_only) {
   enable_logging = false;
 
   // Storage related.
-  disk_manager_ = new DiskManager(db_file_name);
+  if (read_only) {
+    disk_manager_ = new DiskManagerMmap(db_file_name);
+  } else {
+    disk_manager_ = new DiskManager(db_file_name);
+  }
 
   // Log related.
-  log_manager_ = new LogManager(disk_manager_);
+  log_manager_ = new LogManager(disk_manager_, LogBufferSizeFor(buffer_pool_size));
 
-  // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
-  // buffer pool size specified in `config.h`.
+  // GenerateTestTable needs more frames than the default buffer pool size specified in `config.h`, so the instance
+  // defaults to DEFAULT_INSTANCE_BUFFER_POOL_SIZE frames.
   try {
-    buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    buffer_pool_manager_ =
+        new BufferPoolManagerInstance(buffer_pool_size, disk_manager_, LRUK_REPLACER_K, log_manager_);
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
@@ -73,19 +79,20 @@ BustubInstance::BustubInstance(const std::string &db_file_name) {
   execution_engine_ = new ExecutionEngine(buffer_pool_manager_, txn_manager_, catalog_);
 }
 
-BustubInstance::BustubInstance() {
+BustubInstance::BustubInstance(size_t buffer_pool_size) {
   enable_logging = false;
 
   // Storage related.
   disk_manager_ = new DiskManagerUnlimitedMemory();
 
   // Log related.
-  log_manager_ = new LogManager(disk_manager_);
+  log_manager_ = new LogManager(disk_manager_, LogBufferSizeFor(buffer_pool_size));
 
-  // We need more frames for GenerateTestTable to work. Therefore, we use 128 instead of the default
-  // buffer pool size specified in `config.h`.
+  // GenerateTestTable needs more frames than the default buffer pool size specified in `config.h`, so the instance
+  // defaults to DEFAULT_INSTANCE_BUFFER_POOL_SIZE frames.
   try {
-    buffer_pool_manager_ = new BufferPoolManagerInstance(128, disk_manager_, LRUK_REPLACER_K, log_manager_);
+    buffer_pool_manager_ =
+        new BufferPoolManagerInstance(buffer_pool_size, disk_manager_, LRUK_REPLACER_K, log_manager_);
   } catch (NotImplementedException &e) {
     std::cerr << "BufferPoolManager is not implemented, only mock tables are supported." << std::endl;
     buffer_pool_manager_ = nullptr;
@@ -146,6 +153,76 @@ void BustubInstance::CmdDisplayIndices(ResultWriter &writer) {
   writer.EndTable();
 }
 
+void BustubInstance::CmdDisplayBufferPoolStats(ResultWriter &writer) {
+  if (buffer_pool_manager_ == nullptr) {
+    WriteOneCell("buffer pool is not available", writer);
+    return;
+  }
+  auto stats = buffer_pool_manager_->GetStats();
+  std::vector<std::pair<std::string, std::string>> rows = {
+      {"pool_size", fmt::format("{}", stats.pool_size_)},
+      {"hits", fmt::format("{}", stats.hits_)},
+      {"misses", fmt::format("{}", stats.misses_)},
+      {"hit_ratio", fmt::format("{:.4f}", stats.HitRatio())},
+      {"avg_miss_latency_us", fmt::format("{:.1f}", stats.AvgMissLatencyUs())},
+      {"failed_fetches", fmt::format("{}", stats.failed_fetches_)},
+      {"evictions", fmt::format("{}", stats.evictions_)},
+      {"dirty_writes", fmt::format("{}", stats.dirty_writes_)},
+      {"background_writes", fmt::format("{}", stats.background_writes_)},
+      {"prefetched_pages", fmt::format("{}", stats.prefetched_pages_)},
+      {"pin_wait_us", fmt::format("{:.1f}", static_cast<double>(stats.pin_wait_ns_) / 1000)},
+      {"disk_reads", fmt::format("{}", disk_manager_->GetNumReads())},
+      {"disk_writes", fmt::format("{}", disk_manager_->GetNumWrites())},
+      {"disk_read_time_us", fmt::format("{:.1f}", static_cast<double>(disk_manager_->GetReadTimeNs()) / 1000)},
+      {"disk_write_time_us", fmt::format("{:.1f}", static_cast<double>(disk_manager_->GetWriteTimeNs()) / 1000)},
+      {"log_flushes", fmt::format("{}", disk_manager_->GetNumFlushes())},
+  };
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  writer.WriteHeaderCell("stat");
+  writer.WriteHeaderCell("value");
+  writer.EndHeader();
+  for (const auto &[name, value] : rows) {
+    writer.BeginRow();
+    writer.WriteCell(name);
+    writer.WriteCell(value);
+    writer.EndRow();
+  }
+  writer.EndTable();
+
+  // 按表和索引分开统计，只显示被访问过的对象
+  auto write_object_row = [&writer](const std::string &name, const char *type, const ObjectAccessStats &object_stats) {
+    auto hits = object_stats.hits_.load();
+    auto misses = object_stats.misses_.load();
+    if (hits + misses == 0) {
+      return;
+    }
+    writer.BeginRow();
+    writer.WriteCell(name);
+    writer.WriteCell(type);
+    writer.WriteCell(fmt::format("{}", hits));
+    writer.WriteCell(fmt::format("{}", misses));
+    writer.WriteCell(fmt::format("{:.4f}", static_cast<double>(hits) / static_cast<double>(hits + misses)));
+    writer.EndRow();
+  };
+  std::shared_lock<std::shared_mutex> l(catalog_lock_);
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  writer.WriteHeaderCell("object");
+  writer.WriteHeaderCell("type");
+  writer.WriteHeaderCell("hits");
+  writer.WriteHeaderCell("misses");
+  writer.WriteHeaderCell("hit_ratio");
+  writer.EndHeader();
+  for (const auto &table_name : catalog_->GetTableNames()) {
+    write_object_row(table_name, "table", catalog_->GetTable(table_name)->access_stats_);
+    for (const auto *index_info : catalog_->GetTableIndexes(table_name)) {
+      write_object_row(index_info->name_, "index", index_info->access_stats_);
+    }
+  }
+  writer.EndTable();
+}
+
 void BustubInstance::WriteOneCell(const std::string &cell, ResultWriter &writer) {
   writer.BeginTable(true);
   writer.BeginRow();
@@ -160,6 +237,7 @@ void BustubInstance::CmdDisplayHelp(ResultWriter &writer) {
 \dt: show all tables
 \di: show all indices
 \help: show this message again
+SHOW buffer_pool_stats: show buffer pool and disk statistics, per table and index
 
 BusTub shell currently only supports a small set of Postgres queries. We'll set
 up a doc describing the current status later. It will silently ignore some parts
@@ -252,6 +330,10 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
       }
       case StatementType::VARIABLE_SHOW_STATEMENT: {
         const auto &show_stmt = dynamic_cast<const VariableShowStatement &>(*statement);
+        if (show_stmt.variable_ == "buffer_pool_stats") {
+          CmdDisplayBufferPoolStats(writer);
+          continue;
+        }
         auto content = GetSessionVariable(show_stmt.variable_);
         WriteOneCell(fmt::format("{}={}", show_stmt.variable_, content), writer);
         continue;
@@ -20,4 +20,24 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::chrono::milliseconds page_cleaner_interval = std::chrono::milliseconds(100);
+
+double page_cleaner_target_clean_ratio = 0.5;
+
+size_t read_ahead_window = 8;
+
+HugePageMode buffer_pool_huge_pages = HugePageMode::TRANSPARENT;
+
+bool buffer_pool_numa_aware = false;
+
+bool disk_direct_io = false;
+
+bool page_checksums = false;
+
+bool optimistic_index_reads = true;
+
+size_t extent_size = 64;
+
+double index_fill_factor = 0.9;
+
 }  // namespace bustub
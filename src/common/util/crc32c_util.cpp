@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_util.cpp
+//
+// Identification: src/common/util/crc32c_util.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/crc32c_util.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** The reflected CRC32C polynomial. */
+constexpr uint32_t CRC32C_POLY = 0x82f63b78;
+
+using Crc32cTables = std::array<std::array<uint32_t, 256>, 8>;
+
+/** tables[k][b] is the checksum of byte b followed by k zero bytes */
+constexpr auto MakeTables() -> Crc32cTables {
+  Crc32cTables tables{};
+  for (uint32_t b = 0; b < 256; b++) {
+    uint32_t crc = b;
+    for (int bit = 0; bit < 8; bit++) {
+      crc = (crc >> 1) ^ ((crc & 1) != 0 ? CRC32C_POLY : 0);
+    }
+    tables[0][b] = crc;
+  }
+  for (uint32_t b = 0; b < 256; b++) {
+    for (size_t k = 1; k < 8; k++) {
+      tables[k][b] = (tables[k - 1][b] >> 8) ^ tables[0][tables[k - 1][b] & 0xff];
+    }
+  }
+  return tables;
+}
+
+constexpr Crc32cTables TABLES = MakeTables();
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) auto Crc32cSse42(const char *data, size_t size, uint32_t crc) -> uint32_t {
+  uint64_t crc64 = ~crc;
+  // 每次处理8个字节，最后不足8个字节的部分逐字节处理
+  for (; size >= 8; data += 8, size -= 8) {
+    uint64_t word;
+    memcpy(&word, data, sizeof(word));
+    crc64 = _mm_crc32_u64(crc64, word);
+  }
+  auto crc32 = static_cast<uint32_t>(crc64);
+  for (; size > 0; data++, size--) {
+    crc32 = _mm_crc32_u8(crc32, static_cast<uint8_t>(*data));
+  }
+  return ~crc32;
+}
+#endif
+
+}  // namespace
+
+auto Crc32cUtil::Crc32c(const char *data, size_t size, uint32_t crc) -> uint32_t {
+  static const bool has_hardware_support = HasHardwareSupport();
+  return has_hardware_support ? Crc32cHardware(data, size, crc) : Crc32cSoftware(data, size, crc);
+}
+
+auto Crc32cUtil::HasHardwareSupport() -> bool {
+#if defined(__x86_64__)
+  return __builtin_cpu_supports("sse4.2") != 0;
+#else
+  return false;
+#endif
+}
+
+auto Crc32cUtil::Crc32cSoftware(const char *data, size_t size, uint32_t crc) -> uint32_t {
+  crc = ~crc;
+  // slice-by-8：每次查8张表处理8个字节（小端序）
+  for (; size >= 8; data += 8, size -= 8) {
+    uint32_t low;
+    uint32_t high;
+    memcpy(&low, data, sizeof(low));
+    memcpy(&high, data + 4, sizeof(high));
+    low ^= crc;
+    crc = TABLES[7][low & 0xff] ^ TABLES[6][(low >> 8) & 0xff] ^ TABLES[5][(low >> 16) & 0xff] ^ TABLES[4][low >> 24] ^
+          TABLES[3][high & 0xff] ^ TABLES[2][(high >> 8) & 0xff] ^ TABLES[1][(high >> 16) & 0xff] ^
+          TABLES[0][high >> 24];
+  }
+  for (; size > 0; data++, size--) {
+    crc = (crc >> 8) ^ TABLES[0][(crc ^ static_cast<uint8_t>(*data)) & 0xff];
+  }
+  return ~crc;
+}
+
+auto Crc32cUtil::Crc32cHardware(const char *data, size_t size, uint32_t crc) -> uint32_t {
+#if defined(__x86_64__)
+  return Crc32cSse42(data, size, crc);
+#else
+  return Crc32cSoftware(data, size, crc);
+#endif
+}
+
+}  // namespace bustub
@@ -49,6 +49,7 @@ auto DeleteExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
   auto schema = table_info_->schema_;
   // auto index = exec_ctx_->GetCatalog()->GetTableIndexes(table_info->name_);
   while (child_executor_->Next(tuple, rid)) {
+    AccessStatsScope table_scope(&table_info_->access_stats_);
     try {
       if (!lkm->LockRow(txn, LockManager::LockMode::EXCLUSIVE, plan_->table_oid_, *rid)) {
         txn->SetState(TransactionState::ABORTED);
@@ -61,6 +62,7 @@ auto DeleteExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
       count++;
       auto index_infos = exec_ctx_->GetCatalog()->GetTableIndexes(table_info_->name_);
       for (const auto &index_info : index_infos) {
+        AccessStatsScope index_scope(&index_info->access_stats_);
         auto key_tuple =
             tuple->KeyFromTuple(table_info_->schema_, index_info->key_schema_, index_info->index_->GetKeyAttrs());
         index_info->index_->DeleteEntry(key_tuple, *rid, exec_ctx_->GetTransaction());
@@ -11,6 +11,8 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include <algorithm>
+
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
     : AbstractExecutor(exec_ctx), plan_(plan) {}
@@ -28,10 +30,37 @@ void IndexScanExecutor::Init() {
   } catch (TransactionAbortException &e) {
     throw ExecutionException("execute lock table fail");
   }
-  auto index = exec_ctx_->GetCatalog()->GetIndex(plan_->index_oid_)->index_.get();
-  Tuple key({plan_->val_}, index->GetKeySchema());
+  auto index_info = exec_ctx_->GetCatalog()->GetIndex(plan_->index_oid_);
+  auto index = index_info->index_.get();
+  auto key_schema = index->GetKeySchema();
   result_.clear();
-  index->ScanKey(key, &result_, txn);
+  AccessStatsScope scope(&index_info->access_stats_);
+  if (plan_->IsPointLookup()) {
+    index->ScanKey(Tuple({*plan_->lower_}, key_schema), &result_, txn);
+    // 按page排序，这样一批RID落在尽量少的page上，可以一次取回
+    std::stable_sort(result_.begin(), result_.end(),
+                     [](const RID &a, const RID &b) { return a.GetPageId() < b.GetPageId(); });
+    if (plan_->limit_.has_value() && result_.size() > *plan_->limit_) {
+      result_.resize(*plan_->limit_);
+    }
+  } else {
+    // 范围扫描要保持索引的顺序，ORDER BY依赖这个顺序
+    IndexRange range;
+    if (plan_->lower_.has_value()) {
+      range.lower_ = Tuple({*plan_->lower_}, key_schema);
+    }
+    if (plan_->upper_.has_value()) {
+      range.upper_ = Tuple({*plan_->upper_}, key_schema);
+    }
+    range.lower_inclusive_ = plan_->lower_inclusive_;
+    range.upper_inclusive_ = plan_->upper_inclusive_;
+    range.direction_ = plan_->direction_;
+    range.limit_ = plan_->limit_;
+    index->ScanRange(range, &result_, txn);
+  }
+  batch_rids_.clear();
+  batch_tuples_.clear();
+  batch_pos_ = 0;
   iter_begin_ = result_.begin();
   iter_end_ = result_.end();
   //  index_info_ = exec_ctx_->GetCatalog()->GetIndex(plan_->index_oid_);
@@ -43,28 +72,25 @@ auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   auto txn = exec_ctx_->GetTransaction();
   auto lkm = exec_ctx_->GetLockManager();
   auto table_info = exec_ctx_->GetCatalog()->GetTable(plan_->table_name_);
-  if (iter_begin_ != iter_end_) {
-    try {
-      *rid = *iter_begin_;
-      if (!txn->IsRowExclusiveLocked(table_info->oid_, *rid) && !txn->IsRowSharedLocked(table_info->oid_, *rid) &&
-          txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED) {
-        if (!lkm->LockRow(txn, LockManager::LockMode::SHARED, table_info->oid_, *rid)) {
-          throw ExecutionException("index lock row fail");
-        }
+  while (true) {
+    if (batch_pos_ == batch_rids_.size()) {
+      if (iter_begin_ == iter_end_) {
+        break;
       }
-      // if (!exec_ctx_->GetCatalog()->GetTable())
-      if (txn->IsRowSharedLocked(table_info->oid_, *rid)) {
-        if (txn->GetIsolationLevel() == IsolationLevel::READ_UNCOMMITTED) {
-          if (!lkm->UnlockRow(txn, table_info->oid_, *rid)) {
-            throw ExecutionException("index unlock row shared fail");
-          }
-        }
+      FetchNextBatch();
+    }
+    const auto &batch_tuple = batch_tuples_[batch_pos_];
+    const auto &batch_rid = batch_rids_[batch_pos_];
+    ++batch_pos_;
+    // 索引只保证key在范围内，谓词里的其他条件还要在tuple上检查
+    if (plan_->filter_predicate_ != nullptr) {
+      auto value = plan_->filter_predicate_->Evaluate(&batch_tuple, GetOutputSchema());
+      if (value.IsNull() || !value.GetAs<bool>()) {
+        continue;
       }
-    } catch (TransactionAbortException &e) {
-      throw ExecutionException("index execute lock fail");
     }
-    table_info->table_->GetTuple(*rid, tuple, exec_ctx_->GetTransaction());
-    ++iter_begin_;
+    *rid = batch_rid;
+    *tuple = batch_tuple;
     return true;
   }
   if (txn->IsTableIntentionSharedLocked(table_info->oid_)) {
@@ -89,4 +115,47 @@ auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
   //  return false;
 }
 
+void IndexScanExecutor::FetchNextBatch() {
+  auto table_info = exec_ctx_->GetCatalog()->GetTable(plan_->table_name_);
+  batch_rids_.clear();
+  batch_pos_ = 0;
+  int batch_pages = 0;
+  while (iter_begin_ != iter_end_) {
+    if (batch_rids_.empty() || iter_begin_->GetPageId() != batch_rids_.back().GetPageId()) {
+      if (batch_pages == INDEX_SCAN_BATCH_PAGES) {
+        break;
+      }
+      batch_pages++;
+    }
+    LockRow(*iter_begin_);
+    batch_rids_.push_back(*iter_begin_);
+    ++iter_begin_;
+  }
+  AccessStatsScope scope(&table_info->access_stats_);
+  table_info->table_->GetTuples(batch_rids_, &batch_tuples_, exec_ctx_->GetTransaction());
+}
+
+void IndexScanExecutor::LockRow(const RID &rid) {
+  auto txn = exec_ctx_->GetTransaction();
+  auto lkm = exec_ctx_->GetLockManager();
+  auto table_info = exec_ctx_->GetCatalog()->GetTable(plan_->table_name_);
+  try {
+    if (!txn->IsRowExclusiveLocked(table_info->oid_, rid) && !txn->IsRowSharedLocked(table_info->oid_, rid) &&
+        txn->GetIsolationLevel() != IsolationLevel::READ_UNCOMMITTED) {
+      if (!lkm->LockRow(txn, LockManager::LockMode::SHARED, table_info->oid_, rid)) {
+        throw ExecutionException("index lock row fail");
+      }
+    }
+    if (txn->IsRowSharedLocked(table_info->oid_, rid)) {
+      if (txn->GetIsolationLevel() == IsolationLevel::READ_UNCOMMITTED) {
+        if (!lkm->UnlockRow(txn, table_info->oid_, rid)) {
+          throw ExecutionException("index unlock row shared fail");
+        }
+      }
+    }
+  } catch (TransactionAbortException &e) {
+    throw ExecutionException("index execute lock fail");
+  }
+}
+
 }  // namespace bustub
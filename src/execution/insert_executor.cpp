@@ -52,6 +52,8 @@ auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
 
   // auto index = exec_ctx_->GetCatalog()->GetTableIndexes(table_info->name_);
   while (child_executor_->Next(&insert_tuple, &insert_rid)) {
+    // 子执行器的访问记在子执行器自己的对象上，这里只统计对本表和索引的访问
+    AccessStatsScope table_scope(&table_info_->access_stats_);
     try {
       if (!lkm->LockRow(txn, LockManager::LockMode::EXCLUSIVE, plan_->table_oid_, insert_rid)) {
         txn->SetState(TransactionState::ABORTED);
@@ -65,6 +67,7 @@ auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
 
       auto vec = exec_ctx_->GetCatalog()->GetTableIndexes(table_info_->name_);
       for (auto info : vec) {
+        AccessStatsScope index_scope(&info->access_stats_);
         auto key = insert_tuple.KeyFromTuple(table_info_->schema_, info->key_schema_, info->index_->GetKeyAttrs());
         info->index_->InsertEntry(key, insert_rid, exec_ctx_->GetTransaction());
         txn->AppendIndexWriteRecord(IndexWriteRecord(insert_rid, plan_->table_oid_, WType::INSERT, insert_tuple,
@@ -37,10 +37,9 @@ void NestIndexJoinExecutor::Init() {
     tree->ScanKey(left_key_tuple, &result_rids, nullptr);
     std::vector<Tuple> right_tuples;
     auto table_heap = exec_ctx_->GetCatalog()->GetTable(index_info->table_name_)->table_.get();
-    for (auto &right_rid : result_rids) {
-      Tuple t_right_tuple;
-      table_heap->GetTuple(right_rid, &t_right_tuple, exec_ctx_->GetTransaction());
-      right_tuples.push_back(t_right_tuple);
+    // 一次探测命中的所有内表tuple一批取回
+    if (!result_rids.empty()) {
+      table_heap->GetTuples(result_rids, &right_tuples, exec_ctx_->GetTransaction());
     }
     if (!right_tuples.empty()) {
       for (auto &right_tuple : right_tuples) {
@@ -41,10 +41,13 @@ void SeqScanExecutor::Init() {
   }
   table_info_ = exec_ctx_->GetCatalog()->GetTable(plan_->table_name_);
   table_heap_ = table_info_->table_.get();
-  table_iterator_ = table_heap_->Begin(exec_ctx_->GetTransaction());
+  strategy_ = std::make_unique<BufferAccessStrategy>();
+  AccessStatsScope scope(&table_info_->access_stats_);
+  table_iterator_ = table_heap_->Begin(exec_ctx_->GetTransaction(), strategy_.get());
 }
 
 auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  AccessStatsScope scope(&table_info_->access_stats_);
   auto txn = exec_ctx_->GetTransaction();
   auto lkm = exec_ctx_->GetLockManager();
   while (plan_->filter_predicate_ != nullptr && table_iterator_ != table_heap_->End() &&
@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/ghost_list.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * ArcReplacer implements the Adaptive Replacement Cache policy of Megiddo and Modha.
+ *
+ * Resident frames are split between T1 (pages seen once recently) and T2 (pages seen at least twice), both in LRU
+ * order. The ids of pages evicted from T1 and T2 are remembered in the ghost lists B1 and B2. A page that is read back
+ * while it is in B1 means T1 was too small, so the target size p of T1 grows; a hit in B2 shrinks it. Evict() takes
+ * the least recently used frame of T1 while T1 is larger than p, and of T2 otherwise.
+ */
+class ArcReplacer : public Replacer {
+ public:
+  /**
+   * Create a new ArcReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit ArcReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(ArcReplacer);
+
+  ~ArcReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id = INVALID_PAGE_ID) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  auto Size() -> size_t override;
+
+  /** @return the current target size of T1 */
+  auto GetTargetT1Size() -> size_t;
+
+ private:
+  enum class Queue { NONE, T1, T2 };
+
+  /** @return the list Evict() looks at first */
+  auto PreferredList() -> std::list<frame_id_t> &;
+
+  /** @brief Untrack a frame and take it out of its list. */
+  void Untrack(frame_id_t frame_id);
+
+  /** @brief Keep |T1| + |B1| <= c and |T1| + |T2| + |B1| + |B2| <= 2c. */
+  void TrimGhosts();
+
+  /** Resident frames seen once, the most recently used first. */
+  std::list<frame_id_t> t1_;
+  /** Resident frames seen at least twice, the most recently used first. */
+  std::list<frame_id_t> t2_;
+  /** Pages recently evicted from T1. */
+  GhostList b1_;
+  /** Pages recently evicted from T2. */
+  GhostList b2_;
+  std::vector<Queue> queue_;
+  std::vector<std::list<frame_id_t>::iterator> pos_;
+  std::vector<page_id_t> page_ids_;
+  std::vector<bool> evictable_;
+  size_t curr_size_{0};
+  /** c, the number of frames. */
+  size_t replacer_size_;
+  /** p, the target size of T1, in [0, c]. */
+  size_t target_t1_size_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,74 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * BufferAccessStrategy keeps a large one-off scan from flushing the hot working set out of the buffer pool.
+ *
+ * The strategy remembers the pages that the scan read into the pool in a small ring. When the scan misses again, the
+ * buffer pool recycles the frame of the page in the current ring slot if nobody else is using it, instead of evicting
+ * some other frame through the replacer. A scan therefore occupies at most about ring_size frames, however large the
+ * table is. If the frame cannot be recycled (the page was evicted already, or somebody pinned it), the buffer pool
+ * falls back to its normal victim selection. Scans that read fewer than a quarter of the pool are not restricted, so
+ * a small table that is scanned over and over again stays cached.
+ *
+ * A strategy is meant to be owned by one scan and is not thread-safe.
+ */
+class BufferAccessStrategy {
+ public:
+  /**
+   * @brief Create a new BufferAccessStrategy.
+   * @param ring_size the number of frames the scan may occupy
+   */
+  explicit BufferAccessStrategy(size_t ring_size = BUFFER_ACCESS_STRATEGY_RING_SIZE)
+      : ring_(std::max(ring_size, static_cast<size_t>(1)), INVALID_PAGE_ID) {}
+
+  DISALLOW_COPY_AND_MOVE(BufferAccessStrategy);
+
+  /** @return the page whose frame the next miss should recycle, INVALID_PAGE_ID if the current slot is empty */
+  auto GetRecyclablePage() const -> page_id_t { return ring_[current_]; }
+
+  /**
+   * @brief Record that the scan read page_id into the pool and move on to the next slot.
+   * @param page_id the page that was read
+   */
+  void Advance(page_id_t page_id) {
+    ring_[current_] = page_id;
+    current_ = (current_ + 1) % ring_.size();
+    pages_read_++;
+  }
+
+  /** @return the number of pages the scan has read into the pool so far */
+  auto GetPagesRead() const -> size_t { return pages_read_; }
+
+  /** @return the number of frames the scan may occupy */
+  auto GetRingSize() const -> size_t { return ring_.size(); }
+
+ private:
+  /** The pages last read by the scan, one per ring slot. */
+  std::vector<page_id_t> ring_;
+  /** The slot to recycle on the next miss. */
+  size_t current_{0};
+  /** The number of pages read into the pool by the scan. */
+  size_t pages_read_{0};
+};
+
+}  // namespace bustub
@@ -15,14 +15,23 @@
 #include <list>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <vector>
 
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_stats.h"
 #include "buffer/lru_replacer.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/extent_allocator.h"
 #include "storage/page/page.h"
 
 namespace bustub {
 
+class BasicPageGuard;
+class ReadPageGuard;
+class WritePageGuard;
+class OptimisticPageGuard;
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
  */
@@ -87,6 +96,98 @@ class BufferPoolManager {
   /** @return size of the buffer pool */
   virtual auto GetPoolSize() -> size_t = 0;
 
+  /**
+   * @brief Fetch a page on behalf of a large scan, recycling the frames of the scan's ring on a miss.
+   * The default implementation ignores the strategy.
+   * @param page_id id of page to be fetched
+   * @param strategy the scan's access strategy, nullptr to fetch the page like FetchPage() does
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  virtual auto FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
+    return FetchPage(page_id);
+  }
+
+  /**
+   * @brief Create a new page with the next page id of an extent, so that the pages of one table or index are
+   * contiguous in the file. The default implementation ignores the extent.
+   * @param[out] page_id id of the created page
+   * @param extent the extent allocator of the table or index the page belongs to, nullptr to create the page like
+   * NewPage() does
+   * @return nullptr if no new page could be created, otherwise pointer to new page
+   */
+  virtual auto NewPageInExtent(page_id_t *page_id, ExtentAllocator *extent) -> Page * { return NewPage(page_id); }
+
+  /**
+   * @brief Hint that the given pages are going to be fetched soon.
+   *
+   * Implementations may read the pages into free or evictable frames in the background, without pinning them, so that
+   * the later FetchPage() calls hit. Pages that are already resident or were never allocated are ignored. The default
+   * implementation does nothing.
+   *
+   * @param page_ids ids of the pages to read ahead
+   * @param strategy the access strategy of the scan the pages are read for, if any
+   */
+  virtual void PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy = nullptr) {}
+
+  /**
+   * @brief Fetch several pages at once, pinning each of them like FetchPage() does.
+   *
+   * Implementations may serve all the resident pages under one latch acquisition and read the missing ones from disk
+   * in one batch. A page id that appears several times is pinned once per occurrence. The default implementation
+   * fetches the pages one by one.
+   *
+   * @param page_ids ids of the pages to be fetched
+   * @return the pages in the order of page_ids, nullptr for every page that cannot be fetched
+   */
+  virtual auto FetchPages(const std::vector<page_id_t> &page_ids) -> std::vector<Page *>;
+
+  /**
+   * @brief Unpin several pages at once, like UnpinPage() does for each of them. The default implementation unpins the
+   * pages one by one.
+   * @param page_ids ids of the pages to be unpinned, once per occurrence
+   * @param is_dirty true if the pages should be marked as dirty, false otherwise
+   */
+  virtual void UnpinPages(const std::vector<page_id_t> &page_ids, bool is_dirty);
+
+  /**
+   * @brief Fetch a page pinned by a guard, which unpins it when it goes out of scope.
+   * @param page_id id of page to be fetched
+   * @return the guard, empty if the page cannot be fetched
+   */
+  auto FetchPageBasic(page_id_t page_id) -> BasicPageGuard;
+
+  /**
+   * @brief Fetch a page pinned and read-latched by a guard.
+   * @param page_id id of page to be fetched
+   * @param strategy the access strategy of the scan the page is read for, if any
+   * @return the guard, empty if the page cannot be fetched
+   */
+  auto FetchPageRead(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) -> ReadPageGuard;
+
+  /**
+   * @brief Fetch a page pinned and write-latched by a guard.
+   * @param page_id id of page to be fetched
+   * @return the guard, empty if the page cannot be fetched
+   */
+  auto FetchPageWrite(page_id_t page_id) -> WritePageGuard;
+
+  /**
+   * @brief Fetch a page pinned, but not latched, by a guard that can validate what was read from the page.
+   * @param page_id id of page to be fetched
+   * @return the guard, empty if the page cannot be fetched
+   */
+  auto FetchPageOptimistic(page_id_t page_id) -> OptimisticPageGuard;
+
+  /**
+   * @brief Create a new page pinned by a guard.
+   * @param[out] page_id id of the created page
+   * @return the guard, empty if no new page could be created
+   */
+  auto NewPageGuarded(page_id_t *page_id) -> BasicPageGuard;
+
+  /** @return a snapshot of the statistics of the buffer pool, all zero if the implementation does not keep any */
+  virtual auto GetStats() -> BufferPoolStats { return {}; }
+
  protected:
   /**
    * Grading function. Do not modify!
@@ -12,17 +12,27 @@
 
 #pragma once
 
+#include <atomic>
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
+#include <map>
 #include <mutex>  // NOLINT
 #include <numeric>
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
-#include "buffer/lru_k_replacer.h"
+#include "buffer/frame_arena.h"
+#include "buffer/page_table.h"
+#include "buffer/replacer.h"
 #include "common/config.h"
-#include "container/hash/extendible_hash_table.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
 #include "storage/page/page.h"
 
 namespace bustub {
@@ -36,11 +46,26 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @brief Creates a new BufferPoolManagerInstance.
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
-   * @param replacer_k the lookback constant k for the LRU-K replacer
+   * @param replacer_k the lookback constant k for the LRU-K replacer, ignored by the other policies
    * @param log_manager the log manager (for testing only: nullptr = disable logging). Please ignore this for P1.
+   * @param replacer_type the replacement policy
    */
   BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
-                            LogManager *log_manager = nullptr);
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU_K);
+
+  /**
+   * @brief Creates a new BufferPoolManagerInstance that is one shard of a ParallelBufferPoolManager.
+   * @param pool_size the size of the buffer pool
+   * @param num_instances total number of BPIs in the parallel BPM
+   * @param instance_index index of this BPI in the parallel BPM
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer, ignored by the other policies
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy
+   */
+  BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                            DiskManager *disk_manager, size_t replacer_k = LRUK_REPLACER_K,
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU_K);
 
   /**
    * @brief Destroy an existing BufferPoolManagerInstance.
@@ -53,6 +78,107 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @brief Return the pointer to all the pages in the buffer pool. */
   auto GetPages() -> Page * { return pages_; }
 
+  /** @brief Return the memory that holds the data of the frames. */
+  auto GetFrameArena() const -> const FrameArena * { return frame_arena_; }
+
+  /**
+   * @brief Start the background page cleaner.
+   *
+   * Every interval the cleaner looks at the cold end of the replacer and writes back dirty evictable frames, in
+   * batches of at most PAGE_CLEANER_BATCH_SIZE pages, until target_clean_ratio of the evictable frames are clean. This
+   * way foreground evictions rarely have to pay for a write-back. Does nothing if the cleaner is already running.
+   *
+   * @param interval how long the cleaner sleeps between two rounds
+   * @param target_clean_ratio fraction of the evictable frames the cleaner tries to keep clean, in [0, 1]
+   */
+  void RunPageCleanerThread(std::chrono::milliseconds interval = page_cleaner_interval,
+                            double target_clean_ratio = page_cleaner_target_clean_ratio);
+
+  /** @brief Stop and join the background page cleaner. Does nothing if it is not running. */
+  void StopPageCleanerThread();
+
+  /**
+   * @brief Fetch a page on behalf of a large scan. A miss recycles the frame in the current slot of the strategy's
+   * ring if nobody uses it, and falls back to the normal victim selection otherwise.
+   * @param page_id id of page to be fetched
+   * @param strategy the scan's access strategy, nullptr to fetch the page like FetchPage() does
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  auto FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * override;
+
+  /**
+   * @brief Create a new page with the next page id of an extent. Only for an instance that is not part of a parallel
+   * buffer pool, whose extents are spread over all the instances.
+   * @param[out] page_id id of the created page
+   * @param extent the extent allocator of the table or index the page belongs to, nullptr to create the page like
+   * NewPage() does
+   * @return nullptr if all frames are pinned, otherwise pointer to new page
+   */
+  auto NewPageInExtent(page_id_t *page_id, ExtentAllocator *extent) -> Page * override;
+
+  /**
+   * @brief Create a new page with a page id the caller has allocated already in the free space map.
+   * @param page_id id of the page, must belong to this instance
+   * @return nullptr if all frames are pinned, the page id is left allocated then; otherwise pointer to new page
+   */
+  auto NewPageWithId(page_id_t page_id) -> Page *;
+
+  /**
+   * @brief Write back the dirty pages of this instance, without saving the free space map.
+   * ParallelBufferPoolManager flushes every instance this way and saves the shared map once afterwards.
+   */
+  void FlushDirtyPages();
+
+  /**
+   * @brief Read the given pages into free or evictable frames in the background, without pinning them.
+   *
+   * The reads are done by PREFETCH_WORKER_NUM worker threads that are started on the first call. A page that is
+   * fetched while its prefetch read is in flight waits for that read instead of issuing another one. Pages that are
+   * resident, queued already, not allocated by this instance, or that do not fit in the pool are skipped. With a
+   * strategy, the frames are taken from the strategy's ring right away, so read-ahead does not grow the scan's
+   * footprint either.
+   *
+   * @param page_ids ids of the pages to read ahead
+   * @param strategy the access strategy of the scan the pages are read for, if any
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy = nullptr) override;
+
+  /**
+   * @brief Fetch several pages under one acquisition of the latch.
+   *
+   * Resident pages are pinned right away. The missing pages get a victim frame each and are read from disk through the
+   * disk scheduler with the latch released, one request per run of adjacent page ids, all of them in flight at once.
+   * A missing page that another thread
+   * starts reading in the meantime is fetched like FetchPage() does afterwards, so the batch never waits on an I/O
+   * while it holds frames reserved for its own reads.
+   *
+   * @param page_ids ids of the pages to be fetched
+   * @return the pages in the order of page_ids, nullptr for every page that cannot be fetched
+   */
+  auto FetchPages(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> override;
+
+  /**
+   * @brief Unpin several pages under one acquisition of the latch.
+   * @param page_ids ids of the pages to be unpinned, once per occurrence
+   * @param is_dirty true if the pages should be marked as dirty, false otherwise
+   */
+  void UnpinPages(const std::vector<page_id_t> &page_ids, bool is_dirty) override;
+
+  /** @return a snapshot of the statistics of this instance */
+  auto GetStats() -> BufferPoolStats override;
+
+  /**
+   * @brief Return a snapshot of the dirty page table: every resident dirty page, with the LSN of the page when it was
+   * first dirtied since it was last written back (its recLSN, for recovery). Ordered by page id.
+   */
+  auto GetDirtyPageTable() -> std::map<page_id_t, lsn_t>;
+
+  /** @brief Return the number of dirty pages written back by the background page cleaner. */
+  auto GetBackgroundCleanedPages() const -> uint64_t { return background_cleaned_pages_; }
+
+  /** @brief Return the number of dirty pages written back on the foreground eviction path. */
+  auto GetForegroundCleanedPages() const -> uint64_t { return foreground_cleaned_pages_; }
+
  protected:
   /**
    * TODO(P1): Add implementation
@@ -88,6 +214,7 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    *
    * @param page_id id of page to be fetched
    * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   * @throws Exception of type CORRUPTION if the page read from disk is damaged; it is not cached then
    */
   auto FetchPgImp(page_id_t page_id) -> Page * override;
 
@@ -122,7 +249,12 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /**
    * TODO(P1): Add implementation
    *
-   * @brief Flush all the pages in the buffer pool to disk.
+   * @brief Flush all the dirty pages in the buffer pool to disk.
+   *
+   * Only the pages in the dirty page table are written. Every run of adjacent pages is one request to the disk
+   * scheduler, and all the requests are in flight at once. Pages that are being written back already are skipped.
+   * The latch is only held to pick the pages and to mark them clean, not during the writes; the pages are marked as
+   * being written back meanwhile, as on a miss. The free space map is saved after the writes, outside the latch.
    */
   void FlushAllPgsImp() override;
 
@@ -143,39 +275,113 @@ class BufferPoolManagerInstance : public BufferPoolManager {
 
   /** Number of pages in the buffer pool. */
   const size_t pool_size_;
-  /** The next page id to be allocated  */
-  std::atomic<page_id_t> next_page_id_ = 0;
-  /** Bucket size for the extendible hash table */
-  const size_t bucket_size_ = 4;
+  /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
+  const uint32_t num_instances_ = 1;
+  /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
+  const uint32_t instance_index_ = 0;
 
   /** Array of buffer pool pages. */
   Page *pages_;
+  /** The data blocks of the frames, pages_[i] wraps the i-th block. */
+  FrameArena *frame_arena_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
+  /** Executes the batched reads and writes of this instance, several of them at a time. */
+  DiskScheduler *disk_scheduler_;
   /** Pointer to the log manager. Please ignore this for P1. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  ExtendibleHashTable<page_id_t, frame_id_t> *page_table_;
+  /**
+   * Page table for keeping track of buffer pool pages. Modified only under latch_, but read without it by the hit
+   * path of FetchPgImp().
+   */
+  PageTable *page_table_;
   /** Replacer to find unpinned pages for replacement. */
-  LRUKReplacer *replacer_;
+  Replacer *replacer_;
   /** List of free frames that don't have any pages on them. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * This latch protects the page table, the replacer, the free list, the I/O flags and the metadata of the frames.
+   * It is never held across disk I/O: a frame that is being read or written back is marked in io_in_progress_ instead.
+   */
   std::mutex latch_;
+  /**
+   * The dirty page table: resident dirty pages and the LSN of each when it was first dirtied. Ordered by page id, so
+   * that flushes walk the data file sequentially. Protected by latch_.
+   */
+  std::map<page_id_t, lsn_t> dirty_page_table_;
+  /** Whether a disk read or write-back is in flight on the frame. Protected by latch_. */
+  std::vector<bool> io_in_progress_;
+  /** Signalled whenever an I/O on some frame completes. */
+  std::condition_variable io_cv_;
+
+  /** The background page cleaner, if running. */
+  std::thread page_cleaner_thread_;
+  /** True while the page cleaner should keep running. Protected by latch_. */
+  bool page_cleaner_enabled_{false};
+  /** Wakes up the page cleaner when it has to stop. */
+  std::condition_variable page_cleaner_cv_;
+  /** Dirty pages written back by the page cleaner. */
+  std::atomic<uint64_t> background_cleaned_pages_{0};
+  /** Dirty pages written back when they were evicted. */
+  std::atomic<uint64_t> foreground_cleaned_pages_{0};
+
+  /** Fetches served from a resident page. Striped, because every hit bumps it without holding latch_. */
+  StripedCounter hits_;
+  /** Fetches that read the page from disk. */
+  std::atomic<uint64_t> misses_{0};
+  /** Total time of the misses in nanoseconds. */
+  std::atomic<uint64_t> miss_latency_ns_{0};
+  /** Fetches and new pages that found every frame pinned. */
+  std::atomic<uint64_t> failed_fetches_{0};
+  /** Pages evicted to make room for another page. */
+  std::atomic<uint64_t> evictions_{0};
+  /** Pages read in by the prefetch workers. */
+  std::atomic<uint64_t> prefetched_pages_{0};
+  /** Total time spent waiting in WaitForIo() in nanoseconds. */
+  std::atomic<uint64_t> pin_wait_ns_{0};
 
   /**
-   * @brief Allocate a page on disk. Caller should acquire the latch before calling this function.
+   * Frames accessed by the lock-free hit path, replayed into the replacer under latch_ before it picks a victim.
+   * The ring is lossy: when it wraps around before being drained, the oldest accesses are dropped.
+   */
+  std::vector<std::atomic<frame_id_t>> access_ring_;
+  /** Number of accesses ever pushed into access_ring_. */
+  std::atomic<size_t> access_ring_head_{0};
+  /** Number of accesses already replayed into the replacer. Protected by latch_. */
+  size_t access_ring_tail_{0};
+
+  /**
+   * Pages waiting to be read ahead, with the frame reserved for them or -1 if the worker has to find a victim itself.
+   * Protected by latch_.
+   */
+  std::deque<std::pair<page_id_t, frame_id_t>> prefetch_queue_;
+  /** Wakes up the prefetch workers. */
+  std::condition_variable prefetch_cv_;
+  /** Threads reading the pages of prefetch_queue_, started on the first PrefetchPages() call. */
+  std::vector<std::thread> prefetch_threads_;
+  /** Set when the prefetch workers have to exit. Protected by latch_. */
+  bool prefetch_shutdown_{false};
+
+  /**
+   * @brief Allocate a page on disk from the free space map of the disk manager. Caller should acquire the latch before
+   * calling this function. Pages deleted earlier are reused before the file grows.
    * @return the id of the allocated page
    */
   auto AllocatePage() -> page_id_t;
 
   /**
-   * @brief Deallocate a page on disk. Caller should acquire the latch before calling this function.
+   * @brief Validate that the page_id being used is accessible to this BPI. This can be used in all of the functions
+   * to validate input data and ensure that a parallel BPM is routing requests to the correct BPI.
+   * @param page_id id of the page to validate
+   */
+  void ValidatePageId(page_id_t page_id) const;
+
+  /**
+   * @brief Deallocate a page on disk, handing it back to the free space map of the disk manager for reuse. Caller
+   * should acquire the latch before calling this function.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  void DeallocatePage(page_id_t page_id);
 
   // TODO(student): You may add additional private members and helper functions
  private:
@@ -185,5 +391,130 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @return true if found victim, false otherwise
    */
   auto FindVictim(frame_id_t *available_frame_id) -> bool;
+
+  /**
+   * @brief Try to recycle the frame in the current slot of a scan's ring. Caller should acquire the latch.
+   * The frame can be recycled if the scan has read a quarter of the whole pool already, and the frame still holds the
+   * page the scan read into it and nobody pins it.
+   * @param strategy the scan's access strategy
+   * @param[out] frame_id the recycled frame, locked and removed from the replacer
+   * @return true if the frame was recycled, false if the caller has to find a victim with FindVictim()
+   */
+  auto RecycleRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id) -> bool;
+
+  /**
+   * @brief Implementation of FetchPgImp() and FetchPageWithStrategy().
+   * @param page_id id of page to be fetched
+   * @param strategy the scan's access strategy, or nullptr
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  auto FetchPageImpl(page_id_t page_id, BufferAccessStrategy *strategy) -> Page *;
+
+  /**
+   * @brief Implementation of NewPgImp() and NewPageWithId().
+   * @param page_id id of the page to create, INVALID_PAGE_ID to allocate one with AllocatePage()
+   * @return nullptr if all frames are pinned, otherwise pointer to new page
+   */
+  auto NewPageImpl(page_id_t page_id) -> Page *;
+
+  /**
+   * @brief Implementation of UnpinPgImp() and UnpinPages(). The caller must hold the latch through lock.
+   * @param lock the caller's lock on latch_
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page is not in the page table or its pin count is <= 0 before this call, true otherwise
+   */
+  auto UnpinPageLocked(std::unique_lock<std::mutex> *lock, page_id_t page_id, bool is_dirty) -> bool;
+
+  /**
+   * @brief Pin the page unless its frame is locked by the buffer pool (pin count -1), without taking the latch.
+   * Frames are locked while they are free, being evicted, deleted, read in or cleaned.
+   * @param page the page to pin
+   * @return true if the page was pinned
+   */
+  static auto TryPin(Page *page) -> bool;
+
+  /** Count a hit, for the instance and for the object the fetching thread works on. */
+  void RecordHit();
+
+  /** Count a miss that started at start, for the instance and for the object the fetching thread works on. */
+  void RecordMiss(std::chrono::steady_clock::time_point start);
+
+  /** @brief Record an access from the lock-free hit path into access_ring_. */
+  void RecordAccessLossy(frame_id_t frame_id);
+
+  /** @brief Replay the accesses in access_ring_ into the replacer. Caller should acquire the latch. */
+  void DrainAccessRing();
+
+  /**
+   * @brief Look up page_id in the page table, waiting for any I/O in flight on its frame to finish first.
+   * The caller must hold the latch through lock; it is released while waiting.
+   * @param lock the caller's lock on latch_
+   * @param page_id id of the page to look up
+   * @param[out] frame_id the frame holding the page
+   * @return true if the page is resident and no I/O is in progress on it, false if it is not resident
+   */
+  auto WaitForIo(std::unique_lock<std::mutex> *lock, page_id_t page_id, frame_id_t *frame_id) -> bool;
+
+  /**
+   * @brief Reserve a victim frame returned by FindVictim() for page_id and mark it as I/O in progress.
+   *
+   * page_id is mapped to the frame right away, so concurrent requests for the same page wait on the frame instead of
+   * issuing a second read. If the old page in the frame is dirty it is written back with the latch released. On return
+   * the frame is pinned once for page_id, its memory is zeroed, and the latch is held again.
+   *
+   * @param lock the caller's lock on latch_
+   * @param frame_id the victim frame
+   * @param page_id id of the page that will live in the frame
+   */
+  void ReserveFrame(std::unique_lock<std::mutex> *lock, frame_id_t frame_id, page_id_t page_id);
+
+  /**
+   * @brief Clear the I/O flag of a reserved frame, record the access in the replacer and wake up the waiters.
+   * Caller should acquire the latch before calling this function.
+   * @param frame_id the frame whose I/O finished
+   * @param pin true to hand the frame out pinned once, false to leave it unpinned and evictable (read-ahead)
+   */
+  void FinishIo(frame_id_t frame_id, bool pin = true);
+
+  /**
+   * @brief Give up a reserved frame whose read failed: unmap the page, return the frame to the free list and wake up
+   * the waiters, which will find the page missing. Caller should acquire the latch before calling this function.
+   * @param frame_id the frame whose read failed
+   */
+  void AbortIo(frame_id_t frame_id);
+
+  /**
+   * @brief Mark the page in the frame dirty, adding it to the dirty page table if it was clean.
+   * Caller should acquire the latch before calling this function.
+   */
+  void MarkDirty(frame_id_t frame_id);
+
+  /**
+   * @brief Mark the page in the frame clean after it was written back, removing it from the dirty page table.
+   * Caller should acquire the latch before calling this function.
+   */
+  void MarkClean(frame_id_t frame_id);
+
+  /** @brief Main loop of a prefetch worker. */
+  void PrefetchLoop();
+
+  /** @brief Stop and join the prefetch workers. */
+  void StopPrefetchThreads();
+
+  /**
+   * @brief Main loop of the background page cleaner.
+   * @param interval how long to sleep between two rounds
+   * @param target_clean_ratio fraction of the evictable frames to keep clean
+   */
+  void PageCleanerLoop(std::chrono::milliseconds interval, double target_clean_ratio);
+
+  /**
+   * @brief One round of the page cleaner: write back one batch of dirty frames at the cold end of the replacer.
+   * The caller must hold the latch through lock; it is released during the writes.
+   * @param lock the caller's lock on latch_
+   * @param target_clean_ratio fraction of the evictable frames to keep clean
+   */
+  void CleanPages(std::unique_lock<std::mutex> *lock, double target_clean_ratio);
 };
 }  // namespace bustub
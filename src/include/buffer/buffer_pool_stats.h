@@ -0,0 +1,144 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cstdint>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * StripedCounter is a counter that many threads can bump without fighting over one cache line. Every thread adds to
+ * one of a few cache-line-sized stripes, and reading the counter sums them up. Reads are not atomic with respect to
+ * concurrent adds, which is fine for statistics.
+ */
+class StripedCounter {
+ public:
+  StripedCounter() = default;
+
+  DISALLOW_COPY_AND_MOVE(StripedCounter);
+
+  /** Add delta to the counter. */
+  void Add(uint64_t delta) { stripes_[StripeOfThisThread()].value_.fetch_add(delta, std::memory_order_relaxed); }
+
+  /** @return the current value of the counter */
+  auto Load() const -> uint64_t {
+    uint64_t sum = 0;
+    for (const auto &stripe : stripes_) {
+      sum += stripe.value_.load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+ private:
+  static constexpr size_t NUM_STRIPES = 16;
+
+  struct alignas(64) Stripe {
+    std::atomic<uint64_t> value_{0};
+  };
+
+  /** Threads are assigned stripes round-robin on their first add. */
+  static auto StripeOfThisThread() -> size_t {
+    static std::atomic<size_t> next_stripe{0};
+    thread_local size_t stripe = next_stripe.fetch_add(1, std::memory_order_relaxed) % NUM_STRIPES;
+    return stripe;
+  }
+
+  std::array<Stripe, NUM_STRIPES> stripes_;
+};
+
+/**
+ * A point-in-time copy of the statistics of a buffer pool. The statistics of a parallel buffer pool are the sums over
+ * its instances.
+ */
+struct BufferPoolStats {
+  /** Number of frames. */
+  uint64_t pool_size_{0};
+  /** Fetches served from a resident page. */
+  uint64_t hits_{0};
+  /** Fetches that had to read the page from disk. */
+  uint64_t misses_{0};
+  /** Total time of the misses, from the lookup until the page was read, in nanoseconds. */
+  uint64_t miss_latency_ns_{0};
+  /** Fetches and new pages that failed because every frame was pinned. */
+  uint64_t failed_fetches_{0};
+  /** Pages that were evicted to make room for another page. */
+  uint64_t evictions_{0};
+  /** Dirty pages written back when they were evicted. */
+  uint64_t dirty_writes_{0};
+  /** Dirty pages written back by the page cleaner. */
+  uint64_t background_writes_{0};
+  /** Pages read in by the prefetch workers. */
+  uint64_t prefetched_pages_{0};
+  /** Total time fetches spent waiting for another thread's I/O on the page they wanted, in nanoseconds. */
+  uint64_t pin_wait_ns_{0};
+
+  /** @return the fraction of fetches that were hits, 0 if there were none */
+  auto HitRatio() const -> double {
+    return hits_ + misses_ == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(hits_ + misses_);
+  }
+
+  /** @return the average miss latency in microseconds, 0 if there were no misses */
+  auto AvgMissLatencyUs() const -> double {
+    return misses_ == 0 ? 0 : static_cast<double>(miss_latency_ns_) / static_cast<double>(misses_) / 1000;
+  }
+
+  auto operator+=(const BufferPoolStats &other) -> BufferPoolStats & {
+    pool_size_ += other.pool_size_;
+    hits_ += other.hits_;
+    misses_ += other.misses_;
+    miss_latency_ns_ += other.miss_latency_ns_;
+    failed_fetches_ += other.failed_fetches_;
+    evictions_ += other.evictions_;
+    dirty_writes_ += other.dirty_writes_;
+    background_writes_ += other.background_writes_;
+    prefetched_pages_ += other.prefetched_pages_;
+    pin_wait_ns_ += other.pin_wait_ns_;
+    return *this;
+  }
+};
+
+/**
+ * Buffer pool hits and misses caused by one table or index. Executors attribute the pages they fetch to an object by
+ * holding an AccessStatsScope while they touch it.
+ */
+struct ObjectAccessStats {
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+};
+
+/**
+ * AccessStatsScope makes the buffer pool charge the fetches of the current thread to an object until it goes out of
+ * scope. Scopes nest: the innermost one wins, and the outer one is restored when it ends.
+ */
+class AccessStatsScope {
+ public:
+  explicit AccessStatsScope(ObjectAccessStats *stats) : saved_(current_) { current_ = stats; }
+
+  ~AccessStatsScope() { current_ = saved_; }
+
+  DISALLOW_COPY_AND_MOVE(AccessStatsScope);
+
+  /** @return the object the fetches of this thread are charged to, nullptr if none */
+  static auto Current() -> ObjectAccessStats * { return current_; }
+
+ private:
+  static inline thread_local ObjectAccessStats *current_ = nullptr;
+  ObjectAccessStats *saved_;
+};
+
+}  // namespace bustub
@@ -12,17 +12,22 @@
 
 #pragma once
 
-#include <list>
+#include <atomic>
 #include <mutex>  // NOLINT
 #include <vector>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
+#include "common/macros.h"
 
 namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * Every frame has one reference bit. Recording an access to a tracked frame only sets the bit and takes no lock; the
+ * clock hand sweeps over the frames under the latch, clearing set bits and evicting the first evictable frame whose
+ * bit is already clear.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -32,21 +37,36 @@ class ClockReplacer : public Replacer {
    */
   explicit ClockReplacer(size_t num_pages);
 
+  DISALLOW_COPY_AND_MOVE(ClockReplacer);
+
   /**
    * Destroys the ClockReplacer.
    */
   ~ClockReplacer() override;
 
-  auto Victim(frame_id_t *frame_id) -> bool override;
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id = INVALID_PAGE_ID) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
-  void Pin(frame_id_t frame_id) override;
+  void Remove(frame_id_t frame_id) override;
 
-  void Unpin(frame_id_t frame_id) override;
+  auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> override;
 
   auto Size() -> size_t override;
 
  private:
-  // TODO(student): implement me!
+  /** Reference bit of every frame, set on access and cleared by the clock hand. */
+  std::vector<std::atomic<bool>> ref_;
+  /** Whether every frame is tracked. Written under latch_, read without it by RecordAccess(). */
+  std::vector<std::atomic<bool>> tracked_;
+  std::vector<bool> evictable_;
+  /** The next frame the clock hand looks at. */
+  size_t hand_{0};
+  size_t curr_size_{0};
+  size_t replacer_size_;
+  std::mutex latch_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena holds the page data of all the frames of a buffer pool instance in one anonymous memory mapping.
+ *
+ * Keeping the 4 KB data blocks in a region of their own, apart from the frame metadata, lets the region be backed by
+ * huge pages: a large pool then needs a few hundred TLB entries instead of one per frame. With HugePageMode::EXPLICIT
+ * the arena first tries a MAP_HUGETLB mapping and falls back to transparent huge pages when no huge pages are
+ * reserved. The arena can also be bound to a NUMA node, so that a buffer pool shard keeps its data local to the
+ * threads that use it.
+ */
+class FrameArena {
+ public:
+  /**
+   * @brief Map the memory of a new FrameArena. The memory is zeroed.
+   * @param num_frames the number of frames
+   * @param mode how the arena should be backed by huge pages
+   * @param numa_node the NUMA node to bind the memory to, -1 to leave the placement to the kernel
+   */
+  FrameArena(size_t num_frames, HugePageMode mode, int numa_node = -1);
+
+  /** @brief Unmap the memory of the arena. */
+  ~FrameArena();
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /** @return the data block of the frame, aligned to BUSTUB_PAGE_SIZE as direct I/O requires */
+  auto GetFrameData(frame_id_t frame_id) const -> char * {
+    return data_ + static_cast<size_t>(frame_id) * BUSTUB_PAGE_SIZE;
+  }
+
+  /** @return the huge page mode the arena is actually backed with, which may be weaker than the requested one */
+  auto GetHugePageMode() const -> HugePageMode { return mode_; }
+
+  /** @return the NUMA node the arena is bound to, -1 if it is not bound */
+  auto GetNumaNode() const -> int { return numa_node_; }
+
+  /** @return the number of NUMA nodes of this machine, at least 1 */
+  static auto NumaNodeCount() -> int;
+
+ private:
+  /** The start of the mapping. */
+  char *data_;
+  /** The length of the mapping in bytes, a multiple of the huge page size. */
+  size_t length_;
+  /** How the mapping is backed. */
+  HugePageMode mode_;
+  /** The node the mapping is bound to, or -1. */
+  int numa_node_{-1};
+};
+
+}  // namespace bustub
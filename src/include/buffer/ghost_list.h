@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// ghost_list.h
+//
+// Identification: src/include/buffer/ghost_list.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <unordered_map>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * GhostList remembers the ids of recently evicted pages, the most recent first, so that replacement policies like 2Q
+ * and ARC can tell when an evicted page is read back. Not thread-safe; the replacers use it under their latch.
+ */
+class GhostList {
+ public:
+  /** @brief Remember page_id as the most recently evicted page. */
+  void PushFront(page_id_t page_id) {
+    Erase(page_id);
+    pages_.push_front(page_id);
+    index_[page_id] = pages_.begin();
+  }
+
+  /** @brief Forget the least recently evicted page. The list must not be empty. */
+  void PopBack() {
+    index_.erase(pages_.back());
+    pages_.pop_back();
+  }
+
+  /**
+   * @brief Forget page_id.
+   * @return true if page_id was in the list
+   */
+  auto Erase(page_id_t page_id) -> bool {
+    auto it = index_.find(page_id);
+    if (it == index_.end()) {
+      return false;
+    }
+    pages_.erase(it->second);
+    index_.erase(it);
+    return true;
+  }
+
+  auto Contains(page_id_t page_id) const -> bool { return index_.count(page_id) > 0; }
+  auto Size() const -> size_t { return pages_.size(); }
+  auto Empty() const -> bool { return pages_.empty(); }
+
+ private:
+  std::list<page_id_t> pages_;
+  std::unordered_map<page_id_t, std::list<page_id_t>::iterator> index_;
+};
+
+}  // namespace bustub
@@ -13,11 +13,11 @@
 #pragma once
 
 #include <limits>
-#include <list>
 #include <mutex>  // NOLINT
-#include <unordered_map>
+#include <utility>
 #include <vector>
 
+#include "buffer/replacer.h"
 #include "common/config.h"
 #include "common/macros.h"
 
@@ -33,8 +33,13 @@ namespace bustub {
  * A frame with less than k historical references is given
  * +inf as its backward k-distance. When multiple frames have +inf backward k-distance,
  * classical LRU algorithm is used to choose victim.
+ *
+ * Every frame keeps its last k access timestamps in flat arrays indexed by frame id. The evictable frames are kept in
+ * two indexed min-heaps: frames with less than k accesses keyed on their earliest access, and the others keyed on
+ * their k-th most recent access. Non-evictable frames are in neither heap, so Evict never has to skip over pinned
+ * frames, and every operation except EvictionCandidates is O(log n) in the number of frames.
  */
-class LRUKReplacer {
+class LRUKReplacer : public Replacer {
  public:
   /**
    *
@@ -52,7 +57,7 @@ class LRUKReplacer {
    *
    * @brief Destroys the LRUReplacer.
    */
-  ~LRUKReplacer() = default;
+  ~LRUKReplacer() override = default;
 
   /**
    * TODO(P1): Add implementation
@@ -70,7 +75,7 @@ class LRUKReplacer {
    * @param[out] frame_id id of frame that is evicted.
    * @return true if a frame is evicted successfully, false if no frames can be evicted.
    */
-  auto Evict(frame_id_t *frame_id) -> bool;
+  auto Evict(frame_id_t *frame_id) -> bool override;
 
   /**
    * TODO(P1): Add implementation
@@ -82,8 +87,9 @@ class LRUKReplacer {
    * also use BUSTUB_ASSERT to abort the process if frame id is invalid.
    *
    * @param frame_id id of frame that received a new access.
+   * @param page_id id of the page held by the frame, unused by LRU-K
    */
-  void RecordAccess(frame_id_t frame_id);
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id = INVALID_PAGE_ID) override;
 
   /**
    * TODO(P1): Add implementation
@@ -102,7 +108,7 @@ class LRUKReplacer {
    * @param frame_id id of frame whose 'evictable' status will be modified
    * @param set_evictable whether the given frame is evictable or not
    */
-  void SetEvictable(frame_id_t frame_id, bool set_evictable);
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
 
   /**
    * TODO(P1): Add implementation
@@ -121,7 +127,18 @@ class LRUKReplacer {
    *
    * @param frame_id id of frame to be removed
    */
-  void Remove(frame_id_t frame_id);
+  void Remove(frame_id_t frame_id) override;
+
+  /**
+   * @brief Return up to max_frames evictable frames in the order Evict() would pick them, without evicting them.
+   *
+   * This lets the background page cleaner write back dirty frames at the cold end of the replacer before a
+   * foreground eviction has to.
+   *
+   * @param max_frames the maximum number of frames to return
+   * @return evictable frames, the next victim first
+   */
+  auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> override;
 
   /**
    * TODO(P1): Add implementation
@@ -130,23 +147,55 @@ class LRUKReplacer {
    *
    * @return size_t
    */
-  auto Size() -> size_t;
+  auto Size() -> size_t override;
 
-  struct FrameEntry {
-    size_t hit_count_{0};
-    bool evictable_{true};
-    // list 不会因为list改变而使iterator发生改变
-    std::list<frame_id_t>::iterator pos_;
+  /**
+   * A binary min-heap of frames keyed on a timestamp, which also remembers where every frame sits in the heap so that
+   * any frame can be removed or re-keyed in O(log n).
+   */
+  class FrameHeap {
+   public:
+    explicit FrameHeap(size_t num_frames) : pos_(num_frames, -1) {}
+
+    auto Empty() const -> bool { return heap_.empty(); }
+    auto Size() const -> size_t { return heap_.size(); }
+    auto Contains(frame_id_t frame_id) const -> bool { return pos_[frame_id] != -1; }
+    auto Top() const -> frame_id_t { return heap_.front().second; }
+    /** @return the (key, frame) pairs in heap order, the top first */
+    auto Entries() const -> const std::vector<std::pair<size_t, frame_id_t>> & { return heap_; }
+
+    void Push(frame_id_t frame_id, size_t key);
+    void Remove(frame_id_t frame_id);
+    void Update(frame_id_t frame_id, size_t key);
+
+   private:
+    void SiftUp(size_t i);
+    void SiftDown(size_t i);
+    void Swap(size_t i, size_t j);
+
+    std::vector<std::pair<size_t, frame_id_t>> heap_;
+    /** Index of every frame in heap_, -1 if the frame is not in the heap. */
+    std::vector<int64_t> pos_;
   };
 
  private:
-  // TODO(student): implement me! You can replace these member variables as you like.
-  // Remove maybe_unused if you start using them.
-  std::list<frame_id_t> hist_list_;
-  std::list<frame_id_t> cache_list_;
-  std::unordered_map<frame_id_t, FrameEntry> entries_;
-  [[maybe_unused]] size_t current_timestamp_{0};
-  size_t curr_size_{0};
+  /** @return the timestamp the frame is ordered by: its earliest access if it has less than k, else its k-th last */
+  auto KeyOf(frame_id_t frame_id) const -> size_t;
+
+  /** @brief Throw std::invalid_argument on frame ids the replacer was not sized for. */
+  void CheckFrameId(frame_id_t frame_id) const;
+
+  /** Number of accesses recorded for every frame, 0 if the frame is not tracked. */
+  std::vector<size_t> access_count_;
+  /** The last k access timestamps of every frame, as a ring of k entries starting at frame_id * k. */
+  std::vector<size_t> history_;
+  /** Whether every frame is evictable. */
+  std::vector<bool> evictable_;
+  /** Evictable frames with less than k accesses, keyed on their earliest access. */
+  FrameHeap hist_heap_;
+  /** Evictable frames with at least k accesses, keyed on their k-th most recent access. */
+  FrameHeap cache_heap_;
+  size_t current_timestamp_{0};
   size_t replacer_size_;
   size_t k_;
 
@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the ids of the pages resident in a buffer pool to the frames that hold them.
+ *
+ * It is an open-addressing hash table with linear probing. Its capacity is fixed when the buffer pool is created and
+ * is large enough that it never fills up. Every slot is a single atomic word holding a (page id, frame id) pair.
+ *
+ * Insert and Remove must be serialized by the caller; the buffer pool does that with its latch. Find takes no lock at
+ * all, so a page fetch that hits in the pool does not go through any global mutex. A lock-free Find always returns a
+ * pair that was in the table at some point, but it can return a stale pair and it can miss an entry that a concurrent
+ * Remove is moving. Callers must validate a hit against the frame itself and confirm a miss under their latch.
+ */
+class PageTable {
+ public:
+  /**
+   * @brief Create a new PageTable.
+   * @param num_frames number of frames in the buffer pool
+   */
+  explicit PageTable(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  /**
+   * @brief Find the frame holding the given page. Safe to call without holding the writers' latch.
+   * @param page_id id of the page to look up
+   * @param[out] frame_id the frame holding the page
+   * @return true if the page was found, false otherwise
+   */
+  auto Find(page_id_t page_id, frame_id_t &frame_id) const -> bool;
+
+  /**
+   * @brief Map page_id to frame_id, overwriting any previous mapping of page_id.
+   * Callers must serialize Insert and Remove.
+   * @param page_id id of the page
+   * @param frame_id the frame holding the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * @brief Remove the mapping of page_id. Callers must serialize Insert and Remove.
+   * @param page_id id of the page
+   * @return true if the page was in the table, false otherwise
+   */
+  auto Remove(page_id_t page_id) -> bool;
+
+ private:
+  /** A slot that holds no entry. No valid page id packs to it. */
+  static constexpr uint64_t EMPTY_SLOT = ~static_cast<uint64_t>(0);
+
+  static auto Pack(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static auto KeyOf(uint64_t slot) -> page_id_t { return static_cast<page_id_t>(slot >> 32); }
+  static auto ValueOf(uint64_t slot) -> frame_id_t { return static_cast<frame_id_t>(slot & 0xFFFFFFFF); }
+
+  /** @return the slot a page id hashes to. Page ids are mostly sequential, so they are scrambled first. */
+  auto HomeOf(page_id_t page_id) const -> size_t {
+    return static_cast<size_t>((static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >>
+                               shift_);
+  }
+
+  /** The slots of the table; the size is a power of two. */
+  std::vector<std::atomic<uint64_t>> slots_;
+  /** slots_.size() - 1 */
+  size_t mask_;
+  /** 64 - log2(slots_.size()) */
+  int shift_;
+};
+
+}  // namespace bustub
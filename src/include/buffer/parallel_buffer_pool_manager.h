@@ -0,0 +1,170 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/config.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager shards the buffer pool into several independent BufferPoolManagerInstances.
+ *
+ * Every page id is owned by exactly one instance (page_id % num_instances), so each instance keeps its own page
+ * table, replacer, free list and latch, and operations on pages of different instances never contend with each other.
+ * New pages are allocated round-robin across the instances; every instance hands out page ids that are congruent to
+ * its index, which keeps the ids unique across the whole pool.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * @brief Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManagerInstances to store
+   * @param pool_size the pool size of each BufferPoolManagerInstance
+   * @param disk_manager the disk manager
+   * @param replacer_k the lookback constant k for the LRU-K replacer of each instance
+   * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy of each instance
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            size_t replacer_k = LRUK_REPLACER_K, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU_K);
+
+  /**
+   * @brief Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @brief Return the total number of frames over all the instances. */
+  auto GetPoolSize() -> size_t override;
+
+  /** @brief Return the number of instances the pool is sharded into. */
+  auto GetNumInstances() const -> size_t { return instances_.size(); }
+
+  /**
+   * @brief Return the instance responsible for the given page id.
+   * @param page_id id of page
+   * @return pointer to the BufferPoolManagerInstance responsible for handling the page
+   */
+  auto GetBufferPoolManager(page_id_t page_id) -> BufferPoolManagerInstance *;
+
+  /**
+   * @brief Fetch the requested page from the responsible instance on behalf of a large scan.
+   * @param page_id id of page to be fetched
+   * @param strategy the scan's access strategy
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  auto FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * override;
+
+  /**
+   * @brief Split the pages by the instance responsible for them and forward the hint to every instance.
+   * @param page_ids ids of the pages to read ahead
+   * @param strategy the access strategy of the scan the pages are read for, if any
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy = nullptr) override;
+
+  /**
+   * @brief Create a new page with the next page id of an extent in the instance responsible for that id. The pages of
+   * an extent are contiguous in the file and spread over the instances like any other page ids.
+   * @param[out] page_id id of the created page
+   * @param extent the extent allocator of the table or index the page belongs to, nullptr to create the page like
+   * NewPage() does
+   * @return nullptr if all frames of the responsible instance are pinned, otherwise pointer to new page
+   */
+  auto NewPageInExtent(page_id_t *page_id, ExtentAllocator *extent) -> Page * override;
+
+  /**
+   * @brief Split the pages by the instance responsible for them and fetch each share in one batch.
+   * @param page_ids ids of the pages to be fetched
+   * @return the pages in the order of page_ids, nullptr for every page that cannot be fetched
+   */
+  auto FetchPages(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> override;
+
+  /**
+   * @brief Split the pages by the instance responsible for them and unpin each share in one batch.
+   * @param page_ids ids of the pages to be unpinned, once per occurrence
+   * @param is_dirty true if the pages should be marked as dirty, false otherwise
+   */
+  void UnpinPages(const std::vector<page_id_t> &page_ids, bool is_dirty) override;
+
+  /** @brief Return the dirty page tables of all the instances merged, ordered by page id. */
+  auto GetDirtyPageTable() -> std::map<page_id_t, lsn_t>;
+
+  /** @return the statistics of all the instances added up */
+  auto GetStats() -> BufferPoolStats override;
+
+ protected:
+  /**
+   * @brief Fetch the requested page from the responsible instance.
+   * @param page_id id of page to be fetched
+   * @return nullptr if page_id cannot be fetched, otherwise pointer to the requested page
+   */
+  auto FetchPgImp(page_id_t page_id) -> Page * override;
+
+  /**
+   * @brief Unpin the target page from the responsible instance.
+   * @param page_id id of page to be unpinned
+   * @param is_dirty true if the page should be marked as dirty, false otherwise
+   * @return false if the page pin count is <= 0 before this call, true otherwise
+   */
+  auto UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool override;
+
+  /**
+   * @brief Flush the target page to disk through the responsible instance.
+   * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
+   * @return false if the page could not be found in the page table, true otherwise
+   */
+  auto FlushPgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * @brief Create a new page in one of the instances.
+   *
+   * Instances are tried in round-robin order, starting from a different instance on every call, until one of them
+   * succeeds or all of them have been tried once.
+   *
+   * @param[out] page_id id of created page
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPgImp(page_id_t *page_id) -> Page * override;
+
+  /**
+   * @brief Delete a page from the responsible instance.
+   * @param page_id id of page to be deleted
+   * @return false if the page exists but could not be deleted, true if the page didn't exist or deletion succeeded
+   */
+  auto DeletePgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * @brief Flush all the pages of every instance to disk, then save the shared free space map once.
+   */
+  void FlushAllPgsImp() override;
+
+ private:
+  /** The individual buffer pool shards, indexed by page_id % num_instances. */
+  std::vector<std::unique_ptr<BufferPoolManagerInstance>> instances_;
+  /** The disk manager shared by all the instances. */
+  DiskManager *disk_manager_;
+  /** Instance that the next NewPage call starts probing from. */
+  std::atomic<size_t> next_instance_{0};
+};
+
+}  // namespace bustub
@@ -12,12 +12,20 @@
 
 #pragma once
 
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
 
+/** The replacement policies a BufferPoolManagerInstance can be created with. */
+enum class ReplacerType { LRU_K, LRU, CLOCK, TWO_Q, ARC };
+
 /**
  * Replacer is an abstract class that tracks page usage.
+ *
+ * A frame is tracked from its first RecordAccess() until it is evicted or removed. Newly tracked frames are evictable;
+ * the buffer pool marks them non-evictable while they are pinned. Only evictable frames can be evicted.
  */
 class Replacer {
  public:
@@ -25,23 +33,40 @@ class Replacer {
   virtual ~Replacer() = default;
 
   /**
-   * Remove the victim frame as defined by the replacement policy.
-   * @param[out] frame_id id of frame that was removed, nullptr if no victim was found
-   * @return true if a victim frame was found, false otherwise
+   * Evict the victim frame as defined by the replacement policy and forget about it.
+   * @param[out] frame_id id of frame that was evicted
+   * @return true if a victim frame was found, false if no frame is evictable
+   */
+  virtual auto Evict(frame_id_t *frame_id) -> bool = 0;
+
+  /**
+   * Record that the frame was accessed, starting to track it if it was not tracked yet. Policies that remember
+   * evicted pages (2Q, ARC) use page_id to recognize a page that comes back in another frame.
+   * @param frame_id id of the frame that was accessed
+   * @param page_id id of the page held by the frame
+   */
+  virtual void RecordAccess(frame_id_t frame_id, page_id_t page_id = INVALID_PAGE_ID) = 0;
+
+  /**
+   * Mark a tracked frame as evictable or not. Does nothing for frames that are not tracked.
+   * @param frame_id id of the frame
+   * @param set_evictable whether the frame may be evicted
    */
-  virtual auto Victim(frame_id_t *frame_id) -> bool = 0;
+  virtual void SetEvictable(frame_id_t frame_id, bool set_evictable) = 0;
 
   /**
-   * Pins a frame, indicating that it should not be victimized until it is unpinned.
-   * @param frame_id the id of the frame to pin
+   * Stop tracking an evictable frame whose page was deleted, without remembering the page as evicted. Does nothing for
+   * frames that are not tracked; throws std::logic_error for frames that are not evictable.
+   * @param frame_id id of the frame
    */
-  virtual void Pin(frame_id_t frame_id) = 0;
+  virtual void Remove(frame_id_t frame_id) = 0;
 
   /**
-   * Unpins a frame, indicating that it can now be victimized.
-   * @param frame_id the id of the frame to unpin
+   * Return up to max_frames evictable frames, roughly in the order Evict() would pick them, without evicting them.
+   * @param max_frames the maximum number of frames to return
+   * @return evictable frames, the next victim first
    */
-  virtual void Unpin(frame_id_t frame_id) = 0;
+  virtual auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> = 0;
 
   /** @return the number of elements in the replacer that can be victimized */
   virtual auto Size() -> size_t = 0;
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer.h
+//
+// Identification: src/include/buffer/two_queue_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "buffer/ghost_list.h"
+#include "buffer/replacer.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * TwoQueueReplacer implements the full 2Q policy of Johnson and Shasha.
+ *
+ * Frames whose page is seen for the first time enter the FIFO queue A1in, and further accesses while they are in A1in
+ * do not move them. When A1in grows beyond a quarter of the frames its oldest frame is evicted and the page id is
+ * remembered in the ghost queue A1out (half as many entries as frames). A page that is read back while it is in A1out
+ * has proven to be reused and goes to the LRU queue Am; Am is evicted from only while A1in is small.
+ */
+class TwoQueueReplacer : public Replacer {
+ public:
+  /**
+   * Create a new TwoQueueReplacer.
+   * @param num_frames the maximum number of frames the replacer will be required to store
+   */
+  explicit TwoQueueReplacer(size_t num_frames);
+
+  DISALLOW_COPY_AND_MOVE(TwoQueueReplacer);
+
+  ~TwoQueueReplacer() override = default;
+
+  auto Evict(frame_id_t *frame_id) -> bool override;
+
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id = INVALID_PAGE_ID) override;
+
+  void SetEvictable(frame_id_t frame_id, bool set_evictable) override;
+
+  void Remove(frame_id_t frame_id) override;
+
+  auto EvictionCandidates(size_t max_frames) -> std::vector<frame_id_t> override;
+
+  auto Size() -> size_t override;
+
+ private:
+  enum class Queue { NONE, A1IN, AM };
+
+  /** @return the queue Evict() looks at first */
+  auto PreferredQueue() -> std::list<frame_id_t> &;
+
+  /** @brief Untrack a frame and take it out of its queue. */
+  void Untrack(frame_id_t frame_id);
+
+  /** Resident frames seen once, the newest first. */
+  std::list<frame_id_t> a1in_;
+  /** Resident frames seen again after leaving A1in, the most recently used first. */
+  std::list<frame_id_t> am_;
+  /** Pages recently evicted from A1in. */
+  GhostList a1out_;
+  std::vector<Queue> queue_;
+  std::vector<std::list<frame_id_t>::iterator> pos_;
+  std::vector<page_id_t> page_ids_;
+  std::vector<bool> evictable_;
+  size_t curr_size_{0};
+  size_t replacer_size_;
+  /** Target size of A1in. */
+  size_t kin_;
+  /** Capacity of A1out. */
+  size_t kout_;
+  std::mutex latch_;
+};
+
+}  // namespace bustub
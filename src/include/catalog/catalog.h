@@ -56,6 +56,8 @@ struct TableInfo {
   std::unique_ptr<TableHeap> table_;
   /** The table OID */
   const table_oid_t oid_;
+  /** Buffer pool hits and misses on the pages of the table */
+  ObjectAccessStats access_stats_;
 };
 
 /**
@@ -91,6 +93,8 @@ struct IndexInfo {
   std::string table_name_;
   /** The size of the index key, in bytes */
   const size_t key_size_;
+  /** Buffer pool hits and misses on the pages of the index */
+  ObjectAccessStats access_stats_;
 };
 
 /**
@@ -228,12 +232,18 @@ class Catalog {
     // TODO(chi): support both hash index and btree index
     auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
 
-    // Populate the index with all tuples in table heap
+    // Populate the index with all tuples in table heap. The keys are collected first and the
+    // tree is built bottom-up from them, rather than descending from the root once per tuple.
     auto *table_meta = GetTable(table_name);
     auto *heap = table_meta->table_.get();
-    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
-      index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
+    BufferAccessStrategy strategy;
+    std::vector<std::pair<KeyType, ValueType>> entries;
+    for (auto tuple = heap->Begin(txn, &strategy); tuple != heap->End(); ++tuple) {
+      KeyType index_key;
+      index_key.SetFromKey(tuple->KeyFromTuple(schema, key_schema, key_attrs), &key_schema);
+      entries.emplace_back(index_key, tuple->GetRid());
     }
+    index->BulkLoad(&entries);
 
     // Get the next OID for the new index
     const auto index_oid = next_index_oid_.fetch_add(1);
@@ -211,9 +211,20 @@ class BustubInstance {
   auto MakeExecutorContext(Transaction *txn) -> std::unique_ptr<ExecutorContext>;
 
  public:
-  explicit BustubInstance(const std::string &db_file_name);
+  /**
+   * Create a BusTub instance on a database file.
+   * @param db_file_name the database file
+   * @param buffer_pool_size number of frames of the buffer pool; the log buffer is sized to match
+   * @param read_only if true, the database file is memory-mapped and never written, see DiskManagerMmap
+   */
+  explicit BustubInstance(const std::string &db_file_name,
+                          size_t buffer_pool_size = DEFAULT_INSTANCE_BUFFER_POOL_SIZE, bool read_only = false);
 
-  BustubInstance();
+  /**
+   * Create an in-memory BusTub instance.
+   * @param buffer_pool_size number of frames of the buffer pool; the log buffer is sized to match
+   */
+  explicit BustubInstance(size_t buffer_pool_size = DEFAULT_INSTANCE_BUFFER_POOL_SIZE);
 
   ~BustubInstance();
 
@@ -270,6 +281,7 @@ class BustubInstance {
   void CmdDisplayTables(ResultWriter &writer);
   void CmdDisplayIndices(ResultWriter &writer);
   void CmdDisplayHelp(ResultWriter &writer);
+  void CmdDisplayBufferPoolStats(ResultWriter &writer);
   void WriteOneCell(const std::string &cell, ResultWriter &writer);
   std::unordered_map<std::string, std::string> session_variables_;
 };
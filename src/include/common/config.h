@@ -14,8 +14,14 @@
 
 #include <atomic>
 #include <chrono>  // NOLINT
+#include <cstddef>
 #include <cstdint>
 
+/** The page size is a build option (-DBUSTUB_PAGE_SIZE=...) because the page layouts are laid out at compile time. */
+#ifndef BUSTUB_PAGE_SIZE_BYTES
+#define BUSTUB_PAGE_SIZE_BYTES 4096
+#endif
+
 namespace bustub {
 
 /** Cycle detection is performed every CYCLE_DETECTION_INTERVAL milliseconds. */
@@ -27,15 +33,64 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** The background page cleaner of a buffer pool wakes up every PAGE_CLEANER_INTERVAL. */
+extern std::chrono::milliseconds page_cleaner_interval;
+
+/** The background page cleaner tries to keep this fraction of the evictable frames clean. */
+extern double page_cleaner_target_clean_ratio;
+
+/** Sequential scans ask the buffer pool to read ahead this many pages. 0 disables read-ahead. */
+extern size_t read_ahead_window;
+
+/** How the frame data of a buffer pool is backed by huge pages. */
+enum class HugePageMode {
+  NONE,         // ordinary pages
+  TRANSPARENT,  // ordinary mapping, madvise()d for transparent huge pages
+  EXPLICIT,     // MAP_HUGETLB from the reserved huge pages, falling back to TRANSPARENT
+};
+
+/** The huge page mode of newly created buffer pool instances. */
+extern HugePageMode buffer_pool_huge_pages;
+
+/** If true, the instances of a parallel buffer pool bind their frame data round-robin to the NUMA nodes. */
+extern bool buffer_pool_numa_aware;
+
+/** If true, disk managers open the database file with O_DIRECT and the page cache of the kernel is bypassed. */
+extern bool disk_direct_io;
+
+/**
+ * If true, disk managers checksum the pages they write and verify the pages they read. Off by default: every write
+ * waits for a sync of the checksum file, which batched writes share but a single page write pays alone.
+ */
+extern bool page_checksums;
+
+/** If true, B+ tree point lookups first descend without latching and validate page versions instead. */
+extern bool optimistic_index_reads;
+
+/** Tables and indexes reserve page ids in extents of up to this many contiguous pages. 1 hands out pages one by one. */
+extern size_t extent_size;
+
+/** Fraction of each page a bulk-loaded B+ tree fills, leaving the rest for later inserts. */
+extern double index_fill_factor;
+
 static constexpr int INVALID_PAGE_ID = -1;                                           // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                            // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                               // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                             // the header page id
-static constexpr int BUSTUB_PAGE_SIZE = 4096;                                        // size of a data page in byte
+static constexpr int BUSTUB_PAGE_SIZE = BUSTUB_PAGE_SIZE_BYTES;                      // size of a data page in byte
 static constexpr int BUFFER_POOL_SIZE = 10;                                          // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
+static constexpr size_t DEFAULT_INSTANCE_BUFFER_POOL_SIZE = 128;  // frames of the buffer pool of a BustubInstance
+static constexpr size_t LOG_BUFFER_MAX_SIZE = 16 << 20;           // the log buffer stops growing with the pool here
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int PAGE_CLEANER_BATCH_SIZE = 16;  // max pages written back by the page cleaner per round
+static constexpr int PREFETCH_WORKER_NUM = 4;       // threads reading prefetched pages in each buffer pool instance
+static constexpr int BUFFER_ACCESS_STRATEGY_RING_SIZE = 32;  // frames a large scan may occupy in the buffer pool
+static constexpr int OPTIMISTIC_READ_ATTEMPTS = 3;  // optimistic B+ tree descents before taking read latches
+static constexpr int INDEX_SCAN_BATCH_PAGES = 8;     // table pages an index scan fetches in one batch
+static constexpr int DISK_SCHEDULER_WORKER_NUM = 4;  // threads serving the disk requests of each buffer pool instance
+static constexpr int MMAP_READ_AHEAD_PAGES = 64;     // pages a mapped file is read ahead of a sequential scan
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
@@ -46,4 +101,13 @@ using oid_t = uint16_t;
 
 static constexpr int VARCHAR_DEFAULT_LENGTH = 128;  // default length for varchar when constructing the column
 
+static_assert(BUSTUB_PAGE_SIZE >= 1024 && (BUSTUB_PAGE_SIZE & (BUSTUB_PAGE_SIZE - 1)) == 0,
+              "the page size must be a power of two of at least 1 KB");
+
+/** @return the size in bytes of the log buffer that goes with a buffer pool of buffer_pool_size frames */
+constexpr auto LogBufferSizeFor(size_t buffer_pool_size) -> size_t {
+  const size_t size = (buffer_pool_size + 1) * BUSTUB_PAGE_SIZE;
+  return size < LOG_BUFFER_MAX_SIZE ? size : LOG_BUFFER_MAX_SIZE;
+}
+
 }  // namespace bustub
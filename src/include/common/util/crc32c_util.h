@@ -0,0 +1,43 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_util.h
+//
+// Identification: src/include/common/util/crc32c_util.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * Crc32cUtil computes CRC32C (Castagnoli) checksums, with the crc32 instruction of SSE4.2 when the CPU has it and
+ * a slice-by-8 table otherwise. Both give the same results.
+ */
+class Crc32cUtil {
+ public:
+  /**
+   * @brief Compute the checksum of data, continuing from crc.
+   * @param data the bytes to checksum
+   * @param size the number of bytes
+   * @param crc the checksum of the bytes before data, 0 for none
+   * @return the checksum of all the bytes so far
+   */
+  static auto Crc32c(const char *data, size_t size, uint32_t crc = 0) -> uint32_t;
+
+  /** @return true if Crc32c() uses the crc32 instruction */
+  static auto HasHardwareSupport() -> bool;
+
+  /** @brief Crc32c() on the table path, whatever the CPU supports. */
+  static auto Crc32cSoftware(const char *data, size_t size, uint32_t crc = 0) -> uint32_t;
+
+  /** @brief Crc32c() on the crc32 instruction. Only call it if HasHardwareSupport(). */
+  static auto Crc32cHardware(const char *data, size_t size, uint32_t crc = 0) -> uint32_t;
+};
+
+}  // namespace bustub
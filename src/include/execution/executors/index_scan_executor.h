@@ -42,6 +42,12 @@ class IndexScanExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /** Lock the next RIDs, spanning at most INDEX_SCAN_BATCH_PAGES table pages, and read their tuples in one batch. */
+  void FetchNextBatch();
+
+  /** Take the row lock the isolation level asks for before the tuple is read. */
+  void LockRow(const RID &rid);
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
   //  IndexInfo *index_info_;
@@ -50,5 +56,9 @@ class IndexScanExecutor : public AbstractExecutor {
   std::vector<RID> result_;
   std::vector<RID>::iterator iter_begin_;
   std::vector<RID>::iterator iter_end_;
+  /** RIDs and tuples of the current batch, and the position of the next one to emit. */
+  std::vector<RID> batch_rids_;
+  std::vector<Tuple> batch_tuples_;
+  size_t batch_pos_{0};
 };
 }  // namespace bustub
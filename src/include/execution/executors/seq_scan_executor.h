@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "execution/executor_context.h"
@@ -51,6 +52,8 @@ class SeqScanExecutor : public AbstractExecutor {
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
   TableIterator table_iterator_ = {nullptr, RID(), nullptr};
+  /** 大表扫描只在一个小环里复用frame，避免把buffer pool里的热点页面冲掉；每次Init重新创建 */
+  std::unique_ptr<BufferAccessStrategy> strategy_;
   TableHeap *table_heap_;
   TableInfo *table_info_;
   // Transaction *txn_;
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <optional>
 #include <string>
 #include <utility>
 
@@ -21,7 +22,9 @@
 
 namespace bustub {
 /**
- * IndexScanPlanNode identifies a table that should be scanned with an optional predicate.
+ * IndexScanPlanNode identifies a table that should be scanned through an index. The scan visits the keys between
+ * the optional lower and upper bound in the given direction, and checks the tuples it reads against an optional
+ * predicate.
  */
 class IndexScanPlanNode : public AbstractPlanNode {
  public:
@@ -43,13 +46,40 @@ class IndexScanPlanNode : public AbstractPlanNode {
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
 
+  /** @return true if the scan looks up a single key, lower_ and upper_ being the same inclusive bound */
+  auto IsPointLookup() const -> bool {
+    return lower_.has_value() && upper_.has_value() && lower_inclusive_ && upper_inclusive_ &&
+           lower_->CompareEquals(*upper_) == CmpBool::CmpTrue;
+  }
+
   // Add anything you want here for index lookup
-  Value val_;
   std::string table_name_;
+  /** The lowest key value to scan, std::nullopt to start from the first key. */
+  std::optional<Value> lower_;
+  bool lower_inclusive_{true};
+  /** The highest key value to scan, std::nullopt to run to the last key. */
+  std::optional<Value> upper_;
+  bool upper_inclusive_{true};
+  /** The order the tuples are returned in. */
+  ScanDirection direction_{ScanDirection::FORWARD};
+  /** The most tuples to read from the index, std::nullopt for no limit. Only set when there is no filter. */
+  std::optional<size_t> limit_;
+  /** The predicate tuples must satisfy to be returned, nullptr for none. */
+  AbstractExpressionRef filter_predicate_;
 
  protected:
   auto PlanNodeToString() const -> std::string override {
-    return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
+    std::string range = fmt::format(
+        "{}{}, {}{}", lower_inclusive_ && lower_.has_value() ? "[" : "(",
+        lower_.has_value() ? lower_->ToString() : "-inf", upper_.has_value() ? upper_->ToString() : "+inf",
+        upper_inclusive_ && upper_.has_value() ? "]" : ")");
+    std::string direction = direction_ == ScanDirection::FORWARD ? "" : ", direction=backward";
+    std::string limit = limit_.has_value() ? fmt::format(", limit={}", *limit_) : "";
+    if (filter_predicate_ != nullptr) {
+      return fmt::format("IndexScan {{ index_oid={}, range={}{}{}, filter={} }}", index_oid_, range, direction, limit,
+                         filter_predicate_);
+    }
+    return fmt::format("IndexScan {{ index_oid={}, range={}{}{} }}", index_oid_, range, direction, limit);
   }
 };
 
@@ -17,47 +17,93 @@
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
 #include <string>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/free_space_map.h"
+#include "storage/disk/page_checksums.h"
 
 namespace bustub {
 
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * While page_checksums is on, every page written gets a CRC32C checksum, saved next to the database file as <db>.crc,
+ * and every page read back is verified against it.
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param direct_io if true, open the file with O_DIRECT so that pages bypass the page cache of the kernel, falling
+   * back to buffered I/O if the file system rejects it. Page buffers should then be aligned to BUSTUB_PAGE_SIZE,
+   * unaligned ones are transferred through an aligned copy.
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, bool direct_io = disk_direct_io);
 
   /** FOR TEST / LEADERBOARD ONLY, used by DiskManagerMemory */
   DiskManager() = default;
 
-  virtual ~DiskManager() = default;
+  virtual ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
    */
   void ShutDown();
 
+  /** @return true if the database file is accessed with direct I/O */
+  auto IsDirectIo() const -> bool;
+
+  /** @return the free space map of the database file, which allocates and reuses its page ids */
+  auto GetFreeSpaceMap() -> FreeSpaceMap * { return &free_space_map_; }
+
+  /**
+   * Save the free space map next to the database file, as <db>.fsm. The constructor and ShutDown() save it as well,
+   * and the changes in between are appended to the saved map. Does nothing for disk managers without a database file.
+   */
+  void SaveFreeSpaceMap();
+
+  /** @return the checksums of the pages of the database file */
+  auto GetPageChecksums() -> PageChecksums * { return &page_checksums_; }
+
   /**
-   * Write a page to the database file.
+   * Write a page to the database file. With page checksums on, the page is copied first, and the copy is checksummed
+   * and written, so that the checksum matches what reaches the disk even if the page is modified meanwhile. The
+   * checksum is synced to <db>.crc before the page is written.
    * @param page_id id of the page
    * @param page_data raw page data
    */
   virtual void WritePage(page_id_t page_id, const char *page_data);
 
   /**
-   * Read a page from the database file.
+   * Write several pages to the database file, like WritePage() does. The pages are written in the order of their ids,
+   * and a run of adjacent pages is written with one vectored write. The checksums of all the pages are synced with
+   * one sync, so batches are much cheaper than single pages while page checksums are on.
+   * @param page_ids ids of the pages
+   * @param page_data raw page data, page_data[i] holds page_ids[i]
+   */
+  virtual void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data);
+
+  /**
+   * Read a page from the database file. Pages past the end of the file read as zeros.
    * @param page_id id of the page
    * @param[out] page_data output buffer
+   * @throws Exception of type CORRUPTION if page checksums are on and the page does not match its checksum
    */
   virtual void ReadPage(page_id_t page_id, char *page_data);
 
+  /**
+   * Read several pages from the database file. The pages are read in the order of their ids, and a run of adjacent
+   * pages is read with one vectored read.
+   * @param page_ids ids of the pages
+   * @param[out] page_data output buffers, page_data[i] receives page_ids[i]
+   * @throws Exception of type CORRUPTION if page checksums are on and one of the pages does not match its checksum,
+   * after all the pages have been read
+   */
+  virtual void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data);
+
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
@@ -83,6 +129,15 @@ class DiskManager {
   /** @return the number of disk writes */
   auto GetNumWrites() const -> int;
 
+  /** @return the number of page reads */
+  auto GetNumReads() const -> uint64_t { return num_reads_; }
+
+  /** @return the total time spent in page reads, in nanoseconds */
+  auto GetReadTimeNs() const -> uint64_t { return read_time_ns_; }
+
+  /** @return the total time spent in page writes, in nanoseconds */
+  auto GetWriteTimeNs() const -> uint64_t { return write_time_ns_; }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -94,18 +149,36 @@ class DiskManager {
 
  protected:
   auto GetFileSize(const std::string &file_name) -> int;
+
+  /**
+   * @brief Verify pages that have just been read against their checksums, if page checksums are on. Pages that match
+   * settle which of their checksums is on disk, if that was unknown since a crash.
+   * @throws Exception of type CORRUPTION for the first page that does not match
+   */
+  void VerifyPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data);
+
+  /** @brief Write pages through a checksummed snapshot, or as they are if page checksums are off. */
+  void WritePagesChecksummed(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data);
+
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // file the free space map is saved to, empty if it is not saved
+  std::string fsm_name_;
+  FreeSpaceMap free_space_map_;
+  PageChecksums page_checksums_;
+  // descriptor of the db file, accessed with positional reads / writes only
+  int db_fd_{-1};
+  // true if db_fd_ was opened with O_DIRECT, so that transfers need aligned buffers
+  bool direct_io_{false};
   std::string file_name_;
   int num_flushes_{0};
-  int num_writes_{0};
+  std::atomic<int> num_writes_{0};
+  std::atomic<uint64_t> num_reads_{0};
+  std::atomic<uint64_t> read_time_ns_{0};
+  std::atomic<uint64_t> write_time_ns_{0};
   bool flush_log_{false};
   std::future<void> *flush_log_f_{nullptr};
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
 };
 
 }  // namespace bustub
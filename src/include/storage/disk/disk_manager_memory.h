@@ -45,6 +45,13 @@ class DiskManagerMemory : public DiskManager {
    */
   void WritePage(page_id_t page_id, const char *page_data) override;
 
+  /**
+   * Write several pages to the database file, one by one.
+   * @param page_ids ids of the pages
+   * @param page_data raw page data, page_data[i] holds page_ids[i]
+   */
+  void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data) override;
+
   /**
    * Read a page from the database file.
    * @param page_id id of the page
@@ -52,6 +59,13 @@ class DiskManagerMemory : public DiskManager {
    */
   void ReadPage(page_id_t page_id, char *page_data) override;
 
+  /**
+   * Read several pages from the database file, one by one.
+   * @param page_ids ids of the pages
+   * @param[out] page_data output buffers, page_data[i] receives page_ids[i]
+   */
+  void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) override;
+
  private:
   char *memory_;
 };
@@ -70,6 +84,7 @@ class DiskManagerUnlimitedMemory : public DiskManager {
    * @param page_data raw page data
    */
   void WritePage(page_id_t page_id, const char *page_data) override {
+    num_writes_ += 1;
     std::unique_lock<std::mutex> l(mutex_);
     if (page_id >= static_cast<int>(data_.size())) {
       data_.resize(page_id + 1);
@@ -84,12 +99,24 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     memcpy(ptr->first.data(), page_data, BUSTUB_PAGE_SIZE);
   }
 
+  /**
+   * Write several pages to the database file, one by one.
+   * @param page_ids ids of the pages
+   * @param page_data raw page data, page_data[i] holds page_ids[i]
+   */
+  void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data) override {
+    for (size_t i = 0; i < page_ids.size(); i++) {
+      WritePage(page_ids[i], page_data[i]);
+    }
+  }
+
   /**
    * Read a page from the database file.
    * @param page_id id of the page
    * @param[out] page_data output buffer
    */
   void ReadPage(page_id_t page_id, char *page_data) override {
+    num_reads_ += 1;
     std::unique_lock<std::mutex> l(mutex_);
     if (page_id >= static_cast<int>(data_.size()) || page_id < 0) {
       LOG_WARN("page not exist");
@@ -106,6 +133,17 @@ class DiskManagerUnlimitedMemory : public DiskManager {
     memcpy(page_data, ptr->first.data(), BUSTUB_PAGE_SIZE);
   }
 
+  /**
+   * Read several pages from the database file, one by one.
+   * @param page_ids ids of the pages
+   * @param[out] page_data output buffers, page_data[i] receives page_ids[i]
+   */
+  void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) override {
+    for (size_t i = 0; i < page_ids.size(); i++) {
+      ReadPage(page_ids[i], page_data[i]);
+    }
+  }
+
  private:
   std::mutex mutex_;
   using Page = std::array<char, BUSTUB_PAGE_SIZE>;
@@ -0,0 +1,106 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.h
+//
+// Identification: src/include/storage/disk/disk_manager_mmap.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * DiskManagerMmap serves the pages of a database file that is never modified, e.g. the copy on a read-only reporting
+ * replica. The file is mapped read-only, so opening it costs nothing up front, and ReadPage() is a memcpy from the
+ * mapping.
+ *
+ * The mapping is madvise()d for random access, so that point lookups don't fault in the neighbours of every page.
+ * Once the reads turn sequential, the next MMAP_READ_AHEAD_PAGES pages are madvise()d WILLNEED ahead of the scan.
+ *
+ * Pages written by the instance, such as the pages of temporary tables, never reach the file: they are kept in memory
+ * and shadow the file from then on.
+ */
+class DiskManagerMmap : public DiskManager {
+ public:
+  /**
+   * Map the database file.
+   * @param db_file the file name of the database file, it must exist
+   */
+  explicit DiskManagerMmap(const std::string &db_file);
+
+  ~DiskManagerMmap() override;
+
+  /**
+   * Keep a page in memory, in front of the file.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   */
+  void WritePage(page_id_t page_id, const char *page_data) override;
+
+  /**
+   * Keep several pages in memory, in front of the file.
+   * @param page_ids ids of the pages
+   * @param page_data raw page data, page_data[i] holds page_ids[i]
+   */
+  void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data) override;
+
+  /**
+   * Read a page, from memory if it was written, from the mapping otherwise. Pages past the end of the file read as
+   * zeros. Pages from the mapping are verified against the checksums saved by the primary.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   * @throws Exception of type CORRUPTION if page checksums are on and the page does not match its checksum
+   */
+  void ReadPage(page_id_t page_id, char *page_data) override;
+
+  /**
+   * Read several pages like ReadPage() does.
+   * @param page_ids ids of the pages
+   * @param[out] page_data output buffers, page_data[i] receives page_ids[i]
+   */
+  void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) override;
+
+  /** @return the number of pages of the mapped file */
+  auto GetMappedPages() const -> size_t { return (mapping_length_ + BUSTUB_PAGE_SIZE - 1) / BUSTUB_PAGE_SIZE; }
+
+ private:
+  /**
+   * @brief Copy one page into page_data.
+   * @return true if the page was copied from the file, false if it was written by this instance
+   */
+  auto CopyPage(page_id_t page_id, char *page_data) -> bool;
+
+  /** @brief Follow the access pattern, and madvise() the pages ahead of a sequential scan. */
+  void AdviseReadAhead(page_id_t page_id);
+
+  /** The read-only mapping of the whole file, nullptr if the file is empty. */
+  char *mapping_{nullptr};
+  size_t mapping_length_{0};
+
+  /** Page id the next read has if the reads are sequential. */
+  std::atomic<page_id_t> next_sequential_page_id_{INVALID_PAGE_ID};
+  /** Pages [0, read_ahead_end_) have been madvise()d WILLNEED already. */
+  std::atomic<page_id_t> read_ahead_end_{0};
+
+  using PageData = std::array<char, BUSTUB_PAGE_SIZE>;
+  /** Protects written_pages_. */
+  std::shared_mutex latch_;
+  /** The pages written since the file was mapped. */
+  std::unordered_map<page_id_t, std::unique_ptr<PageData>> written_pages_;
+};
+
+}  // namespace bustub
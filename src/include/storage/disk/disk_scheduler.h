@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.h
+//
+// Identification: src/include/storage/disk/disk_scheduler.h
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * @brief Represents a read or write request for the DiskManager to execute.
+ */
+struct DiskRequest {
+  /** Flag indicating whether the request is a write or a read. */
+  bool is_write_;
+
+  /** Ids of the pages being read from / written to disk. Adjacent pages are transferred with one vectored call. */
+  std::vector<page_id_t> page_ids_;
+
+  /** Start of the memory of every page, data_[i] belongs to page_ids_[i]: the destination of a read, the source of a
+   * write. */
+  std::vector<char *> data_;
+
+  /** Fulfilled once the request is done, carries the exception if the disk manager threw one. */
+  std::promise<void> callback_;
+};
+
+/**
+ * @brief The DiskScheduler hands read and write requests to a pool of worker threads, which execute them against the
+ * DiskManager. Several requests are in flight at once, so a single caller can keep more than one I/O outstanding.
+ *
+ * The workers are started on the first request.
+ */
+class DiskScheduler {
+ public:
+  explicit DiskScheduler(DiskManager *disk_manager, size_t num_workers = DISK_SCHEDULER_WORKER_NUM);
+  ~DiskScheduler();
+
+  DISALLOW_COPY_AND_MOVE(DiskScheduler);
+
+  /**
+   * @brief Schedule a request for the workers to execute.
+   * @param request the request, its page_ids_ and data_ must have the same size
+   * @return a future that becomes ready when the request is done
+   */
+  auto Schedule(DiskRequest request) -> std::future<void>;
+
+  /**
+   * @brief Read several pages and wait for them. Every run of adjacent page ids becomes one request, and all the
+   * requests are in flight at the same time.
+   * @param page_ids ids of the pages
+   * @param[out] page_data output buffers, page_data[i] receives page_ids[i]
+   */
+  void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data);
+
+  /**
+   * @brief Write several pages and wait for them, split into requests like ReadPages(). With page checksums on, the
+   * pages stay in one request instead, so that they share one sync of the checksum file.
+   * @param page_ids ids of the pages
+   * @param page_data raw page data, page_data[i] holds page_ids[i]
+   */
+  void WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data);
+
+  /** @brief Return the number of worker threads. */
+  auto GetNumWorkers() const -> size_t { return num_workers_; }
+
+ private:
+  /** @brief Split the pages into requests of adjacent page ids, schedule them all and wait for them. */
+  void ScheduleRuns(bool is_write, const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data);
+
+  /** @brief Main loop of a worker. */
+  void WorkerLoop();
+
+  /** The disk manager executing the requests. */
+  DiskManager *disk_manager_;
+  /** Number of worker threads. */
+  size_t num_workers_;
+  /** Protects request_queue_, workers_ and shutdown_. */
+  std::mutex latch_;
+  /** Wakes up the workers. */
+  std::condition_variable cv_;
+  /** Requests waiting for a worker. */
+  std::deque<DiskRequest> request_queue_;
+  /** The worker threads, started by the first Schedule() call. */
+  std::vector<std::thread> workers_;
+  /** Set when the workers have to exit. */
+  bool shutdown_{false};
+};
+
+}  // namespace bustub
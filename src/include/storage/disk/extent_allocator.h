@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extent_allocator.h
+//
+// Identification: src/include/storage/disk/extent_allocator.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "storage/disk/free_space_map.h"
+
+namespace bustub {
+
+/**
+ * ExtentAllocator hands out the page ids of one table heap or B+ tree from extents, runs of contiguous page ids that
+ * are reserved in the free space map for this owner alone. The pages of a table or index thus lie in a few contiguous
+ * ranges of the file, even when several of them grow at the same time, and scans and read-ahead hit sequential I/O.
+ *
+ * The first extent holds a single page, and every next one is twice as large up to the maximum extent size, so that
+ * small tables and indexes do not reserve much more than they use. The unused rest of the last extent stays reserved
+ * for the owner until the database shuts down and the free space map takes it back.
+ *
+ * An allocator may be shared by the threads that insert into its owner.
+ */
+class ExtentAllocator {
+ public:
+  /**
+   * @brief Create a new ExtentAllocator.
+   * @param max_extent_size the maximum number of pages reserved at once, 1 hands out the pages one by one
+   */
+  explicit ExtentAllocator(size_t max_extent_size = extent_size);
+
+  DISALLOW_COPY_AND_MOVE(ExtentAllocator);
+
+  /**
+   * @brief Take the next page id of the current extent, reserving a new extent in free_space_map when it is used up.
+   * @param free_space_map the free space map of the database file
+   * @return the page id
+   */
+  auto Allocate(FreeSpaceMap *free_space_map) -> page_id_t;
+
+  /** @return the number of extents reserved so far */
+  auto GetExtentCount() const -> size_t;
+
+ private:
+  mutable std::mutex latch_;
+  const page_id_t max_extent_size_;
+  /** The size of the next extent. */
+  page_id_t next_extent_size_{1};
+  /** The current extent, shared with the free space map. */
+  std::shared_ptr<FreeSpaceMap::Extent> extent_;
+  size_t extent_count_{0};
+};
+
+}  // namespace bustub
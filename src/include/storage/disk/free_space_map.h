@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.h
+//
+// Identification: src/include/storage/disk/free_space_map.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <set>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FreeSpaceMap keeps track of the page ids of a database file: the high-water mark of the ids handed out so far, and
+ * the pages below it that have been deleted and can be handed out again. Reusing deleted pages keeps the file from
+ * growing under delete churn.
+ *
+ * The map can be saved to and loaded from a file of its own, so that allocation carries on across restarts. Once
+ * saved, the map appends every page it hands out again and every page that is deleted to the file as well, and a
+ * page handed out again is synced there before the page is written, so that a crash between two saves does not leave
+ * a page that is in use listed as free.
+ */
+class FreeSpaceMap {
+ public:
+  FreeSpaceMap() = default;
+  ~FreeSpaceMap();
+
+  DISALLOW_COPY_AND_MOVE(FreeSpaceMap);
+
+  /**
+   * @brief Take the lowest free page id that is congruent to residue modulo stride, so that the instances of a
+   * parallel buffer pool only get their own page ids. If there is none, the lowest such id at or past the high-water
+   * mark is taken, and the ids skipped on the way become free for the other residues.
+   * @return the page id
+   */
+  auto Allocate(page_id_t stride, page_id_t residue) -> page_id_t;
+
+  /** Page ids reserved at once for one owner. The unused ones are [next_page_id_, end_page_id_), guarded by latch_. */
+  struct Extent {
+    page_id_t next_page_id_;
+    page_id_t end_page_id_;
+  };
+
+  /**
+   * @brief Reserve size contiguous page ids at once: the first run of size free pages if there is one, otherwise a run
+   * of free pages at the end of the file extended past the high-water mark, otherwise fresh ids at the high-water mark.
+   * The map keeps the extent until it is used up, so that ReleaseExtents() can take back the ids left unused.
+   * @return the extent
+   */
+  auto AllocateExtent(page_id_t size) -> std::shared_ptr<Extent>;
+
+  /**
+   * @brief Take the next page id of an extent.
+   * @return the page id, INVALID_PAGE_ID if the extent is used up
+   */
+  auto AllocateFromExtent(Extent *extent) -> page_id_t;
+
+  /**
+   * @brief Return the unused page ids of all extents to the free pages, when the database shuts down and the owners of
+   * the extents stop allocating. The extents are used up afterwards.
+   */
+  void ReleaseExtents();
+
+  /** @brief Record that a new page id has been handed out, raising the high-water mark past it. */
+  void MarkAllocated(page_id_t page_id);
+
+  /**
+   * @brief Return a page for reuse.
+   * @return false if the page is free already or has never been handed out
+   */
+  auto Deallocate(page_id_t page_id) -> bool;
+
+  /** @return true if the page is free */
+  auto IsFree(page_id_t page_id) const -> bool;
+
+  /** @return one past the highest page id ever handed out */
+  auto GetNextPageId() const -> page_id_t;
+
+  /** @return the number of free pages */
+  auto GetFreePageCount() const -> size_t;
+
+  /**
+   * @brief Write the map to a file. The map is written to a temporary file first and renamed over the old one, so a
+   * crash leaves either the old or the new map behind. Later changes are appended to the new file.
+   * @return false if the file cannot be written
+   */
+  auto Save(const std::string &file_name) -> bool;
+
+  /**
+   * @brief Replace the map by the one saved in a file, with the changes appended to it since.
+   * @return false if the file does not exist or is not a saved map, the map is left unchanged then
+   */
+  auto Load(const std::string &file_name) -> bool;
+
+  /**
+   * @brief Sync the changes appended since the last Save(), if a page has been handed out again since the last sync.
+   * Called before pages are written, so that a page in use is never listed as free in the file. Concurrent calls
+   * share one sync.
+   */
+  void SyncChanges();
+
+ private:
+  /** Identifies a saved map. */
+  static constexpr uint32_t MAGIC = 0x4d534642;  // "BFSM"
+
+  mutable std::mutex latch_;
+  /** The free page ids, all below next_page_id_. */
+  std::set<page_id_t> free_pages_;
+  page_id_t next_page_id_{0};
+  /** The extents that are not used up yet. */
+  std::vector<std::shared_ptr<Extent>> extents_;
+  /** True once the map has been saved, the changes are kept for the file from then on. */
+  bool keep_changes_{false};
+  /** The changes that are not in the file yet: a page id handed out again, or ~page_id for a deleted page. */
+  std::vector<int32_t> changes_;
+  /** Number of pages handed out again since the map was first saved. */
+  std::atomic<uint64_t> reused_count_{0};
+
+  /** Serializes the writes to the saved file, so that a sync covers every change before it. */
+  std::mutex file_latch_;
+  /** The saved file the changes are appended to, guarded by file_latch_. */
+  int fd_{-1};
+  /** Number of pages handed out again whose changes are synced to the file. */
+  std::atomic<uint64_t> synced_count_{0};
+};
+
+}  // namespace bustub
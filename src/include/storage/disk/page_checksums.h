@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_checksums.h
+//
+// Identification: src/include/storage/disk/page_checksums.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <shared_mutex>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageChecksums keeps a CRC32C checksum for every page of a database file, so that a page that was damaged on disk,
+ * or torn by a crash in the middle of its write, is detected when it is read back instead of being handed out.
+ *
+ * The page layouts use every byte of a page, so the checksums are kept out of the pages: in memory, and in a file of
+ * their own next to the database file, where page i has the i-th pair of 4 byte words: the checksum of its last write,
+ * and its checksum as of the last sync of the database file. The pair is saved and synced before the page is written,
+ * and a page that already has a write since the last sync of the database file is written again only after that sync,
+ * so whatever a crash leaves on disk, a page that is not torn matches one of the two, and only a torn page matches
+ * neither. After a crash it is unknown which of the two is on disk until the page is read.
+ *
+ * The checksum 0 means that the page has no checksum, because it was never written, or written with checksums turned
+ * off. Such pages are not verified.
+ */
+class PageChecksums {
+ public:
+  PageChecksums() = default;
+  ~PageChecksums();
+
+  DISALLOW_COPY_AND_MOVE(PageChecksums);
+
+  /**
+   * @brief Load the checksums saved in a file, and keep saving new checksums to it unless read_only.
+   * @param file_name the checksum file
+   * @param truncate if true, the saved checksums belong to a database file that no longer exists and are dropped
+   * @param read_only if true, new checksums are only kept in memory
+   * @return false if the file cannot be opened, the checksums are only kept in memory then
+   */
+  auto Open(const std::string &file_name, bool truncate, bool read_only = false) -> bool;
+
+  /**
+   * @brief Save the checksums and close the checksum file. The caller must have synced the database file, so the
+   * pages written since Open() keep only their last checksum. Later checksums are only kept in memory.
+   */
+  void Close();
+
+  /**
+   * @brief Compute the checksum of a page.
+   * @return the checksum, never 0
+   */
+  static auto Compute(const char *page_data) -> uint32_t;
+
+  /** @return the checksum of the page, 0 if it has none */
+  auto Get(page_id_t page_id) const -> uint32_t;
+
+  /**
+   * @return true if the page has no checksum, or checksum is the checksum of its last write or the one it had on disk
+   * before, which is that of a page of zeros before its first write
+   */
+  auto Matches(page_id_t page_id, uint32_t checksum) const -> bool;
+
+  /** @return the pages among page_ids of which it is unknown since a crash which of their two checksums is on disk */
+  auto GetUnresolved(const std::vector<page_id_t> &page_ids) const -> std::vector<page_id_t>;
+
+  /** @brief Record that the page on disk has the checksum, if it was unknown since a crash. */
+  void Resolve(page_id_t page_id, uint32_t checksum);
+
+  /**
+   * @brief Record the checksums of pages that are about to be written. Returns once the checksums are synced to the
+   * checksum file, with one sync for all the pages and the concurrent calls. The pages must not be unresolved.
+   * @param page_ids ids of the pages
+   * @param checksums checksums[i] is the checksum of page_ids[i], 0 to drop it
+   * @param data_fd the database file, synced first if one of the pages has been written since its last sync
+   */
+  void BeginWrite(const std::vector<page_id_t> &page_ids, const std::vector<uint32_t> &checksums, int data_fd);
+
+  /** @brief Record that the pages of a BeginWrite() have been written. */
+  void EndWrite(const std::vector<page_id_t> &page_ids);
+
+ private:
+  /** The checksums of a page, as saved in the checksum file. */
+  struct Entry {
+    /** Checksum of the last write of the page. */
+    uint32_t current_;
+    /** Checksum of the page as of the last sync of the database file, 0 if it had none. */
+    uint32_t durable_;
+  };
+
+  /** @brief Sync the database file, and make the checksums of the pages written before it durable. */
+  void SyncData(int data_fd);
+
+  /** @brief Write the entries of the pages to the checksum file, one write per run of adjacent pages. */
+  void SaveEntries(const std::vector<page_id_t> &page_ids);
+
+  mutable std::shared_mutex latch_;
+  /** entries_[i] holds the checksums of page i, pages past the end have none. */
+  std::vector<Entry> entries_;
+  /** writing_[i] is true between BeginWrite() and EndWrite() of page i. */
+  std::vector<bool> writing_;
+  /** unresolved_[i] is true if page i was loaded with two checksums and has not been read or written since. */
+  std::vector<bool> unresolved_;
+  /** Pages that may have been written since the last sync of the database file. */
+  std::vector<page_id_t> written_;
+  int fd_{-1};
+  /** Number of BeginWrite() calls whose entries have been written to the file, guarded by latch_. */
+  uint64_t written_seq_{0};
+  /** Serializes the syncs of the checksum file, so that a sync covers every write before it. */
+  std::mutex sync_latch_;
+  /** Number of BeginWrite() calls covered by a sync, guarded by sync_latch_. */
+  uint64_t synced_seq_{0};
+  /** Serializes the syncs of the database file. */
+  std::mutex data_sync_latch_;
+};
+
+}  // namespace bustub
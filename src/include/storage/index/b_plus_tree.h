@@ -10,6 +10,7 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <mutex>  // NOLINT
 #include <queue>
 #include <string>
 #include <vector>
@@ -18,6 +19,7 @@
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
@@ -52,14 +54,15 @@ class BPlusTree {
   // Remove a key and its value from this B+ tree.
   void Remove(const KeyType &key, Transaction *transaction = nullptr);
 
-  void HandleUnderflow(BPlusTreePage *page, Transaction *transaction);
+  // relink_page: 叶子合并后，吸收了右兄弟的叶子（已pin住），要在放掉所有锁后修正它下一个叶子的前驱指针
+  void HandleUnderflow(BPlusTreePage *page, Transaction *transaction, Page **relink_page);
 
   void UnpinSiblings(page_id_t left_sibling_id, page_id_t right_sibling_id, Page *left_page, Page *right_page);
 
   void SetPageParentId(page_id_t child_pageid, page_id_t parent_pageid);
 
   void MergePage(BPlusTreePage *left_page, BPlusTreePage *right_page, InternalPage *parent_page,
-                 Transaction *transaction);
+                 Transaction *transaction, Page **relink_page);
 
   auto TryBorrow(BPlusTreePage *page, BPlusTreePage *sibling_page, InternalPage *parent_page, bool sibling_at_left)
       -> bool;
@@ -72,6 +75,9 @@ class BPlusTree {
   // return the page id of the root node
   auto GetRootPageId() -> page_id_t;
 
+  // 乐观读失败（多次校验不通过）后退回到加读锁查找的次数
+  auto GetOptimisticFallbacks() const -> uint64_t { return optimistic_fallbacks_; }
+
   // return the leaf page
   auto GetLeafPage(const KeyType &key, Operation op, Transaction *transaction, bool first_pass = true) -> Page *;
 
@@ -87,6 +93,10 @@ class BPlusTree {
   // 从key开始的迭代器
   auto Begin(const KeyType &key) -> INDEXITERATOR_TYPE;
   auto End() -> INDEXITERATOR_TYPE;
+  // 从最后一个元素开始的反向迭代器
+  auto RBegin() -> INDEXITERATOR_TYPE;
+  // 从最后一个不大于key的元素开始的反向迭代器
+  auto RBegin(const KeyType &key) -> INDEXITERATOR_TYPE;
 
   // print the B+ tree
   void Print(BufferPoolManager *bpm);
@@ -100,9 +110,57 @@ class BPlusTree {
   // read data from file and remove one by one
   void RemoveFromFile(const std::string &file_name, Transaction *transaction = nullptr);
 
+  /**
+   * Build the tree bottom-up from entries instead of inserting them one by one. The entries are sorted
+   * here; for duplicate keys only the first one is kept, as Insert would do.
+   * @param entries the key-value pairs to load, reordered in place
+   * @param fill_factor fraction of each page to fill, clamped so that every non-root page stays within
+   * its min and max size
+   * @return false if the tree is not empty, in which case nothing is loaded
+   */
+  auto BulkLoad(std::vector<MappingType> *entries, double fill_factor = index_fill_factor) -> bool;
+
  private:
+  friend class IndexIterator<KeyType, ValueType, KeyComparator>;
+
   void UpdateRootPageId(int insert_record = 0);
 
+  /**
+   * Point the leaf after page back at page. The caller holds a pin on page and no latch; the pin is released here.
+   * Latches page and then the next leaf, in the same left-to-right order as every writer.
+   */
+  void RelinkNextLeaf(Page *page);
+
+  /**
+   * @brief Search from the root for the last entry before key, with read latches handed down level by level.
+   * @param key nullptr for the last entry of the tree
+   * @param inclusive true to also accept an entry equal to key
+   * @return a reverse iterator at the entry, End() if there is none
+   */
+  auto ReverseSeek(const KeyType *key, bool inclusive) -> INDEXITERATOR_TYPE;
+
+  /**
+   * Position a reverse iterator at entry index of the read-latched leaf, or, if index is -1, at the last entry of the
+   * previous leaf that is less than key (not greater than key if inclusive).
+   * @param key the bound for the previous leaf, nullptr for its last entry
+   * @return false if the previous leaf could not be latched without waiting, no longer links to this leaf or has no
+   * entry within the bound, in which case the caller has to search from the root again
+   */
+  auto PositionBackward(ReadPageGuard *guard, int index, const KeyType *key, bool inclusive,
+                        INDEXITERATOR_TYPE *iterator) -> bool;
+
+  // 在内部节点的前size个元素中找到key所在的子节点
+  auto LookupChild(const InternalPage *internal_page, const KeyType &key, int size) const -> page_id_t;
+
+  // 在叶子节点的前size个元素中查找key
+  auto LookupLeaf(const LeafPage *leaf_page, const KeyType &key, int size, ValueType *value) const -> bool;
+
+  // 不加读锁从根走到叶子，每一步都校验版本号；返回false表示有并发写，需要重试
+  auto TryGetValueOptimistic(const KeyType &key, std::vector<ValueType> *result, bool *found) -> bool;
+
+  // 把count个元素平均分到若干页里，每页的元素个数在[min_size, max_size]之间且尽量接近target；返回每页的元素个数
+  static auto PlanPages(size_t count, size_t target, size_t min_size, size_t max_size) -> std::vector<size_t>;
+
   /* Debug Routines for FREE!! */
   void ToGraph(BPlusTreePage *page, BufferPoolManager *bpm, std::ofstream &out) const;
 
@@ -116,6 +174,12 @@ class BPlusTree {
   int leaf_max_size_;
   int internal_max_size_;
   ReaderWriterLatch root_latch_;
+  // 本索引的新page从自己的extent里分配，叶子链在文件里是连续的
+  ExtentAllocator extent_allocator_;
+  std::atomic<uint64_t> optimistic_fallbacks_{0};
+  // 合并掉的page删除时还被pin住，留到下一次Remove再删
+  std::mutex deferred_deletes_latch_;
+  std::vector<page_id_t> deferred_deletes_;
 };
 
 }  // namespace bustub
@@ -14,6 +14,7 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "container/hash/hash_function.h"
@@ -35,6 +36,15 @@ class BPlusTreeIndex : public Index {
 
   void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) override;
 
+  void ScanRange(const IndexRange &range, std::vector<RID> *result, Transaction *transaction) override;
+
+  /**
+   * Build the index from all its entries at once, see BPlusTree::BulkLoad.
+   * @param entries the key-rid pairs to load, reordered in place
+   * @return false if the index is not empty, in which case nothing is loaded
+   */
+  auto BulkLoad(std::vector<std::pair<KeyType, ValueType>> *entries) -> bool;
+
   auto GetBeginIterator() -> INDEXITERATOR_TYPE;
 
   auto GetBeginIterator(const KeyType &key) -> INDEXITERATOR_TYPE;
@@ -14,6 +14,7 @@
 
 #include <cstring>
 
+#include "storage/index/key_codec.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -24,43 +25,33 @@ namespace bustub {
  *
  * This key type uses an fixed length array to hold data for indexing
  * purposes, the actual size of which is specified and instantiated
- * with a template argument.
+ * with a template argument. The data is encoded by KeyCodec, so two keys
+ * compare like their bytes do.
  */
 template <size_t KeySize>
 class GenericKey {
  public:
-  inline void SetFromKey(const Tuple &tuple) {
-    // intialize to 0
-    memset(data_, 0, KeySize);
-    memcpy(data_, tuple.GetData(), tuple.GetLength());
+  inline void SetFromKey(const Tuple &tuple, const Schema *key_schema) {
+    KeyCodec::Encode(tuple, key_schema, data_, KeySize);
   }
 
   // NOTE: for test purpose only
+  // encoded as a BIGINT column, or an INTEGER column if the key is too small for it
   inline void SetFromInteger(int64_t key) {
     memset(data_, 0, KeySize);
-    memcpy(data_, &key, sizeof(int64_t));
+    KeyCodec::EncodeInteger(key, IntegerWidth(), data_);
   }
 
   inline auto ToValue(Schema *schema, uint32_t column_idx) const -> Value {
-    const char *data_ptr;
-    const auto &col = schema->GetColumn(column_idx);
-    const TypeId column_type = col.GetType();
-    const bool is_inlined = col.IsInlined();
-    if (is_inlined) {
-      data_ptr = (data_ + col.GetOffset());
-    } else {
-      int32_t offset = *reinterpret_cast<int32_t *>(const_cast<char *>(data_ + col.GetOffset()));
-      data_ptr = (data_ + offset);
-    }
-    return Value::DeserializeFrom(data_ptr, column_type);
+    return KeyCodec::Decode(data_, KeySize, schema, column_idx);
   }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
-  inline auto ToString() const -> int64_t { return *reinterpret_cast<int64_t *>(const_cast<char *>(data_)); }
+  // interpret the data as the integer written by SetFromInteger
+  inline auto ToString() const -> int64_t { return KeyCodec::DecodeInteger(data_, IntegerWidth()); }
 
   // NOTE: for test purpose only
-  // interpret the first 8 bytes as int64_t from data vector
+  // interpret the data as the integer written by SetFromInteger
   friend auto operator<<(std::ostream &os, const GenericKey &key) -> std::ostream & {
     os << key.ToString();
     return os;
@@ -68,39 +59,37 @@ class GenericKey {
 
   // actual location of data, extends past the end.
   char data_[KeySize];
+
+ private:
+  static constexpr auto IntegerWidth() -> size_t {
+    return KeySize < sizeof(int64_t) ? sizeof(int32_t) : sizeof(int64_t);
+  }
 };
 
 /**
  * Function object returns true if lhs < rhs, used for trees
+ *
+ * The keys are encoded by KeyCodec, so they are compared with memcmp and the
+ * key schema is not needed. A 4 or 8 byte key, which is what a single
+ * INTEGER or BIGINT column encodes to, is compared as one unsigned integer.
  */
 template <size_t KeySize>
 class GenericComparator {
  public:
   inline auto operator()(const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) const -> int {
-    uint32_t column_count = key_schema_->GetColumnCount();
-
-    for (uint32_t i = 0; i < column_count; i++) {
-      Value lhs_value = (lhs.ToValue(key_schema_, i));
-      Value rhs_value = (rhs.ToValue(key_schema_, i));
-
-      if (lhs_value.CompareLessThan(rhs_value) == CmpBool::CmpTrue) {
-        return -1;
-      }
-      if (lhs_value.CompareGreaterThan(rhs_value) == CmpBool::CmpTrue) {
-        return 1;
-      }
+    if constexpr (KeySize == sizeof(uint32_t) || KeySize == sizeof(uint64_t)) {
+      const uint64_t lhs_bits = KeyCodec::LoadBigEndian(lhs.data_, KeySize);
+      const uint64_t rhs_bits = KeyCodec::LoadBigEndian(rhs.data_, KeySize);
+      return static_cast<int>(lhs_bits > rhs_bits) - static_cast<int>(lhs_bits < rhs_bits);
+    } else {
+      return memcmp(lhs.data_, rhs.data_, KeySize);
     }
-    // equals
-    return 0;
   }
 
-  GenericComparator(const GenericComparator &other) : key_schema_{other.key_schema_} {}
+  GenericComparator(const GenericComparator &other) = default;
 
   // constructor
-  explicit GenericComparator(Schema *key_schema) : key_schema_(key_schema) {}
-
- private:
-  Schema *key_schema_;
+  explicit GenericComparator(Schema * /* key_schema */) {}
 };
 
 }  // namespace bustub
@@ -13,11 +13,13 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "catalog/schema.h"
+#include "common/exception.h"
 #include "storage/table/tuple.h"
 #include "type/value.h"
 
@@ -25,6 +27,28 @@ namespace bustub {
 
 class Transaction;
 
+/** The order a range scan returns its entries in. */
+enum class ScanDirection { FORWARD, BACKWARD };
+
+/**
+ * IndexRange describes the keys a range scan visits. A missing bound leaves that end of the range open.
+ * The bounds are key tuples laid out by the key schema of the index.
+ */
+struct IndexRange {
+  /** The lowest key, std::nullopt to start from the first key */
+  std::optional<Tuple> lower_;
+  /** Whether a key equal to lower_ is in the range */
+  bool lower_inclusive_{true};
+  /** The highest key, std::nullopt to run to the last key */
+  std::optional<Tuple> upper_;
+  /** Whether a key equal to upper_ is in the range */
+  bool upper_inclusive_{true};
+  /** FORWARD for increasing key order, BACKWARD for decreasing */
+  ScanDirection direction_{ScanDirection::FORWARD};
+  /** Stop after this many RIDs, std::nullopt for no limit */
+  std::optional<size_t> limit_;
+};
+
 /**
  * class IndexMetadata - Holds metadata of an index object.
  *
@@ -175,6 +199,16 @@ class Index {
    */
   virtual void ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) = 0;
 
+  /**
+   * Search the index for all keys in a range. Only ordered indexes support it.
+   * @param range The bounds and direction of the scan
+   * @param result The collection of RIDs that is populated with results of the search, in key order
+   * @param transaction The transaction context
+   */
+  virtual void ScanRange(const IndexRange &range, std::vector<RID> *result, Transaction *transaction) {
+    throw NotImplementedException("range scan is not supported by index " + GetName());
+  }
+
  private:
   /** The Index structure owns its metadata */
   std::unique_ptr<IndexMetadata> metadata_;
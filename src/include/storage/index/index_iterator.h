@@ -14,25 +14,45 @@
  */
 #pragma once
 #include "storage/page/b_plus_tree_leaf_page.h"
+#include "storage/page/page_guard.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+INDEX_TEMPLATE_ARGUMENTS
+class BPlusTree;
+
+/**
+ * Iterates the leaves of a B+ tree in key order, or in reverse key order when it comes from BPlusTree::RBegin().
+ *
+ * A reverse iterator copies each entry while the leaf is read-latched and remembers its key. To move on it latches
+ * the leaf again and looks the key up, so splits, merges and borrows in between are seen. Moving to the previous
+ * leaf goes against the left-to-right order in which writers latch leaves, so it only try-latches the previous leaf
+ * and, if that fails or the backward link is stale, searches from the root for the last key before the current one.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
  public:
   // you may define your own constructor based on your member variables
   IndexIterator();
   IndexIterator(page_id_t page_id, page_id_t index_in_leaf, BufferPoolManager *bpm);
+  /** A reverse iterator positioned at entry, the index_in_leaf-th entry of the leaf, copied under its latch. */
+  IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, page_id_t page_id, int index_in_leaf,
+                const MappingType &entry, BufferPoolManager *bpm);
   ~IndexIterator();  // NOLINT
 
   auto IsEnd() -> bool;
 
+  /** @return true if the iterator moves in decreasing key order */
+  auto IsReverse() const -> bool { return tree_ != nullptr; }
+
   auto operator*() -> const MappingType &;
 
   auto operator++() -> IndexIterator &;
 
+  IndexIterator(IndexIterator &&other) noexcept;
+
   auto operator=(IndexIterator &&other) noexcept -> IndexIterator &;
 
   auto operator==(const IndexIterator &itr) const -> bool {
@@ -47,14 +67,25 @@ class IndexIterator {
   auto GetSize() const -> page_id_t { return leaf_page_->GetSize(); }
 
  private:
+  /** Ask the buffer pool to read ahead the next leaf (the previous one for a reverse iterator). */
+  void ReadAhead();
+
+  /** Move a reverse iterator to the last entry before the current key. */
+  void StepBackward();
+
   // add your own private member variables here
   // 页id
   page_id_t page_id_ = INVALID_PAGE_ID;
-  Page *page_ = nullptr;
-  B_PLUS_TREE_LEAF_PAGE_TYPE *leaf_page_ = nullptr;
+  // 当前叶子一直被pin住，直到迭代器移到下一个叶子或被析构
+  BasicPageGuard guard_;
+  const B_PLUS_TREE_LEAF_PAGE_TYPE *leaf_page_ = nullptr;
   // 页内id
   int index_in_leaf_ = 0;
+  // 叶子里key和value分开存放，operator*返回的是拷贝出来的这一项
+  MappingType current_;
   BufferPoolManager *buffer_pool_manager_ = nullptr;
+  // 反向迭代器从根重新查找时要用到的树；正向迭代器为nullptr
+  BPlusTree<KeyType, ValueType, KeyComparator> *tree_ = nullptr;
 };
 
 }  // namespace bustub
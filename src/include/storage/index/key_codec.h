@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_codec.h
+//
+// Identification: src/include/storage/index/key_codec.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+
+#include "catalog/schema.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * KeyCodec encodes index keys so that comparing two encoded keys byte by byte, as memcmp does, orders them the
+ * same way as comparing their columns one by one.
+ *
+ * The columns of the key schema are written one after another:
+ * - BOOLEAN, TINYINT, SMALLINT, INTEGER, BIGINT: big-endian with the sign bit flipped
+ * - DECIMAL: big-endian IEEE 754 bits; negative numbers have all bits flipped, the others only the sign bit
+ * - TIMESTAMP: big-endian
+ * - VARCHAR: 0x00 for NULL, otherwise 0x01 followed by the bytes of the string and a 0x00 terminator
+ *
+ * NULL of a fixed-width type is written as all zero bytes, so NULL sorts before every other value. TIMESTAMP is the
+ * exception: 0 is a valid timestamp, so NULL keeps its value BUSTUB_TIMESTAMP_NULL and sorts after every other
+ * timestamp. Encoding stops when the key buffer is full: a VARCHAR that does not fit is ordered by the prefix that
+ * does, and the columns after it are left out. The rest of the buffer is zero.
+ */
+class KeyCodec {
+ public:
+  /**
+   * Encode a key tuple into a key buffer.
+   * @param key the key tuple, laid out by key_schema
+   * @param key_schema the schema of the key
+   * @param[out] data the key buffer
+   * @param size the size of the key buffer
+   */
+  static void Encode(const Tuple &key, const Schema *key_schema, char *data, size_t size);
+
+  /**
+   * Decode one column of an encoded key.
+   * @return the value of the column, NULL if the column did not fit into the key buffer
+   */
+  static auto Decode(const char *data, size_t size, const Schema *key_schema, uint32_t column_idx) -> Value;
+
+  /** Write the lowest width bytes of an integer big-endian with the sign bit flipped. */
+  static inline void EncodeInteger(int64_t value, size_t width, char *data) {
+    const auto sign_bit = uint64_t{1} << (width * 8 - 1);
+    StoreBigEndian(static_cast<uint64_t>(value) ^ sign_bit, width, data);
+  }
+
+  /** @return the integer written by EncodeInteger */
+  static inline auto DecodeInteger(const char *data, size_t width) -> int64_t {
+    const auto sign_bit = uint64_t{1} << (width * 8 - 1);
+    // 翻转符号位后再做符号扩展
+    const auto bits = LoadBigEndian(data, width) ^ sign_bit;
+    const auto shift = 64 - width * 8;
+    return static_cast<int64_t>(bits << shift) >> shift;
+  }
+
+  /** @return the lowest width bytes of data, read as a big-endian unsigned integer */
+  static inline auto LoadBigEndian(const char *data, size_t width) -> uint64_t {
+    uint64_t bits = 0;
+    for (size_t i = 0; i < width; i++) {
+      bits = (bits << 8) | static_cast<uint8_t>(data[i]);
+    }
+    return bits;
+  }
+
+  /** Write the lowest width bytes of bits big-endian. */
+  static inline void StoreBigEndian(uint64_t bits, size_t width, char *data) {
+    for (size_t i = width; i > 0; i--) {
+      data[i - 1] = static_cast<char>(bits & 0xff);
+      bits >>= 8;
+    }
+  }
+};
+
+}  // namespace bustub
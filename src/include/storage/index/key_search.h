@@ -0,0 +1,98 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search.h
+//
+// Identification: src/include/storage/index/key_search.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#include "storage/index/generic_key.h"
+
+namespace bustub {
+
+/**
+ * KeySearch finds the position of a key in a sorted array of keys, as B+ tree pages do on every lookup.
+ *
+ * Keys of 4 and 8 bytes encoded by KeyCodec are searched as unsigned big-endian integers: a binary search narrows
+ * the range down to a few cache lines, which are then compared against the key all at once with AVX2 when the CPU
+ * has it. Other keys fall back to a binary search with the comparator.
+ */
+class KeySearch {
+ public:
+  /**
+   * @brief Find the first key that is not less than key.
+   * @param keys the keys, sorted in increasing order
+   * @param count the number of keys
+   * @return the index of the key, count if every key is less than key
+   */
+  template <typename KeyType, typename KeyComparator>
+  static auto LowerBound(const KeyType *keys, int count, const KeyType &key, const KeyComparator &comp) -> int {
+    if constexpr (IsEncodedInteger<KeyType, KeyComparator>()) {
+      return Search(reinterpret_cast<const char *>(keys), count, reinterpret_cast<const char *>(&key),
+                    sizeof(KeyType), false);
+    } else {
+      return BinarySearch(keys, count, [&](const KeyType &probe) { return comp(probe, key) < 0; });
+    }
+  }
+
+  /** @brief Find the first key that is greater than key; count if there is none. */
+  template <typename KeyType, typename KeyComparator>
+  static auto UpperBound(const KeyType *keys, int count, const KeyType &key, const KeyComparator &comp) -> int {
+    if constexpr (IsEncodedInteger<KeyType, KeyComparator>()) {
+      return Search(reinterpret_cast<const char *>(keys), count, reinterpret_cast<const char *>(&key),
+                    sizeof(KeyType), true);
+    } else {
+      return BinarySearch(keys, count, [&](const KeyType &probe) { return comp(probe, key) <= 0; });
+    }
+  }
+
+  /**
+   * @brief Search width-byte big-endian keys, with AVX2 if the CPU has it.
+   * @param upper false for the first key not less than key, true for the first key greater than key
+   */
+  static auto Search(const char *keys, int count, const char *key, size_t width, bool upper) -> int;
+
+  /** @return true if Search() uses AVX2 */
+  static auto HasSimdSupport() -> bool;
+
+  /** @brief Search() with only scalar compares, whatever the CPU supports. */
+  static auto SearchScalar(const char *keys, int count, const char *key, size_t width, bool upper) -> int;
+
+  /** @brief Search() with AVX2. Only call it if HasSimdSupport(). */
+  static auto SearchSimd(const char *keys, int count, const char *key, size_t width, bool upper) -> int;
+
+ private:
+  /** @return true if the keys are KeyCodec integers that Search() can handle */
+  template <typename KeyType, typename KeyComparator>
+  static constexpr auto IsEncodedInteger() -> bool {
+    return std::is_same_v<KeyType, GenericKey<sizeof(KeyType)>> &&
+           std::is_same_v<KeyComparator, GenericComparator<sizeof(KeyType)>> &&
+           (sizeof(KeyType) == sizeof(uint32_t) || sizeof(KeyType) == sizeof(uint64_t));
+  }
+
+  /** @return the first index whose key does not satisfy before, which holds for a prefix of the keys */
+  template <typename KeyType, typename Predicate>
+  static auto BinarySearch(const KeyType *keys, int count, Predicate before) -> int {
+    int low = 0;
+    int high = count;
+    while (low < high) {
+      int mid = low + (high - low) / 2;
+      if (before(keys[mid])) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return low;
+  }
+};
+
+}  // namespace bustub
@@ -18,7 +18,10 @@ namespace bustub {
 
 #define B_PLUS_TREE_INTERNAL_PAGE_TYPE BPlusTreeInternalPage<KeyType, ValueType, KeyComparator>
 #define INTERNAL_PAGE_HEADER_SIZE 24
-#define INTERNAL_PAGE_SIZE ((BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)))
+// 插入后、分裂前页面会暂时多放一个元素，要给它留一个槽
+#define INTERNAL_PAGE_SIZE ((BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(MappingType)) - 1)
+#define INTERNAL_PAGE_SLOT_COUNT \
+  ((BUSTUB_PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / (sizeof(KeyType) + sizeof(ValueType)))
 /**
  * Store n indexed keys and n+1 child pointers (page_id) within internal page.
  * Pointer PAGE_ID(i) points to a subtree in which all keys K satisfy:
@@ -27,10 +30,12 @@ namespace bustub {
  * the first key always remains invalid. That is to say, any search/lookup
  * should ignore the first key.
  *
- * Internal page format (keys are stored in increasing order):
- *  --------------------------------------------------------------------------
- * | HEADER | KEY(1)+PAGE_ID(1) | KEY(2)+PAGE_ID(2) | ... | KEY(n)+PAGE_ID(n) |
- *  --------------------------------------------------------------------------
+ * Internal page format (keys are stored in increasing order). As in leaf
+ * pages, the keys are kept together so that a search only touches keys:
+ *  ----------------------------------------------------------------------------------
+ * | HEADER | KEY(1) | ... | KEY(n) | (free) | PAGE_ID(1) | ... | PAGE_ID(n) | (free) |
+ *  ----------------------------------------------------------------------------------
+ *  The page ids start after INTERNAL_PAGE_SLOT_COUNT key slots.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeInternalPage : public BPlusTreePage {
@@ -45,12 +50,24 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   void SetValueAt(int index, const ValueType &value);
   void Insert(const KeyType &key, const ValueType &value, const KeyComparator &comp);
   auto FindValue(page_id_t pageid) const -> int;
+  // 在前size个元素中找key所在子节点的下标
+  auto ChildIndex(const KeyType &key, const KeyComparator &comp, int size) const -> int;
   void RemoveAt(int index);
 
  private:
   // void ExcavateIndex(int index);
   // void FillIndex(int index);
+  auto Keys() -> KeyType * { return reinterpret_cast<KeyType *>(data_); }
+  auto Keys() const -> const KeyType * { return reinterpret_cast<const KeyType *>(data_); }
+  auto Values() -> ValueType * {
+    return reinterpret_cast<ValueType *>(data_ + INTERNAL_PAGE_SLOT_COUNT * sizeof(KeyType));
+  }
+  auto Values() const -> const ValueType * {
+    return reinterpret_cast<const ValueType *>(data_ + INTERNAL_PAGE_SLOT_COUNT * sizeof(KeyType));
+  }
+
   // Flexible array member for page data.
-  MappingType array_[1];
+  // 前INTERNAL_PAGE_SLOT_COUNT个槽放key，后面放子节点的page id
+  char data_[1];
 };
 }  // namespace bustub
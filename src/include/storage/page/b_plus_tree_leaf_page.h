@@ -18,26 +18,34 @@
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
+#define LEAF_PAGE_HEADER_SIZE 32
 #define LEAF_PAGE_SIZE ((BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
+#define LEAF_PAGE_SLOT_COUNT ((BUSTUB_PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / (sizeof(KeyType) + sizeof(ValueType)))
 
 /**
  * Store indexed key and record id(record id = page id combined with slot id,
  * see include/common/rid.h for detailed implementation) together within leaf
  * page. Only support unique key.
  *
- * Leaf page format (keys are stored in order):
- *  ----------------------------------------------------------------------
- * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
- *  ----------------------------------------------------------------------
+ * Leaf page format (keys are stored in order). The keys are kept together
+ * so that a search only touches the cache lines that hold keys, and keys of
+ * 4 or 8 bytes can be compared several at a time with SIMD (see KeySearch):
+ *  ---------------------------------------------------------------------------
+ * | HEADER | KEY(1) | ... | KEY(n) | (free) | RID(1) | ... | RID(n) | (free) |
+ *  ---------------------------------------------------------------------------
+ *  The RIDs start after LEAF_PAGE_SLOT_COUNT key slots.
  *
- *  Header format (size in byte, 28 bytes in total):
+ *  Header format (size in byte, 32 bytes in total):
  *  ---------------------------------------------------------------------
  * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
  *  ---------------------------------------------------------------------
- *  -----------------------------------------------
- * | ParentPageId (4) | PageId (4) | NextPageId (4)
- *  -----------------------------------------------
+ *  --------------------------------------------------------------
+ * | ParentPageId (4) | PageId (4) | NextPageId (4) | PrevPageId (4)
+ *  --------------------------------------------------------------
+ *
+ * NextPageId is exact: it only changes while the page is write-latched. PrevPageId is
+ * fixed up after a split or merge once the writer has released its latches, so a reader
+ * going backward must check that the previous leaf still points back at this one.
  */
 INDEX_TEMPLATE_ARGUMENTS
 class BPlusTreeLeafPage : public BPlusTreePage {
@@ -48,20 +56,32 @@ class BPlusTreeLeafPage : public BPlusTreePage {
   // helper methods
   auto GetNextPageId() const -> page_id_t;
   void SetNextPageId(page_id_t next_page_id);
+  auto GetPrevPageId() const -> page_id_t;
+  void SetPrevPageId(page_id_t prev_page_id);
   auto KeyAt(int index) const -> KeyType;
   auto ValueAt(int index) const -> ValueType;
-  auto KeyValueAt(int index) const -> const MappingType &;
+  auto KeyValueAt(int index) const -> MappingType;
   void SetKeyValueAt(int index, KeyType key, ValueType value);
   void Insert(const KeyType &key, const ValueType &value, const KeyComparator &comp);
   void MoveDataTo(B_PLUS_TREE_LEAF_PAGE_TYPE *new_page, int count);
-  auto LowerBound(const KeyType &key, const KeyComparator &comp) -> int;
+  // 在前size个元素中找第一个不小于key的位置
+  auto LowerBound(const KeyType &key, const KeyComparator &comp, int size) const -> int;
   void Remove(const KeyType &key, const KeyComparator &comp);
   void RemoveAt(int index);
 
  private:
-  // 链表
+  auto Keys() -> KeyType * { return reinterpret_cast<KeyType *>(data_); }
+  auto Keys() const -> const KeyType * { return reinterpret_cast<const KeyType *>(data_); }
+  auto Values() -> ValueType * { return reinterpret_cast<ValueType *>(data_ + LEAF_PAGE_SLOT_COUNT * sizeof(KeyType)); }
+  auto Values() const -> const ValueType * {
+    return reinterpret_cast<const ValueType *>(data_ + LEAF_PAGE_SLOT_COUNT * sizeof(KeyType));
+  }
+
+  // 双向链表
   page_id_t next_page_id_;
+  page_id_t prev_page_id_;
   // Flexible array member for page data.  柔性数组 只能为类的最后一个 在不确定数组大小时使用
-  MappingType array_[1];
+  // 前LEAF_PAGE_SLOT_COUNT个槽放key，后面放value
+  char data_[1];
 };
 }  // namespace bustub
@@ -0,0 +1,266 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard.h
+//
+// Identification: src/include/storage/page/page_guard.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+#include <utility>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * BasicPageGuard keeps a page pinned for as long as it lives and unpins it when it is dropped or destroyed. It does not
+ * latch the page. Guards are movable but not copyable, and an empty (default-constructed or moved-from) guard holds no
+ * page.
+ */
+class BasicPageGuard {
+ public:
+  BasicPageGuard() = default;
+
+  /** Take over the pin the caller already holds on page. A nullptr page gives an empty guard. */
+  BasicPageGuard(BufferPoolManager *bpm, Page *page) : bpm_(bpm), page_(page) {}
+
+  BasicPageGuard(const BasicPageGuard &) = delete;
+  auto operator=(const BasicPageGuard &) -> BasicPageGuard & = delete;
+
+  BasicPageGuard(BasicPageGuard &&that) noexcept
+      : bpm_(std::exchange(that.bpm_, nullptr)),
+        page_(std::exchange(that.page_, nullptr)),
+        is_dirty_(std::exchange(that.is_dirty_, false)) {}
+
+  auto operator=(BasicPageGuard &&that) noexcept -> BasicPageGuard & {
+    if (this != &that) {
+      Drop();
+      bpm_ = std::exchange(that.bpm_, nullptr);
+      page_ = std::exchange(that.page_, nullptr);
+      is_dirty_ = std::exchange(that.is_dirty_, false);
+    }
+    return *this;
+  }
+
+  ~BasicPageGuard() { Drop(); }
+
+  /** Unpin the page now, marking it dirty if it was written through the guard. The guard becomes empty. */
+  void Drop() {
+    if (page_ != nullptr) {
+      bpm_->UnpinPage(page_->GetPageId(), is_dirty_);
+      page_ = nullptr;
+      is_dirty_ = false;
+    }
+  }
+
+  /** @return true if the guard holds a page */
+  auto IsValid() const -> bool { return page_ != nullptr; }
+
+  auto PageId() const -> page_id_t { return page_->GetPageId(); }
+
+  auto GetData() const -> const char * { return page_->GetData(); }
+
+  /** @return the page data interpreted as T, e.g. a B+ tree page */
+  template <class T>
+  auto As() const -> const T * {
+    return reinterpret_cast<const T *>(GetData());
+  }
+
+  /** @return the page data for writing; the page will be unpinned dirty */
+  auto GetDataMut() -> char * {
+    is_dirty_ = true;
+    return page_->GetData();
+  }
+
+  template <class T>
+  auto AsMut() -> T * {
+    return reinterpret_cast<T *>(GetDataMut());
+  }
+
+  /** @return the page itself as T, for page types that derive from Page such as TablePage */
+  template <class T>
+  auto AsPage() const -> T * {
+    return static_cast<T *>(page_);
+  }
+
+ private:
+  friend class ReadPageGuard;
+  friend class WritePageGuard;
+  friend class OptimisticPageGuard;
+
+  BufferPoolManager *bpm_{nullptr};
+  Page *page_{nullptr};
+  bool is_dirty_{false};
+};
+
+/** ReadPageGuard keeps a page pinned and read-latched. The latch is released before the pin. */
+class ReadPageGuard {
+ public:
+  ReadPageGuard() = default;
+
+  /** Take over the pin the caller already holds on page and read-latch it. */
+  ReadPageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {
+    if (page != nullptr) {
+      page->RLatch();
+    }
+  }
+
+  /** Take over the pin and the read latch the caller already holds on page. */
+  ReadPageGuard(BufferPoolManager *bpm, Page *page, std::adopt_lock_t /*unused*/) : guard_(bpm, page) {}
+
+  ReadPageGuard(ReadPageGuard &&that) noexcept = default;
+
+  auto operator=(ReadPageGuard &&that) noexcept -> ReadPageGuard & {
+    if (this != &that) {
+      Drop();
+      guard_ = std::move(that.guard_);
+    }
+    return *this;
+  }
+
+  ~ReadPageGuard() { Drop(); }
+
+  /** Release the latch and the pin now. */
+  void Drop() {
+    if (guard_.page_ != nullptr) {
+      guard_.page_->RUnlatch();
+      guard_.Drop();
+    }
+  }
+
+  auto IsValid() const -> bool { return guard_.IsValid(); }
+
+  auto PageId() const -> page_id_t { return guard_.PageId(); }
+
+  auto GetData() const -> const char * { return guard_.GetData(); }
+
+  template <class T>
+  auto As() const -> const T * {
+    return guard_.As<T>();
+  }
+
+  template <class T>
+  auto AsPage() const -> T * {
+    return guard_.AsPage<T>();
+  }
+
+ private:
+  BasicPageGuard guard_;
+};
+
+/** WritePageGuard keeps a page pinned and write-latched. The page is unpinned dirty if it was written. */
+class WritePageGuard {
+ public:
+  WritePageGuard() = default;
+
+  /** Take over the pin the caller already holds on page and write-latch it. */
+  WritePageGuard(BufferPoolManager *bpm, Page *page) : guard_(bpm, page) {
+    if (page != nullptr) {
+      page->WLatch();
+    }
+  }
+
+  /** Take over the pin and the write latch the caller already holds on page. */
+  WritePageGuard(BufferPoolManager *bpm, Page *page, std::adopt_lock_t /*unused*/) : guard_(bpm, page) {}
+
+  WritePageGuard(WritePageGuard &&that) noexcept = default;
+
+  auto operator=(WritePageGuard &&that) noexcept -> WritePageGuard & {
+    if (this != &that) {
+      Drop();
+      guard_ = std::move(that.guard_);
+    }
+    return *this;
+  }
+
+  ~WritePageGuard() { Drop(); }
+
+  /** Release the latch and the pin now. */
+  void Drop() {
+    if (guard_.page_ != nullptr) {
+      guard_.page_->WUnlatch();
+      guard_.Drop();
+    }
+  }
+
+  auto IsValid() const -> bool { return guard_.IsValid(); }
+
+  auto PageId() const -> page_id_t { return guard_.PageId(); }
+
+  auto GetData() const -> const char * { return guard_.GetData(); }
+
+  template <class T>
+  auto As() const -> const T * {
+    return guard_.As<T>();
+  }
+
+  auto GetDataMut() -> char * { return guard_.GetDataMut(); }
+
+  template <class T>
+  auto AsMut() -> T * {
+    return guard_.AsMut<T>();
+  }
+
+  template <class T>
+  auto AsPage() -> T * {
+    guard_.is_dirty_ = true;
+    return guard_.AsPage<T>();
+  }
+
+ private:
+  BasicPageGuard guard_;
+};
+
+/**
+ * OptimisticPageGuard keeps a page pinned without latching it, and remembers the version of the page when the guard
+ * was taken. Readers read the page through it and then call Validate(): if no writer latched the page in the meantime,
+ * what they read is consistent, otherwise they have to throw it away and retry (or fall back to a ReadPageGuard).
+ *
+ * Anything read before validating may be torn, so it must not be used to index outside the page or to follow a page id
+ * until Validate() returned true.
+ */
+class OptimisticPageGuard {
+ public:
+  OptimisticPageGuard() = default;
+
+  /** Take over the pin the caller already holds on page and remember its version. */
+  OptimisticPageGuard(BufferPoolManager *bpm, Page *page)
+      : guard_(bpm, page), version_(page != nullptr ? page->GetVersion() : 0) {}
+
+  OptimisticPageGuard(OptimisticPageGuard &&that) noexcept = default;
+
+  auto operator=(OptimisticPageGuard &&that) noexcept -> OptimisticPageGuard & = default;
+
+  ~OptimisticPageGuard() = default;
+
+  /** Release the pin now. */
+  void Drop() { guard_.Drop(); }
+
+  auto IsValid() const -> bool { return guard_.IsValid(); }
+
+  auto PageId() const -> page_id_t { return guard_.PageId(); }
+
+  auto GetData() const -> const char * { return guard_.GetData(); }
+
+  template <class T>
+  auto As() const -> const T * {
+    return guard_.As<T>();
+  }
+
+  /** @return true if the page was not being written when the guard was taken and has not been written since */
+  auto Validate() const -> bool { return (version_ & 1) == 0 && guard_.page_->ValidateVersion(version_); }
+
+ private:
+  BasicPageGuard guard_;
+  uint64_t version_{0};
+};
+
+}  // namespace bustub
@@ -12,6 +12,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
@@ -23,6 +25,7 @@ namespace bustub {
 /**
  * TableHeap represents a physical table on disk.
  * This is just a doubly-linked list of pages.
+ * Pages that become empty are not deleted: they stay linked in the list, and later inserts fill them again.
  */
 class TableHeap {
   friend class TableIterator;
@@ -99,8 +102,21 @@ class TableHeap {
    */
   auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock = true) -> bool;
 
-  /** @return the begin iterator of this table */
-  auto Begin(Transaction *txn) -> TableIterator;
+  /**
+   * Read several tuples from the table. The pages they live on are fetched in one batch and unpinned in one batch.
+   * @param rids rids of the tuples to read
+   * @param[out] tuples output variable for the tuples, tuples[i] receives the tuple of rids[i]
+   * @param txn transaction performing the read
+   * @return true if all the reads were successful (i.e. all the tuples exist)
+   */
+  auto GetTuples(const std::vector<RID> &rids, std::vector<Tuple> *tuples, Transaction *txn) -> bool;
+
+  /**
+   * @param txn transaction performing the scan
+   * @param strategy access strategy for a large scan that should not flush the buffer pool, or nullptr
+   * @return the begin iterator of this table
+   */
+  auto Begin(Transaction *txn, BufferAccessStrategy *strategy = nullptr) -> TableIterator;
 
   /** @return the end iterator of this table */
   auto End() -> TableIterator;
@@ -113,6 +129,8 @@ class TableHeap {
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  /** Hands out the ids of new pages of this table, so that its page chain is contiguous in the file. */
+  ExtentAllocator extent_allocator_;
 };
 
 }  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <cassert>
 
+#include "buffer/buffer_access_strategy.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 #include "storage/table/tuple.h"
@@ -29,10 +30,15 @@ class TableIterator {
   friend class Cursor;
 
  public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        strategy_(other.strategy_),
+        read_ahead_start_(other.read_ahead_start_),
+        read_ahead_end_(other.read_ahead_end_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -54,13 +60,29 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    strategy_ = other.strategy_;
+    read_ahead_start_ = other.read_ahead_start_;
+    read_ahead_end_ = other.read_ahead_end_;
     return *this;
   }
 
  private:
+  /**
+   * Ask the buffer pool to read ahead the pages following next_page_id. Table pages are mostly allocated one after
+   * the other, so besides the next page of the chain the following page ids are prefetched as well, keeping
+   * read_ahead_window pages in flight in front of the scan.
+   * @param next_page_id the page the scan is going to visit next
+   */
+  void ReadAhead(page_id_t next_page_id);
+
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** The access strategy the pages of the scan are fetched with, not owned. nullptr for a normal scan. */
+  BufferAccessStrategy *strategy_;
+  /** The pages in [read_ahead_start_, read_ahead_end_) have been prefetched already. */
+  page_id_t read_ahead_start_{INVALID_PAGE_ID};
+  page_id_t read_ahead_end_{INVALID_PAGE_ID};
 };
 
 }  // namespace bustub
@@ -1,6 +1,12 @@
+#include <algorithm>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
 #include "execution/plans/abstract_plan.h"
 #include "execution/plans/filter_plan.h"
 #include "execution/plans/index_scan_plan.h"
@@ -26,39 +32,149 @@ auto Optimizer::OptimizeCustom(const AbstractPlanNodeRef &plan) -> AbstractPlanN
   return p;
 }
 
+namespace {
+
+/** The bounds the conjuncts of a predicate put on one column. */
+struct ColumnRange {
+  std::optional<Value> lower_;
+  bool lower_inclusive_{true};
+  std::optional<Value> upper_;
+  bool upper_inclusive_{true};
+  bool has_equal_{false};
+};
+
+/** Split a predicate into the expressions that are AND-ed together. */
+void CollectConjuncts(const AbstractExpressionRef &expr, std::vector<AbstractExpressionRef> *conjuncts) {
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(expr.get());
+      logic_expr != nullptr && logic_expr->logic_type_ == LogicType::And) {
+    CollectConjuncts(logic_expr->GetChildAt(0), conjuncts);
+    CollectConjuncts(logic_expr->GetChildAt(1), conjuncts);
+    return;
+  }
+  conjuncts->push_back(expr);
+}
+
+/** @return the comparison that means the same after swapping its two sides */
+auto MirrorComparison(ComparisonType comp_type) -> ComparisonType {
+  switch (comp_type) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return comp_type;
+  }
+}
+
+void TightenLower(ColumnRange *range, const Value &value, bool inclusive) {
+  if (!range->lower_.has_value() || value.CompareGreaterThan(*range->lower_) == CmpBool::CmpTrue) {
+    range->lower_ = value;
+    range->lower_inclusive_ = inclusive;
+  } else if (value.CompareEquals(*range->lower_) == CmpBool::CmpTrue) {
+    range->lower_inclusive_ = range->lower_inclusive_ && inclusive;
+  }
+}
+
+void TightenUpper(ColumnRange *range, const Value &value, bool inclusive) {
+  if (!range->upper_.has_value() || value.CompareLessThan(*range->upper_) == CmpBool::CmpTrue) {
+    range->upper_ = value;
+    range->upper_inclusive_ = inclusive;
+  } else if (value.CompareEquals(*range->upper_) == CmpBool::CmpTrue) {
+    range->upper_inclusive_ = range->upper_inclusive_ && inclusive;
+  }
+}
+
+}  // namespace
+
 auto Optimizer::OptimizeIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
   std::vector<AbstractPlanNodeRef> children;
   for (const auto &child : plan->GetChildren()) {
     children.emplace_back(OptimizeIndexScan(child));
   }
   auto optimized_plan = plan->CloneWithChildren(std::move(children));
-  // LOG_INFO("get optimized type{%d}  childtype{%d}", (int)optimized_plan->GetType(),
-  // (int)optimized_plan->GetChildAt(0)->GetType());
-  if (optimized_plan->GetType() == PlanType::Filter && optimized_plan->GetChildAt(0)->GetType() == PlanType::SeqScan) {
-    BUSTUB_ENSURE(optimized_plan->children_.size() == 1, "index scan no possible !!!");
-    // const auto &child_plan = optimized_plan->children_[0];
-    // const auto &seq_scan_plan = dynamic_cast<const SeqScanPlanNode &>(*child_plan);
-    const auto &filter_plan = dynamic_cast<const FilterPlanNode &>(*optimized_plan);
-    const auto &seq_plan = dynamic_cast<const SeqScanPlanNode &>(*optimized_plan->GetChildAt(0));
-    // to do judge the filter type
-    if (const auto *expr = dynamic_cast<const ComparisonExpression *>(filter_plan.predicate_.get()); expr != nullptr) {
-      if (expr->comp_type_ == ComparisonType::Equal) {
-        if (const auto *left_expr = dynamic_cast<const ColumnValueExpression *>(expr->children_[0].get());
-            left_expr != nullptr) {
-          if (const auto *right_expr = dynamic_cast<const ConstantValueExpression *>(expr->children_[1].get());
-              right_expr != nullptr) {
-            if (auto index = MatchIndex(seq_plan.table_name_, left_expr->GetColIdx()); index != std::nullopt) {
-              auto [index_oid, index_name] = *index;
-              auto index_plan = std::make_shared<IndexScanPlanNode>(plan->output_schema_, index_oid);
-              index_plan->val_ = right_expr->val_;
-              index_plan->table_name_ = seq_plan.table_name_;
-              // LOG_INFO("get here");
-              return index_plan;
-            }
-          }
-        }
-      }
+  if (optimized_plan->GetType() != PlanType::Filter || optimized_plan->GetChildAt(0)->GetType() != PlanType::SeqScan) {
+    return optimized_plan;
+  }
+  BUSTUB_ENSURE(optimized_plan->children_.size() == 1, "index scan no possible !!!");
+  const auto &filter_plan = dynamic_cast<const FilterPlanNode &>(*optimized_plan);
+  const auto &seq_plan = dynamic_cast<const SeqScanPlanNode &>(*optimized_plan->GetChildAt(0));
+
+  // 把AND连起来的 列 op 常量 收集成每一列上的范围，=、<、<=、>、>=和BETWEEN都能用索引
+  std::vector<AbstractExpressionRef> conjuncts;
+  CollectConjuncts(filter_plan.predicate_, &conjuncts);
+  std::vector<uint32_t> column_order;
+  std::unordered_map<uint32_t, ColumnRange> ranges;
+  for (const auto &conjunct : conjuncts) {
+    const auto *expr = dynamic_cast<const ComparisonExpression *>(conjunct.get());
+    if (expr == nullptr || expr->comp_type_ == ComparisonType::NotEqual) {
+      continue;
+    }
+    auto comp_type = expr->comp_type_;
+    const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(expr->children_[0].get());
+    const auto *constant_expr = dynamic_cast<const ConstantValueExpression *>(expr->children_[1].get());
+    if (column_expr == nullptr && constant_expr == nullptr) {
+      column_expr = dynamic_cast<const ColumnValueExpression *>(expr->children_[1].get());
+      constant_expr = dynamic_cast<const ConstantValueExpression *>(expr->children_[0].get());
+      comp_type = MirrorComparison(comp_type);
+    }
+    if (column_expr == nullptr || constant_expr == nullptr || column_expr->GetTupleIdx() != 0) {
+      continue;
+    }
+    // 常量的类型和列不同时，按列的类型编码的key比较不出正确的结果
+    const auto &value = constant_expr->val_;
+    if (value.IsNull() || value.GetTypeId() != seq_plan.OutputSchema().GetColumn(column_expr->GetColIdx()).GetType()) {
+      continue;
+    }
+
+    auto col_idx = column_expr->GetColIdx();
+    if (ranges.count(col_idx) == 0) {
+      column_order.push_back(col_idx);
+    }
+    auto &range = ranges[col_idx];
+    switch (comp_type) {
+      case ComparisonType::Equal:
+        TightenLower(&range, value, true);
+        TightenUpper(&range, value, true);
+        range.has_equal_ = true;
+        break;
+      case ComparisonType::LessThan:
+      case ComparisonType::LessThanOrEqual:
+        TightenUpper(&range, value, comp_type == ComparisonType::LessThanOrEqual);
+        break;
+      case ComparisonType::GreaterThan:
+      case ComparisonType::GreaterThanOrEqual:
+        TightenLower(&range, value, comp_type == ComparisonType::GreaterThanOrEqual);
+        break;
+      default:
+        break;
+    }
+  }
+
+  // 有等值条件的列优先，其次按谓词里出现的顺序找第一个有索引的列
+  std::stable_partition(column_order.begin(), column_order.end(),
+                        [&](uint32_t col_idx) { return ranges[col_idx].has_equal_; });
+  for (auto col_idx : column_order) {
+    auto index = MatchIndex(seq_plan.table_name_, col_idx);
+    if (index == std::nullopt) {
+      continue;
+    }
+    auto [index_oid, index_name] = *index;
+    const auto &range = ranges[col_idx];
+    auto index_plan = std::make_shared<IndexScanPlanNode>(seq_plan.output_schema_, index_oid);
+    index_plan->table_name_ = seq_plan.table_name_;
+    index_plan->lower_ = range.lower_;
+    index_plan->lower_inclusive_ = range.lower_inclusive_;
+    index_plan->upper_ = range.upper_;
+    index_plan->upper_inclusive_ = range.upper_inclusive_;
+    // 只有一个等值条件时索引的结果就是答案，否则剩下的条件（还有没下界时排在最前面的NULL）要再检查一遍
+    if (conjuncts.size() != 1 || !index_plan->IsPointLookup()) {
+      index_plan->filter_predicate_ = filter_plan.predicate_;
     }
+    return index_plan;
   }
   return optimized_plan;
 }
@@ -12,6 +12,7 @@
 #include "execution/plans/abstract_plan.h"
 #include "execution/plans/filter_plan.h"
 #include "execution/plans/index_scan_plan.h"
+#include "execution/plans/limit_plan.h"
 #include "execution/plans/nested_loop_join_plan.h"
 #include "execution/plans/projection_plan.h"
 #include "execution/plans/seq_scan_plan.h"
@@ -28,6 +29,19 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
   }
   auto optimized_plan = plan->CloneWithChildren(std::move(children));
 
+  // ORDER BY ... LIMIT n：排序已经换成了索引扫描，索引扫描读到n个就可以停下。有过滤条件时读到的不一定都能输出，不能下推
+  if (optimized_plan->GetType() == PlanType::Limit &&
+      optimized_plan->children_[0]->GetType() == PlanType::IndexScan) {
+    const auto &limit_plan = dynamic_cast<const LimitPlanNode &>(*optimized_plan);
+    const auto &index_scan = dynamic_cast<const IndexScanPlanNode &>(*optimized_plan->children_[0]);
+    if (index_scan.filter_predicate_ != nullptr) {
+      return optimized_plan;
+    }
+    auto index_plan = std::make_shared<IndexScanPlanNode>(index_scan);
+    index_plan->limit_ = std::min(index_scan.limit_.value_or(limit_plan.GetLimit()), limit_plan.GetLimit());
+    return optimized_plan->CloneWithChildren({index_plan});
+  }
+
   if (optimized_plan->GetType() == PlanType::Sort) {
     const auto &sort_plan = dynamic_cast<const SortPlanNode &>(*optimized_plan);
     const auto &order_bys = sort_plan.GetOrderBy();
@@ -37,9 +51,9 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
       return optimized_plan;
     }
 
-    // Order type is asc or default
+    // Order type is asc or default, which the index scans forward, or desc, which it scans backward
     const auto &[order_type, expr] = order_bys[0];
-    if (!(order_type == OrderByType::ASC || order_type == OrderByType::DEFAULT)) {
+    if (order_type == OrderByType::INVALID) {
       return optimized_plan;
     }
 
@@ -64,8 +78,13 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
         const auto &columns = index->key_schema_.GetColumns();
         if (columns.size() == 1 &&
             columns[0].GetName() == table_info->schema_.GetColumn(order_by_column_id).GetName()) {
-          // Index matched, return index scan instead
-          return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_);
+          // Index matched, return index scan instead. It has no bounds, so it visits every key in order.
+          auto index_plan = std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_);
+          index_plan->table_name_ = table_info->name_;
+          if (order_type == OrderByType::DESC) {
+            index_plan->direction_ = ScanDirection::BACKWARD;
+          }
+          return index_plan;
         }
       }
     }
@@ -10,33 +10,277 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <climits>
+#include <chrono>  // NOLINT
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
-#include <mutex>  // NOLINT
+#include <numeric>
 #include <string>
+#include <type_traits>
 #include <thread>  // NOLINT
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/macros.h"
+#include "fmt/format.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+namespace {
+
+/**
+ * Some file systems accept O_DIRECT at open time but reject the transfers. Turn it off on the descriptor
+ * @return true if O_DIRECT was on, and the transfer is worth retrying
+ */
+auto ClearDirectIo(int fd) -> bool {
+  const int flags = fcntl(fd, F_GETFL);
+  if (flags < 0 || (flags & O_DIRECT) == 0) {
+    return false;
+  }
+  LOG_WARN("direct I/O rejected by the file system, falling back to buffered I/O");
+  return fcntl(fd, F_SETFL, flags & ~O_DIRECT) == 0;
+}
+
+/**
+ * Sort the pages by id and call fn once for every run of adjacent pages, with one iovec per page
+ */
+template <typename Ptr, typename Fn>
+void ForEachRun(const std::vector<page_id_t> &page_ids, const std::vector<Ptr> &page_data, Fn fn) {
+  std::vector<size_t> order(page_ids.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&page_ids](size_t a, size_t b) { return page_ids[a] < page_ids[b]; });
+  std::vector<iovec> iovs;
+  off_t run_offset = 0;
+  page_id_t prev_page_id = INVALID_PAGE_ID;
+  for (auto i : order) {
+    if (!iovs.empty() && (page_ids[i] != prev_page_id + 1 || iovs.size() == IOV_MAX)) {
+      fn(run_offset, iovs.data(), static_cast<int>(iovs.size()));
+      iovs.clear();
+    }
+    if (iovs.empty()) {
+      run_offset = static_cast<off_t>(page_ids[i]) * BUSTUB_PAGE_SIZE;
+    }
+    iovs.push_back({const_cast<char *>(page_data[i]), BUSTUB_PAGE_SIZE});
+    prev_page_id = page_ids[i];
+  }
+  if (!iovs.empty()) {
+    fn(run_offset, iovs.data(), static_cast<int>(iovs.size()));
+  }
+}
+
+/**
+ * Write the buffers to consecutive pages starting at offset, retrying until everything is written
+ */
+void WriteRun(int fd, off_t offset, iovec *iov, int iovcnt) {
+  while (iovcnt > 0) {
+    ssize_t written = pwritev(fd, iov, iovcnt, offset);
+    // check for I/O error
+    if (written < 0) {
+      if (errno == EINTR || (errno == EINVAL && ClearDirectIo(fd))) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    offset += written;
+    // skip the buffers written completely, and the written part of the next one
+    while (iovcnt > 0 && static_cast<size_t>(written) >= iov->iov_len) {
+      written -= static_cast<ssize_t>(iov->iov_len);
+      iov++;
+      iovcnt--;
+    }
+    if (iovcnt > 0) {
+      iov->iov_base = static_cast<char *>(iov->iov_base) + written;
+      iov->iov_len -= written;
+    }
+  }
+}
+
+/**
+ * Read consecutive pages starting at offset into the buffers. Whatever lies past the end of the file reads as zeros
+ */
+void ReadRun(int fd, off_t offset, iovec *iov, int iovcnt) {
+  while (iovcnt > 0) {
+    ssize_t read_count = preadv(fd, iov, iovcnt, offset);
+    if (read_count < 0) {
+      if (errno == EINTR || (errno == EINVAL && ClearDirectIo(fd))) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while reading");
+      return;
+    }
+    if (read_count == 0) {
+      // if file ends before reading BUSTUB_PAGE_SIZE
+      LOG_DEBUG("Read less than a page");
+      for (int i = 0; i < iovcnt; i++) {
+        memset(iov[i].iov_base, 0, iov[i].iov_len);
+      }
+      return;
+    }
+    offset += read_count;
+    while (iovcnt > 0 && static_cast<size_t>(read_count) >= iov->iov_len) {
+      read_count -= static_cast<ssize_t>(iov->iov_len);
+      iov++;
+      iovcnt--;
+    }
+    if (iovcnt > 0) {
+      iov->iov_base = static_cast<char *>(iov->iov_base) + read_count;
+      iov->iov_len -= read_count;
+    }
+  }
+}
+
+/** O_DIRECT transfers need buffers aligned to the logical block size of the device, a page covers all of them */
+constexpr size_t DIRECT_IO_ALIGNMENT = BUSTUB_PAGE_SIZE;
+
+auto IsAligned(const char *data) -> bool { return reinterpret_cast<uintptr_t>(data) % DIRECT_IO_ALIGNMENT == 0; }
+
+/**
+ * The page buffers of a direct I/O transfer: the aligned buffers of the caller are used in place, the others are
+ * replaced by aligned copies
+ */
+class DirectIoBuffers {
+ public:
+  template <typename Ptr>
+  explicit DirectIoBuffers(const std::vector<Ptr> &page_data) {
+    const auto unaligned = std::count_if(page_data.begin(), page_data.end(), [](auto *data) { return !IsAligned(data); });
+    bounce_ = static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, unaligned * BUSTUB_PAGE_SIZE));
+    char *next = bounce_;
+    for (auto *data : page_data) {
+      if (IsAligned(data)) {
+        buffers_.push_back(const_cast<char *>(data));
+      } else {
+        buffers_.push_back(next);
+        next += BUSTUB_PAGE_SIZE;
+      }
+    }
+  }
+
+  ~DirectIoBuffers() { std::free(bounce_); }
+
+  DISALLOW_COPY_AND_MOVE(DirectIoBuffers);
+
+  auto Get() const -> const std::vector<char *> & { return buffers_; }
+
+  /** Copy the unaligned pages into their copies, before a write */
+  void CopyIn(const std::vector<const char *> &page_data) {
+    for (size_t i = 0; i < page_data.size(); i++) {
+      if (buffers_[i] != page_data[i]) {
+        memcpy(buffers_[i], page_data[i], BUSTUB_PAGE_SIZE);
+      }
+    }
+  }
+
+  /** Copy the copies back into the unaligned pages, after a read */
+  void CopyOut(const std::vector<char *> &page_data) {
+    for (size_t i = 0; i < page_data.size(); i++) {
+      if (buffers_[i] != page_data[i]) {
+        memcpy(page_data[i], buffers_[i], BUSTUB_PAGE_SIZE);
+      }
+    }
+  }
+
+ private:
+  std::vector<char *> buffers_;
+  char *bounce_{nullptr};
+};
+
+/**
+ * Read the pages, or write them if the buffers are const. With direct I/O unaligned buffers go through aligned copies
+ */
+template <typename Ptr>
+void TransferPages(int fd, bool direct_io, const std::vector<page_id_t> &page_ids, const std::vector<Ptr> &page_data) {
+  constexpr bool is_write = std::is_const_v<std::remove_pointer_t<Ptr>>;
+  auto transfer = [fd](off_t offset, iovec *iov, int iovcnt) {
+    if constexpr (is_write) {
+      WriteRun(fd, offset, iov, iovcnt);
+    } else {
+      ReadRun(fd, offset, iov, iovcnt);
+    }
+  };
+  if (!direct_io || std::all_of(page_data.begin(), page_data.end(), IsAligned)) {
+    ForEachRun(page_ids, page_data, transfer);
+    return;
+  }
+  DirectIoBuffers buffers(page_data);
+  if constexpr (is_write) {
+    buffers.CopyIn(page_data);
+  }
+  ForEachRun(page_ids, buffers.Get(), transfer);
+  if constexpr (!is_write) {
+    buffers.CopyOut(page_data);
+  }
+}
+
+/**
+ * Copies of the pages of a write, taken so that the checksums match the bytes that are written. The copies are aligned
+ * for direct I/O, and kept in a buffer of the writing thread that is reused by its later writes.
+ */
+class PageSnapshot {
+ public:
+  explicit PageSnapshot(const std::vector<const char *> &page_data) {
+    char *copies = Reserve(page_data.size());
+    for (size_t i = 0; i < page_data.size(); i++) {
+      char *copy = copies + i * BUSTUB_PAGE_SIZE;
+      memcpy(copy, page_data[i], BUSTUB_PAGE_SIZE);
+      pages_.push_back(copy);
+      checksums_.push_back(PageChecksums::Compute(copy));
+    }
+  }
+
+  DISALLOW_COPY_AND_MOVE(PageSnapshot);
+
+  auto GetPages() const -> const std::vector<const char *> & { return pages_; }
+
+  auto GetChecksums() const -> const std::vector<uint32_t> & { return checksums_; }
+
+ private:
+  /** The copy buffer of the calling thread, grown to hold num_pages pages. */
+  static auto Reserve(size_t num_pages) -> char * {
+    struct Buffer {
+      ~Buffer() { std::free(data_); }
+      char *data_{nullptr};
+      size_t num_pages_{0};
+    };
+    thread_local Buffer buffer;
+    if (buffer.num_pages_ < num_pages) {
+      std::free(buffer.data_);
+      buffer.data_ = static_cast<char *>(std::aligned_alloc(DIRECT_IO_ALIGNMENT, num_pages * BUSTUB_PAGE_SIZE));
+      buffer.num_pages_ = num_pages;
+    }
+    return buffer.data_;
+  }
+
+  std::vector<const char *> pages_;
+  std::vector<uint32_t> checksums_;
+};
+
+}  // namespace
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
+DiskManager::DiskManager(const std::string &db_file, bool direct_io) : file_name_(db_file) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
+  fsm_name_ = file_name_.substr(0, n) + ".fsm";
+  const std::string crc_name = file_name_.substr(0, n) + ".crc";
 
   log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
   // directory or file does not exist
@@ -49,28 +293,74 @@ DiskManager::DiskManager(const std::string &db_file) : file_name_(db_file) {
     }
   }
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out | std::ios::in);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  // page I/O goes through pread/pwrite on a raw descriptor, so that concurrent requests do not share a file cursor
+  if (direct_io) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT | O_DIRECT, 0644);
+    direct_io_ = db_fd_ >= 0;
+    // tmpfs等文件系统不支持O_DIRECT，退回到经过page cache的I/O
+    if (db_fd_ < 0 && errno == EINVAL) {
+      LOG_WARN("%s does not support direct I/O, falling back to buffered I/O", db_file.c_str());
     }
   }
+  if (db_fd_ < 0) {
+    db_fd_ = open(db_file.c_str(), O_RDWR | O_CREAT, 0644);
+  }
+  if (db_fd_ < 0) {
+    throw Exception("can't open db file");
+  }
+  // 空文件说明数据库是新建的，旧的free space map和校验和(如果有)属于已经删除的文件
+  const int file_size = GetFileSize(file_name_);
+  if (file_size > 0) {
+    free_space_map_.Load(fsm_name_);
+    // 文件里已有的page不能再分配出去，即使没有保存过free space map
+    free_space_map_.MarkAllocated((file_size - 1) / BUSTUB_PAGE_SIZE);
+  }
+  // 从现在开始page的分配和删除都追加到保存的free space map后面
+  SaveFreeSpaceMap();
+  if (!page_checksums_.Open(crc_name, file_size <= 0)) {
+    LOG_WARN("can't open %s, page checksums are not saved", crc_name.c_str());
+  }
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() {
+  if (db_fd_ >= 0) {
+    // 表和索引的extent里没用到的page还给free space map，否则重启后再也分配不出去
+    free_space_map_.ReleaseExtents();
+    SaveFreeSpaceMap();
+    // page都落盘之后才能丢掉旧的校验和
+    fdatasync(db_fd_);
+    close(db_fd_);
+  }
+  page_checksums_.Close();
+}
+
+void DiskManager::SaveFreeSpaceMap() {
+  if (!fsm_name_.empty()) {
+    free_space_map_.Save(fsm_name_);
+  }
+}
+
+auto DiskManager::IsDirectIo() const -> bool {
+  if (db_fd_ < 0) {
+    return false;
+  }
+  const int flags = fcntl(db_fd_, F_GETFL);
+  return flags >= 0 && (flags & O_DIRECT) != 0;
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+  if (db_fd_ >= 0) {
+    free_space_map_.ReleaseExtents();
+    SaveFreeSpaceMap();
+    fdatasync(db_fd_);
+    close(db_fd_);
+    db_fd_ = -1;
   }
+  page_checksums_.Close();
   log_io_.close();
 }
 
@@ -78,47 +368,96 @@ void DiskManager::ShutDown() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
-  // set write cursor to offset
+  const auto start = std::chrono::steady_clock::now();
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, BUSTUB_PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
+  WritePagesChecksummed({page_id}, {page_data});
+  write_time_ns_ +=
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * Write the contents of the specified pages into disk file
+ */
+void DiskManager::WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data) {
+  if (page_ids.empty()) {
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  const auto start = std::chrono::steady_clock::now();
+  num_writes_ += page_ids.size();
+  WritePagesChecksummed(page_ids, page_data);
+  write_time_ns_ +=
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * BUSTUB_PAGE_SIZE;
-  // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
-    LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, BUSTUB_PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
-      return;
+  const auto start = std::chrono::steady_clock::now();
+  num_reads_ += 1;
+  TransferPages(db_fd_, direct_io_, {page_id}, std::vector<char *>{page_data});
+  read_time_ns_ +=
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  VerifyPages({page_id}, {page_data});
+}
+
+/**
+ * Read the contents of the specified pages into the given memory areas
+ */
+void DiskManager::ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) {
+  if (page_ids.empty()) {
+    return;
+  }
+  const auto start = std::chrono::steady_clock::now();
+  num_reads_ += page_ids.size();
+  TransferPages(db_fd_, direct_io_, page_ids, page_data);
+  read_time_ns_ +=
+      std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+  VerifyPages(page_ids, page_data);
+}
+
+void DiskManager::WritePagesChecksummed(const std::vector<page_id_t> &page_ids,
+                                        const std::vector<const char *> &page_data) {
+  // 删除后又分配出去的page先在free space map里记下来，否则崩溃后它又被当成空闲的page分配一次
+  free_space_map_.SyncChanges();
+  // 崩溃后还没读过的page不知道磁盘上是两个版本中的哪一个，先读出来，否则再写一次就有三个版本
+  if (const auto unresolved = page_checksums_.GetUnresolved(page_ids); !unresolved.empty()) {
+    std::vector<char> buffer(unresolved.size() * BUSTUB_PAGE_SIZE);
+    std::vector<char *> pages;
+    for (size_t i = 0; i < unresolved.size(); i++) {
+      pages.push_back(buffer.data() + i * BUSTUB_PAGE_SIZE);
     }
-    // if file ends before reading BUSTUB_PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < BUSTUB_PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, BUSTUB_PAGE_SIZE - read_count);
+    TransferPages(db_fd_, direct_io_, unresolved, pages);
+    for (size_t i = 0; i < unresolved.size(); i++) {
+      page_checksums_.Resolve(unresolved[i], PageChecksums::Compute(pages[i]));
+    }
+  }
+  // 校验和先于page落盘，崩溃后磁盘上的page不管是旧的还是新的，都能对上记下的两个校验和之一
+  if (!page_checksums) {
+    // 旧的校验和已经不对应磁盘上的内容了
+    page_checksums_.BeginWrite(page_ids, std::vector<uint32_t>(page_ids.size(), 0), db_fd_);
+    TransferPages(db_fd_, direct_io_, page_ids, page_data);
+    page_checksums_.EndWrite(page_ids);
+    return;
+  }
+  PageSnapshot snapshot(page_data);
+  page_checksums_.BeginWrite(page_ids, snapshot.GetChecksums(), db_fd_);
+  TransferPages(db_fd_, direct_io_, page_ids, snapshot.GetPages());
+  page_checksums_.EndWrite(page_ids);
+}
+
+void DiskManager::VerifyPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) {
+  if (!page_checksums) {
+    return;
+  }
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    const uint32_t actual = PageChecksums::Compute(page_data[i]);
+    if (!page_checksums_.Matches(page_ids[i], actual)) {
+      throw Exception(ExceptionType::CORRUPTION,
+                      fmt::format("page {} of {} is corrupted: checksum {:08x}, expected {:08x}", page_ids[i],
+                                  file_name_, actual, page_checksums_.Get(page_ids[i])));
     }
+    page_checksums_.Resolve(page_ids[i], actual);
   }
 }
 
@@ -39,12 +39,31 @@ void DiskManagerMemory::WritePage(page_id_t page_id, const char *page_data) {
   memcpy(memory_ + offset, page_data, BUSTUB_PAGE_SIZE);
 }
 
+/**
+ * Write the contents of the specified pages into disk file
+ */
+void DiskManagerMemory::WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data) {
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    WritePage(page_ids[i], page_data[i]);
+  }
+}
+
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManagerMemory::ReadPage(page_id_t page_id, char *page_data) {
+  num_reads_ += 1;
   int64_t offset = static_cast<int64_t>(page_id) * BUSTUB_PAGE_SIZE;
   memcpy(page_data, memory_ + offset, BUSTUB_PAGE_SIZE);
 }
 
+/**
+ * Read the contents of the specified pages into the given memory areas
+ */
+void DiskManagerMemory::ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) {
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    ReadPage(page_ids[i], page_data[i]);
+  }
+}
+
 }  // namespace bustub
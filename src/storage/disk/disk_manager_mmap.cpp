@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_mmap.cpp
+//
+// Identification: src/storage/disk/disk_manager_mmap.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_mmap.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <mutex>  // NOLINT
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+DiskManagerMmap::DiskManagerMmap(const std::string &db_file) {
+  file_name_ = db_file;
+  int fd = open(db_file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw Exception("can't open db file");
+  }
+  struct stat stat_buf;
+  if (fstat(fd, &stat_buf) != 0) {
+    close(fd);
+    throw Exception("can't stat db file");
+  }
+  mapping_length_ = static_cast<size_t>(stat_buf.st_size);
+  if (mapping_length_ > 0) {
+    void *mapping = mmap(nullptr, mapping_length_, PROT_READ, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+      close(fd);
+      throw Exception("can't map db file");
+    }
+    mapping_ = static_cast<char *>(mapping);
+    // 默认按随机访问处理，点查不会把相邻的page也读进来；顺序扫描由AdviseReadAhead单独预读
+    madvise(mapping_, mapping_length_, MADV_RANDOM);
+  }
+  // 映射建立之后文件描述符就不需要了
+  close(fd);
+  // 沿用主库的page分配情况，新page不会与文件里已有的page重叠；副本自己的分配不写回
+  if (auto n = db_file.rfind('.'); n != std::string::npos) {
+    free_space_map_.Load(db_file.substr(0, n) + ".fsm");
+    page_checksums_.Open(db_file.substr(0, n) + ".crc", false, true);
+  }
+  if (mapping_length_ > 0) {
+    free_space_map_.MarkAllocated(static_cast<page_id_t>(GetMappedPages()) - 1);
+  }
+}
+
+DiskManagerMmap::~DiskManagerMmap() {
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_length_);
+  }
+}
+
+void DiskManagerMmap::WritePage(page_id_t page_id, const char *page_data) {
+  num_writes_ += 1;
+  std::unique_lock<std::shared_mutex> lock(latch_);
+  auto &page = written_pages_[page_id];
+  if (page == nullptr) {
+    page = std::make_unique<PageData>();
+  }
+  memcpy(page->data(), page_data, BUSTUB_PAGE_SIZE);
+}
+
+void DiskManagerMmap::WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data) {
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    WritePage(page_ids[i], page_data[i]);
+  }
+}
+
+void DiskManagerMmap::ReadPage(page_id_t page_id, char *page_data) {
+  num_reads_ += 1;
+  AdviseReadAhead(page_id);
+  if (CopyPage(page_id, page_data)) {
+    VerifyPages({page_id}, {page_data});
+  }
+}
+
+void DiskManagerMmap::ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) {
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    ReadPage(page_ids[i], page_data[i]);
+  }
+}
+
+auto DiskManagerMmap::CopyPage(page_id_t page_id, char *page_data) -> bool {
+  {
+    std::shared_lock<std::shared_mutex> lock(latch_);
+    if (auto it = written_pages_.find(page_id); it != written_pages_.end()) {
+      memcpy(page_data, it->second->data(), BUSTUB_PAGE_SIZE);
+      return false;
+    }
+  }
+  const size_t offset = static_cast<size_t>(page_id) * BUSTUB_PAGE_SIZE;
+  const size_t length = offset < mapping_length_ ? std::min<size_t>(BUSTUB_PAGE_SIZE, mapping_length_ - offset) : 0;
+  if (length < BUSTUB_PAGE_SIZE) {
+    // if file ends before reading BUSTUB_PAGE_SIZE
+    LOG_DEBUG("Read less than a page");
+    memset(page_data + length, 0, BUSTUB_PAGE_SIZE - length);
+  }
+  if (length > 0) {
+    memcpy(page_data, mapping_ + offset, length);
+  }
+  return true;
+}
+
+void DiskManagerMmap::AdviseReadAhead(page_id_t page_id) {
+  // 连续两次读到相邻的page才认为是顺序扫描；这些状态只是启发式的，并发读之间的竞争无所谓
+  const bool sequential = next_sequential_page_id_.exchange(page_id + 1, std::memory_order_relaxed) == page_id;
+  if (!sequential || mapping_ == nullptr) {
+    return;
+  }
+  const auto mapped_pages = static_cast<page_id_t>(GetMappedPages());
+  // 扫描走到已预读区间的后半段时再预读下一段，让读盘始终走在扫描前面
+  if (page_id + MMAP_READ_AHEAD_PAGES / 2 < read_ahead_end_.load(std::memory_order_relaxed) ||
+      page_id + 1 >= mapped_pages) {
+    return;
+  }
+  const page_id_t begin = page_id + 1;
+  const page_id_t end = std::min(begin + MMAP_READ_AHEAD_PAGES, mapped_pages);
+  read_ahead_end_.store(end, std::memory_order_relaxed);
+  const size_t offset = static_cast<size_t>(begin) * BUSTUB_PAGE_SIZE;
+  madvise(mapping_ + offset, std::min(static_cast<size_t>(end - begin) * BUSTUB_PAGE_SIZE, mapping_length_ - offset),
+          MADV_WILLNEED);
+}
+
+}  // namespace bustub
@@ -0,0 +1,136 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.cpp
+//
+// Identification: src/storage/disk/disk_scheduler.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_scheduler.h"
+
+#include <algorithm>
+#include <exception>
+#include <numeric>
+#include <utility>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+DiskScheduler::DiskScheduler(DiskManager *disk_manager, size_t num_workers)
+    : disk_manager_(disk_manager), num_workers_(std::max<size_t>(num_workers, 1)) {}
+
+DiskScheduler::~DiskScheduler() {
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    shutdown_ = true;
+  }
+  cv_.notify_all();
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+auto DiskScheduler::Schedule(DiskRequest request) -> std::future<void> {
+  BUSTUB_ASSERT(request.page_ids_.size() == request.data_.size(), "every page needs a buffer");
+  auto future = request.callback_.get_future();
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    if (workers_.empty()) {
+      for (size_t i = 0; i < num_workers_; i++) {
+        workers_.emplace_back([this] { WorkerLoop(); });
+      }
+    }
+    request_queue_.push_back(std::move(request));
+  }
+  cv_.notify_one();
+  return future;
+}
+
+void DiskScheduler::ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) {
+  ScheduleRuns(false, page_ids, page_data);
+}
+
+void DiskScheduler::WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data) {
+  // 写请求不会修改缓冲区，DiskRequest统一用char *保存
+  std::vector<char *> data;
+  data.reserve(page_data.size());
+  for (const auto *page : page_data) {
+    data.push_back(const_cast<char *>(page));
+  }
+  ScheduleRuns(true, page_ids, data);
+}
+
+void DiskScheduler::ScheduleRuns(bool is_write, const std::vector<page_id_t> &page_ids,
+                                 const std::vector<char *> &page_data) {
+  std::vector<size_t> order(page_ids.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&page_ids](size_t a, size_t b) { return page_ids[a] < page_ids[b]; });
+
+  // 相邻的page合成一个请求，由一次preadv/pwritev完成；不相邻的请求同时交给多个worker
+  // 开着校验和时整批写交给一个请求：disk manager为整批只sync一次校验和文件，每段相邻的page仍然各用一次pwritev
+  const bool split = !is_write || !page_checksums;
+  std::vector<std::future<void>> futures;
+  DiskRequest request{is_write, {}, {}, {}};
+  for (auto i : order) {
+    if (split && !request.page_ids_.empty() && page_ids[i] != request.page_ids_.back() + 1) {
+      futures.push_back(Schedule(std::move(request)));
+      request = DiskRequest{is_write, {}, {}, {}};
+    }
+    request.page_ids_.push_back(page_ids[i]);
+    request.data_.push_back(page_data[i]);
+  }
+  if (!request.page_ids_.empty()) {
+    futures.push_back(Schedule(std::move(request)));
+  }
+  // 先等全部请求完成再抛出异常，否则worker还在往调用者的缓冲区里写
+  std::exception_ptr error;
+  for (auto &future : futures) {
+    try {
+      future.get();
+    } catch (...) {
+      error = std::current_exception();
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void DiskScheduler::WorkerLoop() {
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    cv_.wait(lock, [this] { return shutdown_ || !request_queue_.empty(); });
+    // 退出前把队列里剩下的请求做完，不让等待者永远挂起
+    if (request_queue_.empty()) {
+      return;
+    }
+    DiskRequest request = std::move(request_queue_.front());
+    request_queue_.pop_front();
+    lock.unlock();
+    try {
+      if (request.page_ids_.size() == 1) {
+        if (request.is_write_) {
+          disk_manager_->WritePage(request.page_ids_[0], request.data_[0]);
+        } else {
+          disk_manager_->ReadPage(request.page_ids_[0], request.data_[0]);
+        }
+      } else if (request.is_write_) {
+        std::vector<const char *> data(request.data_.begin(), request.data_.end());
+        disk_manager_->WritePages(request.page_ids_, data);
+      } else {
+        disk_manager_->ReadPages(request.page_ids_, request.data_);
+      }
+      request.callback_.set_value();
+    } catch (...) {
+      request.callback_.set_exception(std::current_exception());
+    }
+    lock.lock();
+  }
+}
+
+}  // namespace bustub
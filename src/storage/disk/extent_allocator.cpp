@@ -0,0 +1,38 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extent_allocator.cpp
+//
+// Identification: src/storage/disk/extent_allocator.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/extent_allocator.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+ExtentAllocator::ExtentAllocator(size_t max_extent_size)
+    : max_extent_size_(static_cast<page_id_t>(std::max(max_extent_size, static_cast<size_t>(1)))) {}
+
+auto ExtentAllocator::Allocate(FreeSpaceMap *free_space_map) -> page_id_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  page_id_t page_id = extent_ == nullptr ? INVALID_PAGE_ID : free_space_map->AllocateFromExtent(extent_.get());
+  if (page_id == INVALID_PAGE_ID) {
+    // 当前extent用完了(或者关闭数据库时被收回了)，申请一个新的，大小翻倍直到上限
+    extent_ = free_space_map->AllocateExtent(std::min(next_extent_size_, max_extent_size_));
+    next_extent_size_ = std::min(next_extent_size_ * 2, max_extent_size_);
+    extent_count_++;
+    page_id = free_space_map->AllocateFromExtent(extent_.get());
+  }
+  return page_id;
+}
+
+auto ExtentAllocator::GetExtentCount() const -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return extent_count_;
+}
+
+}  // namespace bustub
@@ -0,0 +1,269 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// free_space_map.cpp
+//
+// Identification: src/storage/disk/free_space_map.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/free_space_map.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "common/logger.h"
+
+namespace bustub {
+
+namespace {
+
+/** Write all the words to the file, retrying short writes. */
+auto WriteAll(int fd, const std::vector<int32_t> &words) -> bool {
+  const auto *data = reinterpret_cast<const char *>(words.data());
+  size_t remaining = words.size() * sizeof(int32_t);
+  while (remaining > 0) {
+    ssize_t written = write(fd, data, remaining);
+    if (written < 0) {
+      return false;
+    }
+    data += written;
+    remaining -= written;
+  }
+  return true;
+}
+
+}  // namespace
+
+FreeSpaceMap::~FreeSpaceMap() {
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+}
+
+auto FreeSpaceMap::Allocate(page_id_t stride, page_id_t residue) -> page_id_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  // 只有一个实例时第一个就满足；多个实例时空闲page大致均匀分布在各个余数上，平均查看stride个
+  auto it = std::find_if(free_pages_.begin(), free_pages_.end(),
+                         [stride, residue](page_id_t page_id) { return page_id % stride == residue; });
+  if (it != free_pages_.end()) {
+    const page_id_t page_id = *it;
+    free_pages_.erase(it);
+    if (keep_changes_) {
+      changes_.push_back(page_id);
+      reused_count_++;
+    }
+    return page_id;
+  }
+  // 没有可复用的page，从高水位开始找第一个同余的id，跳过的id留给其他实例
+  const page_id_t page_id = next_page_id_ + (residue - next_page_id_ % stride + stride) % stride;
+  for (page_id_t skipped = next_page_id_; skipped < page_id; skipped++) {
+    free_pages_.insert(skipped);
+  }
+  next_page_id_ = page_id + 1;
+  return page_id;
+}
+
+auto FreeSpaceMap::AllocateExtent(page_id_t size) -> std::shared_ptr<Extent> {
+  std::scoped_lock<std::mutex> lock(latch_);
+  // 找第一段足够长的连续空闲page；找不到时记下紧挨着高水位的那段空闲page
+  page_id_t run_start = INVALID_PAGE_ID;
+  page_id_t run_end = INVALID_PAGE_ID;
+  for (auto page_id : free_pages_) {
+    if (page_id != run_end) {
+      run_start = page_id;
+    }
+    run_end = page_id + 1;
+    if (run_end - run_start == size) {
+      break;
+    }
+  }
+  page_id_t start = next_page_id_;
+  if (run_start != INVALID_PAGE_ID && (run_end - run_start == size || run_end == next_page_id_)) {
+    start = run_start;
+  }
+  const auto first = free_pages_.lower_bound(start);
+  const auto last = free_pages_.lower_bound(start + size);
+  if (keep_changes_) {
+    for (auto it = first; it != last; ++it) {
+      changes_.push_back(*it);
+      reused_count_++;
+    }
+  }
+  free_pages_.erase(first, last);
+  next_page_id_ = std::max(next_page_id_, start + size);
+  // 顺便丢掉已经用完的extent
+  extents_.erase(std::remove_if(extents_.begin(), extents_.end(),
+                                [](const auto &extent) { return extent->next_page_id_ == extent->end_page_id_; }),
+                 extents_.end());
+  return extents_.emplace_back(std::make_shared<Extent>(Extent{start, start + size}));
+}
+
+auto FreeSpaceMap::AllocateFromExtent(Extent *extent) -> page_id_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return extent->next_page_id_ == extent->end_page_id_ ? INVALID_PAGE_ID : extent->next_page_id_++;
+}
+
+void FreeSpaceMap::ReleaseExtents() {
+  std::scoped_lock<std::mutex> lock(latch_);
+  for (auto &extent : extents_) {
+    for (page_id_t page_id = extent->next_page_id_; page_id < extent->end_page_id_; page_id++) {
+      free_pages_.insert(page_id);
+      if (keep_changes_) {
+        changes_.push_back(~page_id);
+      }
+    }
+    extent->next_page_id_ = extent->end_page_id_;
+  }
+  extents_.clear();
+}
+
+void FreeSpaceMap::MarkAllocated(page_id_t page_id) {
+  std::scoped_lock<std::mutex> lock(latch_);
+  next_page_id_ = std::max(next_page_id_, page_id + 1);
+}
+
+auto FreeSpaceMap::Deallocate(page_id_t page_id) -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  if (page_id < 0 || page_id >= next_page_id_ || !free_pages_.insert(page_id).second) {
+    return false;
+  }
+  // 删除不用马上sync：丢了只是崩溃后少回收一个page
+  if (keep_changes_) {
+    changes_.push_back(~page_id);
+  }
+  return true;
+}
+
+auto FreeSpaceMap::IsFree(page_id_t page_id) const -> bool {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return free_pages_.count(page_id) > 0;
+}
+
+auto FreeSpaceMap::GetNextPageId() const -> page_id_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return next_page_id_;
+}
+
+auto FreeSpaceMap::GetFreePageCount() const -> size_t {
+  std::scoped_lock<std::mutex> lock(latch_);
+  return free_pages_.size();
+}
+
+/*
+ * Format (size in byte):
+ *  -----------------------------------------------------------------------------------
+ * | Magic (4) | NextPageId (4) | FreeCount (4) | FreePageId_1 (4) | ... | FreePageId_n (4) |
+ *  -----------------------------------------------------------------------------------
+ * followed by the changes since, 4 bytes each: the id of a page handed out again, or ~page_id for a deleted page.
+ */
+auto FreeSpaceMap::Save(const std::string &file_name) -> bool {
+  // 整个保存期间不追加改动：快照之后的改动留在changes_里，换成新文件之后再追加到新文件
+  std::scoped_lock<std::mutex> file_lock(file_latch_);
+  std::vector<int32_t> buffer;
+  size_t saved_changes;
+  uint64_t reused_count;
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    buffer.reserve(3 + free_pages_.size());
+    buffer.push_back(static_cast<int32_t>(MAGIC));
+    buffer.push_back(next_page_id_);
+    buffer.push_back(static_cast<int32_t>(free_pages_.size()));
+    buffer.insert(buffer.end(), free_pages_.begin(), free_pages_.end());
+    keep_changes_ = true;
+    saved_changes = changes_.size();
+    reused_count = reused_count_;
+  }
+
+  const std::string tmp_name = file_name + ".tmp";
+  int fd = open(tmp_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    LOG_DEBUG("can't write free space map");
+    return false;
+  }
+  if (!WriteAll(fd, buffer) || fsync(fd) < 0 || std::rename(tmp_name.c_str(), file_name.c_str()) != 0) {
+    close(fd);
+    LOG_DEBUG("I/O error while writing free space map");
+    return false;
+  }
+  if (fd_ >= 0) {
+    close(fd_);
+  }
+  fd_ = fd;
+  {
+    // 快照里已经包含的改动不用再追加
+    std::scoped_lock<std::mutex> lock(latch_);
+    changes_.erase(changes_.begin(), changes_.begin() + saved_changes);
+  }
+  synced_count_ = std::max(synced_count_.load(), reused_count);
+  return true;
+}
+
+void FreeSpaceMap::SyncChanges() {
+  const uint64_t reused_count = reused_count_;
+  if (synced_count_ >= reused_count) {
+    return;
+  }
+  // 并发的调用共用一次sync，sync开始前追加的改动都被它覆盖
+  std::scoped_lock<std::mutex> file_lock(file_latch_);
+  if (synced_count_ >= reused_count) {
+    return;
+  }
+  std::vector<int32_t> changes;
+  uint64_t count;
+  {
+    std::scoped_lock<std::mutex> lock(latch_);
+    changes.swap(changes_);
+    count = reused_count_;
+  }
+  if (fd_ >= 0 && (!WriteAll(fd_, changes) || fdatasync(fd_) < 0)) {
+    LOG_DEBUG("I/O error while writing free space map changes");
+  }
+  synced_count_ = count;
+}
+
+auto FreeSpaceMap::Load(const std::string &file_name) -> bool {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+  std::vector<int32_t> buffer;
+  int32_t chunk[1024];
+  ssize_t read_count;
+  while ((read_count = read(fd, chunk, sizeof(chunk))) > 0) {
+    buffer.insert(buffer.end(), chunk, chunk + read_count / sizeof(int32_t));
+  }
+  close(fd);
+  if (read_count < 0 || buffer.size() < 3 || static_cast<uint32_t>(buffer[0]) != MAGIC || buffer[2] < 0 ||
+      buffer.size() < 3 + static_cast<size_t>(buffer[2])) {
+    LOG_DEBUG("not a free space map");
+    return false;
+  }
+
+  std::scoped_lock<std::mutex> lock(latch_);
+  next_page_id_ = buffer[1];
+  free_pages_.clear();
+  const auto changes = buffer.begin() + 3 + buffer[2];
+  for (auto it = buffer.begin() + 3; it != changes; ++it) {
+    if (*it >= 0 && *it < next_page_id_) {
+      free_pages_.insert(*it);
+    }
+  }
+  // 保存之后的改动按顺序重放；崩溃时写了一半的最后一条在读的时候已经丢掉了
+  for (auto it = changes; it != buffer.end(); ++it) {
+    const page_id_t page_id = *it >= 0 ? *it : ~*it;
+    next_page_id_ = std::max(next_page_id_, page_id + 1);
+    if (*it >= 0) {
+      free_pages_.erase(page_id);
+    } else {
+      free_pages_.insert(page_id);
+    }
+  }
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,260 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_checksums.cpp
+//
+// Identification: src/storage/disk/page_checksums.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/page_checksums.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <mutex>  // NOLINT
+#include <utility>
+
+#include "common/logger.h"
+#include "common/util/crc32c_util.h"
+
+namespace bustub {
+
+namespace {
+
+/** Checksum of a page of zeros, which is what a page reads as before its first write. */
+auto ZeroPageChecksum() -> uint32_t {
+  static const uint32_t checksum = PageChecksums::Compute(std::vector<char>(BUSTUB_PAGE_SIZE).data());
+  return checksum;
+}
+
+}  // namespace
+
+PageChecksums::~PageChecksums() { Close(); }
+
+auto PageChecksums::Open(const std::string &file_name, bool truncate, bool read_only) -> bool {
+  const int flags = read_only ? O_RDONLY : (O_RDWR | O_CREAT | (truncate ? O_TRUNC : 0));
+  int fd = open(file_name.c_str(), flags, 0644);
+  if (fd < 0) {
+    return false;
+  }
+  std::vector<Entry> entries;
+  if (!truncate) {
+    Entry chunk[512];
+    ssize_t read_count;
+    while ((read_count = read(fd, chunk, sizeof(chunk))) > 0) {
+      entries.insert(entries.end(), chunk, chunk + read_count / sizeof(Entry));
+    }
+  }
+
+  std::unique_lock<std::shared_mutex> lock(latch_);
+  entries_ = std::move(entries);
+  writing_.assign(entries_.size(), false);
+  // 两个校验和不同说明上次没有正常关闭时page正在写，磁盘上是哪个版本要等读出来才知道
+  unresolved_.resize(entries_.size());
+  for (size_t i = 0; i < entries_.size(); i++) {
+    unresolved_[i] = entries_[i].current_ != entries_[i].durable_;
+  }
+  written_.clear();
+  if (read_only) {
+    close(fd);
+  } else {
+    fd_ = fd;
+  }
+  return true;
+}
+
+void PageChecksums::Close() {
+  std::unique_lock<std::shared_mutex> lock(latch_);
+  if (fd_ < 0) {
+    return;
+  }
+  // 数据库文件已经sync过，写过的page只剩最后一次写的版本；崩溃后还没确定的page仍然两个都保留
+  for (auto page_id : written_) {
+    if (!writing_[page_id]) {
+      entries_[page_id].durable_ = entries_[page_id].current_;
+    }
+  }
+  written_.clear();
+  if (pwrite(fd_, entries_.data(), entries_.size() * sizeof(Entry), 0) < 0 || fdatasync(fd_) < 0) {
+    LOG_DEBUG("I/O error while saving page checksums");
+  }
+  close(fd_);
+  fd_ = -1;
+}
+
+auto PageChecksums::Compute(const char *page_data) -> uint32_t {
+  const uint32_t crc = Crc32cUtil::Crc32c(page_data, BUSTUB_PAGE_SIZE);
+  // 0表示没有校验和，真算出0的page记成1
+  return crc == 0 ? 1 : crc;
+}
+
+auto PageChecksums::Get(page_id_t page_id) const -> uint32_t {
+  std::shared_lock<std::shared_mutex> lock(latch_);
+  return static_cast<size_t>(page_id) < entries_.size() ? entries_[page_id].current_ : 0;
+}
+
+auto PageChecksums::Matches(page_id_t page_id, uint32_t checksum) const -> bool {
+  std::shared_lock<std::shared_mutex> lock(latch_);
+  if (static_cast<size_t>(page_id) >= entries_.size()) {
+    return true;
+  }
+  const Entry &entry = entries_[page_id];
+  if (entry.current_ == 0 || checksum == entry.current_ || checksum == entry.durable_) {
+    return true;
+  }
+  // 第一次写落盘之前page还是全0，写了一半的page两个都对不上
+  return entry.durable_ == 0 && checksum == ZeroPageChecksum();
+}
+
+auto PageChecksums::GetUnresolved(const std::vector<page_id_t> &page_ids) const -> std::vector<page_id_t> {
+  std::shared_lock<std::shared_mutex> lock(latch_);
+  std::vector<page_id_t> unresolved;
+  for (auto page_id : page_ids) {
+    if (static_cast<size_t>(page_id) < unresolved_.size() && unresolved_[page_id]) {
+      unresolved.push_back(page_id);
+    }
+  }
+  return unresolved;
+}
+
+void PageChecksums::Resolve(page_id_t page_id, uint32_t checksum) {
+  std::unique_lock<std::shared_mutex> lock(latch_);
+  if (static_cast<size_t>(page_id) >= unresolved_.size() || !unresolved_[page_id]) {
+    return;
+  }
+  Entry &entry = entries_[page_id];
+  // 两个都对不上的，要么是关掉校验和时写的内容，要么是正要被覆盖的坏page，以磁盘上的为准
+  const uint32_t on_disk = checksum == entry.durable_ || entry.current_ != 0 ? checksum : 0;
+  entry = Entry{on_disk, on_disk};
+  unresolved_[page_id] = false;
+}
+
+void PageChecksums::BeginWrite(const std::vector<page_id_t> &page_ids, const std::vector<uint32_t> &checksums,
+                               int data_fd) {
+  uint64_t seq;
+  {
+    std::unique_lock<std::shared_mutex> lock(latch_);
+    if (!page_ids.empty()) {
+      const auto max_page_id = static_cast<size_t>(*std::max_element(page_ids.begin(), page_ids.end()));
+      if (max_page_id >= entries_.size()) {
+        entries_.resize(max_page_id + 1, Entry{0, 0});
+        writing_.resize(max_page_id + 1, false);
+        unresolved_.resize(max_page_id + 1, false);
+      }
+    }
+    // 上次sync数据库文件之后写过的page再写成别的内容，崩溃后磁盘上可能是三个版本中的任何一个，先让写过的版本落盘
+    auto has_unsynced_write = [&] {
+      for (size_t i = 0; i < page_ids.size(); i++) {
+        const Entry &entry = entries_[page_ids[i]];
+        if (entry.current_ != entry.durable_ && checksums[i] != entry.current_) {
+          return true;
+        }
+      }
+      return false;
+    };
+    while (has_unsynced_write()) {
+      lock.unlock();
+      SyncData(data_fd);
+      lock.lock();
+    }
+    bool changed = false;
+    for (size_t i = 0; i < page_ids.size(); i++) {
+      Entry &entry = entries_[page_ids[i]];
+      BUSTUB_ASSERT(!unresolved_[page_ids[i]], "the version on disk must be resolved before the page is written");
+      writing_[page_ids[i]] = true;
+      if (checksums[i] == entry.current_) {
+        continue;
+      }
+      if (entry.current_ == entry.durable_) {
+        written_.push_back(page_ids[i]);
+      }
+      entry.current_ = checksums[i];
+      changed = true;
+    }
+    // 校验和都没变(比如关掉校验和之后再写)时，文件里的内容已经对得上，不用写也不用sync
+    if (fd_ < 0 || !changed) {
+      return;
+    }
+    SaveEntries(page_ids);
+    seq = ++written_seq_;
+  }
+
+  // 校验和必须先于page落盘；并发的写共用一次sync，sync开始前写出的校验和都被它覆盖
+  std::scoped_lock<std::mutex> sync_lock(sync_latch_);
+  if (synced_seq_ >= seq) {
+    return;
+  }
+  int fd;
+  {
+    std::shared_lock<std::shared_mutex> lock(latch_);
+    fd = fd_;
+    seq = written_seq_;
+  }
+  if (fd >= 0 && fdatasync(fd) < 0) {
+    LOG_DEBUG("I/O error while syncing page checksums");
+  }
+  synced_seq_ = seq;
+}
+
+void PageChecksums::EndWrite(const std::vector<page_id_t> &page_ids) {
+  // page写完不代表已经落盘，上次sync时的校验和留到下一次SyncData()或者Close()
+  std::unique_lock<std::shared_mutex> lock(latch_);
+  for (auto page_id : page_ids) {
+    writing_[page_id] = false;
+  }
+}
+
+void PageChecksums::SyncData(int data_fd) {
+  std::scoped_lock<std::mutex> data_sync_lock(data_sync_latch_);
+  // 只有sync开始前已经写完的page才算落盘，正在写的留给下一次
+  std::vector<std::pair<page_id_t, uint32_t>> synced;
+  {
+    std::shared_lock<std::shared_mutex> lock(latch_);
+    for (auto page_id : written_) {
+      const Entry &entry = entries_[page_id];
+      if (!writing_[page_id] && entry.current_ != entry.durable_) {
+        synced.emplace_back(page_id, entry.current_);
+      }
+    }
+  }
+  // 等锁的时候别的线程已经sync过了
+  if (synced.empty()) {
+    return;
+  }
+  if (data_fd >= 0 && fdatasync(data_fd) < 0) {
+    LOG_DEBUG("I/O error while syncing the database file");
+  }
+  std::unique_lock<std::shared_mutex> lock(latch_);
+  for (const auto &[page_id, checksum] : synced) {
+    if (entries_[page_id].current_ == checksum) {
+      entries_[page_id].durable_ = checksum;
+    }
+  }
+  written_.erase(std::remove_if(written_.begin(), written_.end(),
+                                [this](page_id_t page_id) {
+                                  return entries_[page_id].current_ == entries_[page_id].durable_;
+                                }),
+                 written_.end());
+}
+
+void PageChecksums::SaveEntries(const std::vector<page_id_t> &page_ids) {
+  std::vector<page_id_t> sorted(page_ids);
+  std::sort(sorted.begin(), sorted.end());
+  // 相邻page的校验和在文件里也相邻，一次写出
+  for (size_t first = 0, last = 0; first < sorted.size(); first = last) {
+    last = first + 1;
+    while (last < sorted.size() && sorted[last] <= sorted[last - 1] + 1) {
+      last++;
+    }
+    const page_id_t first_page_id = sorted[first];
+    const size_t count = sorted[last - 1] - first_page_id + 1;
+    if (pwrite(fd_, entries_.data() + first_page_id, count * sizeof(Entry),
+               static_cast<off_t>(first_page_id) * sizeof(Entry)) < 0) {
+      LOG_DEBUG("I/O error while writing page checksums");
+    }
+  }
+}
+
+}  // namespace bustub
@@ -1,4 +1,6 @@
+#include <algorithm>
 #include <string>
+#include <thread>  // NOLINT
 
 #include "common/exception.h"
 #include "common/logger.h"
@@ -124,28 +126,7 @@ auto BPLUSTREE_TYPE::GetLeafPage(const KeyType &key, Operation op, Transaction *
     }
 
     auto internal_page = static_cast<InternalPage *>(tree_page);
-    if (comparator_(internal_page->KeyAt(internal_page->GetSize() - 1), key) <= 0) {
-      next_page_id = internal_page->ValueAt(internal_page->GetSize() - 1);
-    } else {
-      int i = 1;
-      int j = internal_page->GetSize() - 1;
-      int mid;
-      while (i < j) {
-        mid = i + (j - i) / 2;
-        if (comparator_(internal_page->KeyAt(mid), key) < 0) {
-          i = mid + 1;
-        } else if (comparator_(internal_page->KeyAt(mid), key) > 0) {
-          j = mid;
-        } else {
-          next_page_id = internal_page->ValueAt(mid);
-          i = j + 1;
-          break;
-        }
-      }
-      if (i == j) {
-        next_page_id = internal_page->ValueAt(j - 1);
-      }
-    }
+    next_page_id = LookupChild(internal_page, key, internal_page->GetSize());
 
     //    auto internal_page = static_cast<InternalPage *>(tree_page);
     //    next_page_id = internal_page->ValueAt(internal_page->GetSize() - 1);
@@ -159,6 +140,23 @@ auto BPLUSTREE_TYPE::GetLeafPage(const KeyType &key, Operation op, Transaction *
   }
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::LookupChild(const InternalPage *internal_page, const KeyType &key, int size) const
+    -> page_id_t {
+  return internal_page->ValueAt(internal_page->ChildIndex(key, comparator_, size));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::LookupLeaf(const LeafPage *leaf_page, const KeyType &key, int size, ValueType *value) const
+    -> bool {
+  int index = leaf_page->LowerBound(key, comparator_, size);
+  if (index >= size || comparator_(leaf_page->KeyAt(index), key) != 0) {
+    return false;
+  }
+  *value = leaf_page->ValueAt(index);
+  return true;
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetPage(page_id_t page_id, Transaction *transaction, bool *need_unpin) -> Page * {
   assert(transaction != nullptr);
@@ -190,42 +188,81 @@ auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return root_page_id_ == INVALID_P
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) -> bool {
   // std::cout << "get: " << key << std::endl;
+  if (optimistic_index_reads) {
+    for (int attempt = 0; attempt < OPTIMISTIC_READ_ATTEMPTS; attempt++) {
+      bool found;
+      if (TryGetValueOptimistic(key, result, &found)) {
+        return found;
+      }
+    }
+    optimistic_fallbacks_++;
+  }
+
   root_latch_.RLock();
   if (IsEmpty()) {
     root_latch_.RUnlock();
     return false;
   }
-  bool found = false;
+  // GetLeafPage返回时叶子已经pin住并加了读锁，交给guard释放
   Page *page = GetLeafPage(key, Operation::Read, transaction);
-  auto leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  ReadPageGuard guard(buffer_pool_manager_, page, std::adopt_lock);
+  auto leaf_page = guard.As<LeafPage>();
 
-  int i = 0;
-  int j = leaf_page->GetSize() - 1;
-  while (i <= j) {
-    int mid = i + (j - i) / 2;
-    auto flag_com = comparator_(leaf_page->KeyAt(mid), key);
-    if (flag_com == 0) {
-      result->emplace_back(leaf_page->ValueAt(mid));
-      found = true;
-      break;
+  ValueType value;
+  bool found = LookupLeaf(leaf_page, key, leaf_page->GetSize(), &value);
+  if (found) {
+    result->emplace_back(value);
+  }
+  return found;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::TryGetValueOptimistic(const KeyType &key, std::vector<ValueType> *result, bool *found)
+    -> bool {
+  root_latch_.RLock();
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    *found = false;
+    return true;
+  }
+  // 持有root_latch_时记下根节点的版本号，之后根节点的分裂会改变这个版本号
+  auto guard = buffer_pool_manager_->FetchPageOptimistic(root_page_id_);
+  root_latch_.RUnlock();
+  if (!guard.IsValid()) {
+    return false;
+  }
+
+  while (true) {
+    auto tree_page = guard.As<BPlusTreePage>();
+    // 未校验的数据可能是写了一半的，size要先限制在页内再用
+    if (tree_page->IsLeafPage()) {
+      auto leaf_page = guard.As<LeafPage>();
+      int size = std::clamp(leaf_page->GetSize(), 0, leaf_max_size_);
+      ValueType value;
+      bool leaf_found = LookupLeaf(leaf_page, key, size, &value);
+      if (!guard.Validate()) {
+        return false;
+      }
+      if (leaf_found) {
+        result->emplace_back(value);
+      }
+      *found = leaf_found;
+      return true;
     }
-    if (flag_com < 0) {
-      i = mid + 1;
-    } else {
-      j = mid - 1;
+    auto internal_page = guard.As<InternalPage>();
+    int size = std::clamp(internal_page->GetSize(), 1, internal_max_size_ + 1);
+    page_id_t child_page_id = LookupChild(internal_page, key, size);
+    // 先确认读到的子节点id是有效的，再去取子节点
+    if (!guard.Validate()) {
+      return false;
     }
+    auto child_guard = buffer_pool_manager_->FetchPageOptimistic(child_page_id);
+    // 取到子节点的版本号之后父节点仍未改变，说明子节点没有在这之间分裂或合并
+    if (!child_guard.IsValid() || !guard.Validate()) {
+      return false;
+    }
+    guard = std::move(child_guard);
   }
-  //  for (int i = 0; i < leaf_page->GetSize(); ++i) {
-  //    // std::cout << leaf_page->KeyAt(i) <<std::endl;
-  //    if (comparator_(leaf_page->KeyAt(i), key) == 0) {
-  //      result->emplace_back(leaf_page->ValueAt(i));
-  //      found = true;
-  //    }
-  //  }
-  page->RUnlatch();
-  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
-
-  return found;
 }
 
 /*****************************************************************************
@@ -248,7 +285,7 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
     root_latch_.RUnlock();
     root_latch_.WLock();
     if (IsEmpty()) {
-      Page *page = buffer_pool_manager_->NewPage(&root_page_id_);
+      Page *page = buffer_pool_manager_->NewPageInExtent(&root_page_id_, &extent_allocator_);
 
       // UpdateRootPageId(1);
       auto leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
@@ -307,13 +344,15 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
   // 插入树中发生分裂
   page_id_t new_leave_page_id;
   // std::cout << "new 1" << std::endl;
-  Page *new_page_t = buffer_pool_manager_->NewPage(&new_leave_page_id);
-  auto *new_leaf_page = reinterpret_cast<LeafPage *>(new_page_t);
+  Page *new_page_t = buffer_pool_manager_->NewPageInExtent(&new_leave_page_id, &extent_allocator_);
+  auto *new_leaf_page = reinterpret_cast<LeafPage *>(new_page_t->GetData());
   new_leaf_page->Init(new_leave_page_id, leaf_page->GetParentPageId(), leaf_max_size_);
 
-  // 设置链表
+  // 设置链表；原来下一个叶子的前驱要等放掉所有锁后再改，先pin住新叶子
   new_leaf_page->SetNextPageId(leaf_page->GetNextPageId());
+  new_leaf_page->SetPrevPageId(leaf_page->GetPageId());
   leaf_page->SetNextPageId(new_leave_page_id);
+  Page *relink_page = buffer_pool_manager_->FetchPage(new_leave_page_id);
   // 移动当前页面(leaf_max_size_+1)/2后的元素到目标页面
   leaf_page->MoveDataTo(new_leaf_page, (leaf_max_size_ + 1) / 2);
 
@@ -325,8 +364,8 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
     // 如果old_tree_page为根节点 则创建一个新的根节点
     if (old_tree_page->IsRootPage()) {
       // std::cout << "new 2" << std::endl;
-      Page *new_page = buffer_pool_manager_->NewPage(&root_page_id_);
-      auto new_root_page = reinterpret_cast<InternalPage *>(new_page);
+      Page *new_page = buffer_pool_manager_->NewPageInExtent(&root_page_id_, &extent_allocator_);
+      auto new_root_page = reinterpret_cast<InternalPage *>(new_page->GetData());
       new_root_page->Init(root_page_id_, INVALID_PAGE_ID, internal_max_size_);
       // 指向小的，key的值不起作用  不进入判断
       new_root_page->SetKeyValueAt(0, split_key, old_tree_page->GetPageId());
@@ -375,8 +414,8 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
     // 父节点溢出
     page_id_t new_internal_page_id;
     // std::cout << "new 3" << std::endl;
-    Page *new_page = buffer_pool_manager_->NewPage(&new_internal_page_id);
-    auto new_internal_page = reinterpret_cast<InternalPage *>(new_page);
+    Page *new_page = buffer_pool_manager_->NewPageInExtent(&new_internal_page_id, &extent_allocator_);
+    auto new_internal_page = reinterpret_cast<InternalPage *>(new_page->GetData());
     new_internal_page->Init(new_internal_page_id, parent_internal_page->GetParentPageId(), internal_max_size_);
     int new_page_size = (internal_max_size_ + 1) / 2;
     size_t start_index = parent_internal_page->GetSize() - new_page_size;
@@ -387,7 +426,7 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
       // Page *page_t = buffer_pool_manager_->FetchPage(parent_internal_page->ValueAt(i));
       bool page_need_unpin;
       Page *page_t = GetPage(parent_internal_page->ValueAt(i), transaction, &page_need_unpin);
-      auto tree_page = reinterpret_cast<BPlusTreePage *>(page_t);
+      auto tree_page = reinterpret_cast<BPlusTreePage *>(page_t->GetData());
       // 修改该page的父节点
       tree_page->SetParentPageId(new_internal_page_id);
       if (page_need_unpin) {
@@ -411,9 +450,116 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
   // buffer_pool_manager_->UnpinPage(old_tree_page->GetPageId(), true);
   // buffer_pool_manager_->UnpinPage(new_tree_page->GetPageId(), true);
   ReleaseWLatches(transaction);
+  RelinkNextLeaf(relink_page);
   return true;
 }
 
+/*****************************************************************************
+ * BULK LOAD
+ *****************************************************************************/
+/*
+ * Build the tree bottom-up: sort the entries, pack them into a chain of leaves,
+ * then pack the first key and page id of every page into the level above until
+ * a single root remains. Each page is written once and no page ever splits.
+ * @return: false if the tree already has entries
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::BulkLoad(std::vector<MappingType> *entries, double fill_factor) -> bool {
+  // 新建的page在根节点id发布之前对其他线程都不可见，只需要锁住根节点id
+  root_latch_.WLock();
+  if (!IsEmpty()) {
+    root_latch_.WUnlock();
+    return false;
+  }
+
+  // 稳定排序后去重，重复的key保留最先出现的那个，和逐条Insert的结果一致
+  std::stable_sort(entries->begin(), entries->end(), [this](const MappingType &a, const MappingType &b) {
+    return comparator_(a.first, b.first) < 0;
+  });
+  auto last = std::unique(entries->begin(), entries->end(), [this](const MappingType &a, const MappingType &b) {
+    return comparator_(a.first, b.first) == 0;
+  });
+  entries->erase(last, entries->end());
+  if (entries->empty()) {
+    root_latch_.WUnlock();
+    return true;
+  }
+
+  fill_factor = std::clamp(fill_factor, 0.0, 1.0);
+  auto target_size = [fill_factor](size_t capacity) {
+    return std::max<size_t>(static_cast<size_t>(fill_factor * static_cast<double>(capacity) + 0.5), 1);
+  };
+  // 叶子在size到达max_size时分裂，所以最多放max_size-1个元素；内部节点最多放max_size个子节点且至少要有2个
+  auto leaf_capacity = static_cast<size_t>(std::max(leaf_max_size_ - 1, 1));
+  auto leaf_min_size = std::min<size_t>(std::max(leaf_max_size_ / 2, 1), leaf_capacity);
+  auto internal_capacity = static_cast<size_t>(std::max(internal_max_size_, 2));
+  auto internal_min_size = std::min<size_t>(std::max((internal_max_size_ + 1) / 2, 2), internal_capacity);
+
+  // 当前这一层每个page的第一个key和page id，用来构造上一层
+  std::vector<std::pair<KeyType, page_id_t>> level;
+  size_t next_entry = 0;
+  LeafPage *prev_leaf_page = nullptr;
+  for (size_t size : PlanPages(entries->size(), target_size(leaf_capacity), leaf_min_size, leaf_capacity)) {
+    page_id_t page_id;
+    Page *page = buffer_pool_manager_->NewPageInExtent(&page_id, &extent_allocator_);
+    auto leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+    leaf_page->Init(page_id, INVALID_PAGE_ID, leaf_max_size_);
+    for (size_t i = 0; i < size; ++i, ++next_entry) {
+      leaf_page->SetKeyValueAt(i, (*entries)[next_entry].first, (*entries)[next_entry].second);
+    }
+    leaf_page->SetSize(size);
+    level.emplace_back(leaf_page->KeyAt(0), page_id);
+
+    // 前一个叶子要等到这里拿到下一个叶子的id才能接上链表
+    if (prev_leaf_page != nullptr) {
+      leaf_page->SetPrevPageId(prev_leaf_page->GetPageId());
+      prev_leaf_page->SetNextPageId(page_id);
+      buffer_pool_manager_->UnpinPage(prev_leaf_page->GetPageId(), true);
+    }
+    prev_leaf_page = leaf_page;
+  }
+  buffer_pool_manager_->UnpinPage(prev_leaf_page->GetPageId(), true);
+
+  while (level.size() > 1) {
+    std::vector<std::pair<KeyType, page_id_t>> parent_level;
+    size_t next_child = 0;
+    for (size_t size : PlanPages(level.size(), target_size(internal_capacity), internal_min_size, internal_capacity)) {
+      page_id_t page_id;
+      Page *page = buffer_pool_manager_->NewPageInExtent(&page_id, &extent_allocator_);
+      auto internal_page = reinterpret_cast<InternalPage *>(page->GetData());
+      internal_page->Init(page_id, INVALID_PAGE_ID, internal_max_size_);
+      // 第0个key不参与查找，这里也存上子树的最小key，上一层直接取KeyAt(0)作为分隔key
+      for (size_t i = 0; i < size; ++i, ++next_child) {
+        internal_page->SetKeyValueAt(i, level[next_child].first, level[next_child].second);
+        SetPageParentId(level[next_child].second, page_id);
+      }
+      internal_page->SetSize(size);
+      parent_level.emplace_back(internal_page->KeyAt(0), page_id);
+      buffer_pool_manager_->UnpinPage(page_id, true);
+    }
+    level = std::move(parent_level);
+  }
+
+  root_page_id_ = level[0].second;
+  UpdateRootPageId();
+  root_latch_.WUnlock();
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::PlanPages(size_t count, size_t target, size_t min_size, size_t max_size) -> std::vector<size_t> {
+  // 页数在[ceil(count/max_size), floor(count/min_size)]之间时平均分配，每页都不会越界；
+  // 凑不满一页最小值的只能放在同一个page里，这个page一定是根节点
+  size_t pages = (count + target - 1) / target;
+  pages = std::max(pages, (count + max_size - 1) / max_size);
+  pages = std::min(pages, std::max<size_t>(count / min_size, 1));
+  std::vector<size_t> sizes(pages, count / pages);
+  for (size_t i = 0; i < count % pages; ++i) {
+    sizes[i]++;
+  }
+  return sizes;
+}
+
 /*****************************************************************************
  * REMOVE
  *****************************************************************************/
@@ -443,17 +589,35 @@ void BPLUSTREE_TYPE::Remove(const KeyType &key, Transaction *transaction) {
   //  }
 
   // 发生下溢出
+  Page *relink_page = nullptr;
   if (leaf_page->GetSize() < leaf_page->GetMinSize()) {
     // 递归调用
-    HandleUnderflow(leaf_page, transaction);
+    HandleUnderflow(leaf_page, transaction, &relink_page);
   }
   ReleaseWLatches(transaction);
+  if (relink_page != nullptr) {
+    RelinkNextLeaf(relink_page);
+  }
 
+  // 还被读者pin住的page这次删不掉，留到后面的Remove再删，否则它永远回不到free space map
   auto deleted_page = transaction->GetDeletedPageSet();
-  for (auto &pid : *deleted_page) {
-    buffer_pool_manager_->DeletePage(pid);
-  }
+  std::vector<page_id_t> to_delete(deleted_page->begin(), deleted_page->end());
   deleted_page->clear();
+  {
+    std::scoped_lock<std::mutex> lock(deferred_deletes_latch_);
+    to_delete.insert(to_delete.end(), deferred_deletes_.begin(), deferred_deletes_.end());
+    deferred_deletes_.clear();
+  }
+  std::vector<page_id_t> failed;
+  for (auto pid : to_delete) {
+    if (!buffer_pool_manager_->DeletePage(pid)) {
+      failed.push_back(pid);
+    }
+  }
+  if (!failed.empty()) {
+    std::scoped_lock<std::mutex> lock(deferred_deletes_latch_);
+    deferred_deletes_.insert(deferred_deletes_.end(), failed.begin(), failed.end());
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -480,7 +644,7 @@ void BPLUSTREE_TYPE::SetPageParentId(page_id_t child_pageid, page_id_t parent_pa
 // 当无法从左右兄弟处借节点时选择和他们合并
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::MergePage(BPlusTreePage *left_page, BPlusTreePage *right_page, InternalPage *parent_page,
-                               Transaction *transaction) {
+                               Transaction *transaction, Page **relink_page) {
   // 先从叶节点开始
   if (left_page->IsLeafPage()) {
     auto left_leaf_page = static_cast<LeafPage *>(left_page);
@@ -490,6 +654,10 @@ void BPLUSTREE_TYPE::MergePage(BPlusTreePage *left_page, BPlusTreePage *right_pa
       left_leaf_page->Insert(right_leaf_page->KeyAt(i), right_leaf_page->ValueAt(i), comparator_);
     }
     left_leaf_page->SetNextPageId(right_leaf_page->GetNextPageId());
+    // 右边的叶子不再属于这棵树。它的next保持不变，停在上面的正向迭代器还能走下去；反向迭代器看到页类型变了会从根重新查找
+    right_leaf_page->SetPageType(IndexPageType::INVALID_INDEX_PAGE);
+    // 下一个叶子的前驱要等放掉所有锁后再改为左边的叶子
+    *relink_page = buffer_pool_manager_->FetchPage(left_leaf_page->GetPageId());
     // 从父节点中删除合并完后的右节点
     parent_page->RemoveAt(parent_page->FindValue(right_page->GetPageId()));
     transaction->AddIntoDeletedPageSet(right_page->GetPageId());
@@ -513,7 +681,7 @@ void BPLUSTREE_TYPE::MergePage(BPlusTreePage *left_page, BPlusTreePage *right_pa
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void BPLUSTREE_TYPE::HandleUnderflow(BPlusTreePage *page, Transaction *transaction) {
+void BPLUSTREE_TYPE::HandleUnderflow(BPlusTreePage *page, Transaction *transaction, Page **relink_page) {
   // 处理是根节点的情况  （递归到根节点的情况）
   if (page->IsRootPage()) {
     if (page->GetSize() > 1 || (page->IsLeafPage() && page->GetSize() == 1)) {
@@ -550,18 +718,33 @@ void BPLUSTREE_TYPE::HandleUnderflow(BPlusTreePage *page, Transaction *transacti
   Page *left_sibling_page_1 = nullptr;
   Page *right_sibling_page_1 = nullptr;
 
+  // page 已被调用者pin住，再取一次只是为了拿到它所在的Page对象；和左右兄弟一起一次取回
+  std::vector<page_id_t> fetch_page_ids{page->GetPageId()};
+  if (left_sibling_id != INVALID_PAGE_ID) {
+    fetch_page_ids.push_back(left_sibling_id);
+  }
+  if (right_sibling_id != INVALID_PAGE_ID) {
+    fetch_page_ids.push_back(right_sibling_id);
+  }
+  auto fetched_pages = buffer_pool_manager_->FetchPages(fetch_page_ids);
+  Page *mpage = fetched_pages[0];
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+  if (left_sibling_id != INVALID_PAGE_ID) {
+    left_sibling_page_1 = fetched_pages[1];
+  }
+  if (right_sibling_id != INVALID_PAGE_ID) {
+    right_sibling_page_1 = fetched_pages.back();
+  }
+
   // 顺序加锁
-  Page *mpage = reinterpret_cast<Page *>(page);
   mpage->WUnlatch();
   // 优先左边
   if (left_sibling_id != INVALID_PAGE_ID) {
-    left_sibling_page_1 = buffer_pool_manager_->FetchPage(left_sibling_id);
     left_sibling_page_1->WLatch();
     left_sibling_page = reinterpret_cast<BPlusTreePage *>(left_sibling_page_1->GetData());
   }
   mpage->WLatch();
   if (right_sibling_id != INVALID_PAGE_ID) {
-    right_sibling_page_1 = buffer_pool_manager_->FetchPage(right_sibling_id);
     right_sibling_page_1->WLatch();
     right_sibling_page = reinterpret_cast<BPlusTreePage *>(right_sibling_page_1->GetData());
   }
@@ -590,11 +773,11 @@ void BPLUSTREE_TYPE::HandleUnderflow(BPlusTreePage *page, Transaction *transacti
     left_page = page;
     right_page = right_sibling_page;
   }
-  MergePage(left_page, right_page, parent_page, transaction);
+  MergePage(left_page, right_page, parent_page, transaction, relink_page);
   UnpinSiblings(left_sibling_id, right_sibling_id, left_sibling_page_1, right_sibling_page_1);
   // 子节点下溢出解决后导致父节点下溢出  递归解决
   if (parent_page->GetSize() < parent_page->GetMinSize()) {
-    HandleUnderflow(parent_page, transaction);
+    HandleUnderflow(parent_page, transaction, relink_page);
   }
   if (parent_page_unpin) {
     buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), true);
@@ -684,34 +867,18 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
     root_latch_.RUnlock();
     return End();
   }
-  // 从根节点向下找到第一个叶子节点 返回该节点的迭代器
-  page_id_t next_page_id = root_page_id_;
-  Page *prev_page = nullptr;
-  while (true) {
-    Page *page = buffer_pool_manager_->FetchPage(next_page_id);
-    page->RLatch();
-    if (prev_page == nullptr) {
-      root_latch_.RUnlock();
-    } else {
-      prev_page->RUnlatch();
-    }
-    prev_page = page;
-    auto tree_page = reinterpret_cast<BPlusTreePage *>(page->GetData());
-    if (tree_page->IsLeafPage()) {
-      prev_page->RUnlatch();
-      auto id = tree_page->GetPageId();
-      buffer_pool_manager_->UnpinPage(id, false);
-      // 迭代器设计 为初始化pageid index_in_leaf_ 缓存管理器
-      return INDEXITERATOR_TYPE(id, 0, buffer_pool_manager_);
-    }
-    auto internal_page = static_cast<InternalPage *>(tree_page);
-    if (internal_page == nullptr) {
-      throw std::bad_cast();
-    }
+  // 从根节点向下找到第一个叶子节点 返回该节点的迭代器，读锁逐层交接
+  auto guard = buffer_pool_manager_->FetchPageRead(root_page_id_);
+  root_latch_.RUnlock();
+  while (!guard.As<BPlusTreePage>()->IsLeafPage()) {
     // 指向下一层第一个节点
-    next_page_id = internal_page->ValueAt(0);
-    buffer_pool_manager_->UnpinPage(internal_page->GetPageId(), false);
+    auto child_guard = buffer_pool_manager_->FetchPageRead(guard.As<InternalPage>()->ValueAt(0));
+    guard = std::move(child_guard);
   }
+  auto id = guard.PageId();
+  guard.Drop();
+  // 迭代器设计 为初始化pageid index_in_leaf_ 缓存管理器
+  return INDEXITERATOR_TYPE(id, 0, buffer_pool_manager_);
 }
 
 /*
@@ -722,13 +889,24 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
   root_latch_.RLock();
-  Page *page = GetLeafPage(key, Operation::Read, nullptr);
-
-  auto leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
-
-  page->RUnlatch();
-
-  return INDEXITERATOR_TYPE(page->GetPageId(), leaf_page->LowerBound(key, comparator_), buffer_pool_manager_);
+  if (IsEmpty()) {
+    root_latch_.RUnlock();
+    return End();
+  }
+  ReadPageGuard guard(buffer_pool_manager_, GetLeafPage(key, Operation::Read, nullptr), std::adopt_lock);
+  auto id = guard.PageId();
+  auto leaf_page = guard.As<LeafPage>();
+  auto index_in_leaf = leaf_page->LowerBound(key, comparator_, leaf_page->GetSize());
+  // 叶子里所有key都比key小时，第一个不小于key的元素在下一个叶子的开头
+  if (index_in_leaf == leaf_page->GetSize()) {
+    id = leaf_page->GetNextPageId();
+    index_in_leaf = 0;
+  }
+  guard.Drop();
+  if (id == INVALID_PAGE_ID) {
+    return End();
+  }
+  return INDEXITERATOR_TYPE(id, index_in_leaf, buffer_pool_manager_);
 }
 
 /*
@@ -742,6 +920,125 @@ auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE {
   return INDEXITERATOR_TYPE(INVALID_PAGE_ID, 0, buffer_pool_manager_);
 }
 
+/*
+ * Construct a reverse index iterator at the last key/value pair of the tree
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin() -> INDEXITERATOR_TYPE { return ReverseSeek(nullptr, true); }
+
+/*
+ * Construct a reverse index iterator at the last key/value pair whose key is
+ * not greater than the input key
+ * @return : index iterator
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::RBegin(const KeyType &key) -> INDEXITERATOR_TYPE { return ReverseSeek(&key, true); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::ReverseSeek(const KeyType *key, bool inclusive) -> INDEXITERATOR_TYPE {
+  while (true) {
+    root_latch_.RLock();
+    if (IsEmpty()) {
+      root_latch_.RUnlock();
+      return End();
+    }
+    auto guard = buffer_pool_manager_->FetchPageRead(root_page_id_);
+    root_latch_.RUnlock();
+    while (!guard.As<BPlusTreePage>()->IsLeafPage()) {
+      auto internal_page = guard.As<InternalPage>();
+      int index = internal_page->GetSize() - 1;
+      if (key != nullptr) {
+        index = internal_page->ChildIndex(*key, comparator_, internal_page->GetSize());
+        // 子树的分隔key等于key时，子树里没有比key小的key
+        if (!inclusive && index > 0 && comparator_(internal_page->KeyAt(index), *key) == 0) {
+          --index;
+        }
+      }
+      auto child_guard = buffer_pool_manager_->FetchPageRead(internal_page->ValueAt(index));
+      guard = std::move(child_guard);
+    }
+
+    auto leaf_page = guard.As<LeafPage>();
+    int index = leaf_page->GetSize();
+    if (key != nullptr) {
+      index = leaf_page->LowerBound(*key, comparator_, leaf_page->GetSize());
+      if (inclusive && index < leaf_page->GetSize() && comparator_(leaf_page->KeyAt(index), *key) == 0) {
+        ++index;
+      }
+    }
+    INDEXITERATOR_TYPE iterator;
+    if (PositionBackward(&guard, index - 1, key, inclusive, &iterator)) {
+      return iterator;
+    }
+    // 左边的叶子正被写，放掉所有锁让写操作做完再重来
+    guard.Drop();
+    std::this_thread::yield();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::PositionBackward(ReadPageGuard *guard, int index, const KeyType *key, bool inclusive,
+                                      INDEXITERATOR_TYPE *iterator) -> bool {
+  auto leaf_page = guard->As<LeafPage>();
+  if (index >= 0) {
+    *iterator = INDEXITERATOR_TYPE(this, guard->PageId(), index, leaf_page->KeyValueAt(index), buffer_pool_manager_);
+    return true;
+  }
+  // 只有最左边的叶子没有前驱
+  page_id_t prev_page_id = leaf_page->GetPrevPageId();
+  if (prev_page_id == INVALID_PAGE_ID) {
+    *iterator = End();
+    return true;
+  }
+
+  // 写操作都是先左后右加锁，这里拿着右边的叶子去锁左边的叶子，等下去可能死锁，只能试一次
+  Page *prev_page = buffer_pool_manager_->FetchPage(prev_page_id);
+  if (!prev_page->TryRLatch()) {
+    buffer_pool_manager_->UnpinPage(prev_page_id, false);
+    return false;
+  }
+  ReadPageGuard prev_guard(buffer_pool_manager_, prev_page, std::adopt_lock);
+  auto prev_leaf_page = prev_guard.As<LeafPage>();
+  // 前驱指针在分裂、合并之后才修正，可能已经过时。左边的叶子仍然指向这里时，持有这个叶子的锁期间它不会再变
+  if (!prev_leaf_page->IsLeafPage() || prev_leaf_page->GetNextPageId() != guard->PageId() ||
+      prev_leaf_page->GetSize() == 0) {
+    return false;
+  }
+  // 放开这个叶子之后左边的叶子可能又被重分配、插入过，里面不一定都比key小，不能直接取最后一个
+  int prev_index = prev_leaf_page->GetSize();
+  if (key != nullptr) {
+    prev_index = prev_leaf_page->LowerBound(*key, comparator_, prev_leaf_page->GetSize());
+    if (inclusive && prev_index < prev_leaf_page->GetSize() &&
+        comparator_(prev_leaf_page->KeyAt(prev_index), *key) == 0) {
+      ++prev_index;
+    }
+  }
+  if (--prev_index < 0) {
+    return false;
+  }
+  *iterator = INDEXITERATOR_TYPE(this, prev_page_id, prev_index, prev_leaf_page->KeyValueAt(prev_index),
+                                 buffer_pool_manager_);
+  return true;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_TYPE::RelinkNextLeaf(Page *page) {
+  // 持有左边叶子的读锁时它的next不会变，next指向的叶子也不会被合并掉，此时改它的前驱一定是对的
+  page->RLatch();
+  auto leaf_page = reinterpret_cast<LeafPage *>(page->GetData());
+  page_id_t next_page_id = leaf_page->GetNextPageId();
+  if (leaf_page->IsLeafPage() && next_page_id != INVALID_PAGE_ID) {
+    Page *next_page = buffer_pool_manager_->FetchPage(next_page_id);
+    next_page->WLatch();
+    reinterpret_cast<LeafPage *>(next_page->GetData())->SetPrevPageId(leaf_page->GetPageId());
+    next_page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(next_page_id, true);
+  }
+  page->RUnlatch();
+  buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+}
+
 /**
  * @return Page id of the root of this tree
  */
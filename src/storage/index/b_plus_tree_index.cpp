@@ -11,6 +11,8 @@
 
 #include "storage/index/b_plus_tree_index.h"
 
+#include <limits>
+
 namespace bustub {
 /*
  * Constructor
@@ -25,7 +27,7 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::InsertEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct insert index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetMetadata()->GetKeySchema());
 
   container_.Insert(index_key, rid, transaction);
 }
@@ -34,7 +36,7 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::DeleteEntry(const Tuple &key, RID rid, Transaction *transaction) {
   // construct delete index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetMetadata()->GetKeySchema());
 
   container_.Remove(index_key, transaction);
 }
@@ -43,11 +45,66 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_INDEX_TYPE::ScanKey(const Tuple &key, std::vector<RID> *result, Transaction *transaction) {
   // construct scan index key
   KeyType index_key;
-  index_key.SetFromKey(key);
+  index_key.SetFromKey(key, GetMetadata()->GetKeySchema());
 
   container_.GetValue(index_key, result, transaction);
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void BPLUSTREE_INDEX_TYPE::ScanRange(const IndexRange &range, std::vector<RID> *result, Transaction *transaction) {
+  KeyType lower_key;
+  KeyType upper_key;
+  if (range.lower_.has_value()) {
+    lower_key.SetFromKey(*range.lower_, GetMetadata()->GetKeySchema());
+  }
+  if (range.upper_.has_value()) {
+    upper_key.SetFromKey(*range.upper_, GetMetadata()->GetKeySchema());
+  }
+
+  const size_t limit = range.limit_.value_or(std::numeric_limits<size_t>::max());
+  if (range.direction_ == ScanDirection::BACKWARD) {
+    // 从上界所在的叶子开始沿着叶子链表往前扫，越过下界就停下
+    auto iter = range.upper_.has_value() ? container_.RBegin(upper_key) : container_.RBegin();
+    for (size_t count = 0; count < limit && !iter.IsEnd(); ++iter) {
+      const auto &[key, rid] = *iter;
+      if (range.upper_.has_value() && !range.upper_inclusive_ && comparator_(key, upper_key) == 0) {
+        continue;
+      }
+      if (range.lower_.has_value()) {
+        int cmp = comparator_(key, lower_key);
+        if (cmp < 0 || (cmp == 0 && !range.lower_inclusive_)) {
+          break;
+        }
+      }
+      result->push_back(rid);
+      ++count;
+    }
+    return;
+  }
+
+  // 从下界所在的叶子开始沿着叶子链表往后扫，越过上界就停下
+  auto iter = range.lower_.has_value() ? container_.Begin(lower_key) : container_.Begin();
+  for (size_t count = 0; count < limit && !iter.IsEnd(); ++iter) {
+    const auto &[key, rid] = *iter;
+    if (range.lower_.has_value() && !range.lower_inclusive_ && comparator_(key, lower_key) == 0) {
+      continue;
+    }
+    if (range.upper_.has_value()) {
+      int cmp = comparator_(key, upper_key);
+      if (cmp > 0 || (cmp == 0 && !range.upper_inclusive_)) {
+        break;
+      }
+    }
+    result->push_back(rid);
+    ++count;
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_INDEX_TYPE::BulkLoad(std::vector<std::pair<KeyType, ValueType>> *entries) -> bool {
+  return container_.BulkLoad(entries);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_INDEX_TYPE::GetBeginIterator() -> INDEXITERATOR_TYPE { return container_.Begin(); }
 
@@ -3,6 +3,7 @@
  */
 #include <cassert>
 
+#include "storage/index/b_plus_tree.h"
 #include "storage/index/index_iterator.h"
 
 namespace bustub {
@@ -21,17 +22,24 @@ INDEXITERATOR_TYPE::IndexIterator(page_id_t page_id, page_id_t index_in_leaf, Bu
   buffer_pool_manager_ = bpm;
 
   if (page_id_ != INVALID_PAGE_ID) {
-    page_ = buffer_pool_manager_->FetchPage(page_id_);
-    leaf_page_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page_);
+    guard_ = buffer_pool_manager_->FetchPageBasic(page_id_);
+    leaf_page_ = guard_.As<B_PLUS_TREE_LEAF_PAGE_TYPE>();
+    ReadAhead();
   }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() {
-  if (page_id_ != INVALID_PAGE_ID) {
-    buffer_pool_manager_->UnpinPage(page_id_, true);
-  }
-}  //= default;  // NOLINT
+INDEXITERATOR_TYPE::IndexIterator(BPlusTree<KeyType, ValueType, KeyComparator> *tree, page_id_t page_id,
+                                  int index_in_leaf, const MappingType &entry, BufferPoolManager *bpm)
+    : page_id_(page_id), index_in_leaf_(index_in_leaf), current_(entry), buffer_pool_manager_(bpm), tree_(tree) {
+  // 调用者还持有这个叶子的读锁，这里只pin住它：页不会被换出或复用，但内容要在下次移动时重新加锁读取
+  guard_ = buffer_pool_manager_->FetchPageBasic(page_id_);
+  leaf_page_ = guard_.As<B_PLUS_TREE_LEAF_PAGE_TYPE>();
+  ReadAhead();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
 
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::IsEnd() -> bool { return page_id_ == INVALID_PAGE_ID; }
@@ -40,10 +48,14 @@ INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
   BUSTUB_ASSERT(page_id_ != INVALID_PAGE_ID, "page_id_ != INVALID_PAGE_ID");
   BUSTUB_ASSERT(page_id_ == leaf_page_->GetPageId(), "page_id_ == leaf_page_->GetPageId()");
+  if (IsReverse()) {
+    return current_;
+  }
   //  auto index = leaf_page_->KeyValueAt(index_in_leaf_).first;
   //  if (index.ToString() % 5 == 0)
   //    std::cout << leaf_page_->KeyAt(index_in_leaf_) << std::endl;
-  return leaf_page_->KeyValueAt(index_in_leaf_);
+  current_ = leaf_page_->KeyValueAt(index_in_leaf_);
+  return current_;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -51,33 +63,66 @@ auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
   if (page_id_ == INVALID_PAGE_ID) {
     return *this;
   }
+  if (IsReverse()) {
+    StepBackward();
+    return *this;
+  }
   if (index_in_leaf_ < leaf_page_->GetSize() - 1) {
     ++index_in_leaf_;
   } else {
     index_in_leaf_ = 0;
-    page_id_t prev_page_id = page_id_;
     page_id_ = leaf_page_->GetNextPageId();
     if (page_id_ == INVALID_PAGE_ID) {
-      page_ = nullptr;
+      guard_.Drop();
       leaf_page_ = nullptr;
-      page_id_ = INVALID_PAGE_ID;
-      index_in_leaf_ = 0;
     } else {
-      page_ = buffer_pool_manager_->FetchPage(page_id_);
-      leaf_page_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page_->GetData());
+      // 先pin住下一个叶子，再放掉当前叶子
+      guard_ = buffer_pool_manager_->FetchPageBasic(page_id_);
+      leaf_page_ = guard_.As<B_PLUS_TREE_LEAF_PAGE_TYPE>();
+      ReadAhead();
     }
-    buffer_pool_manager_->UnpinPage(prev_page_id, false);
   }
   return *this;
 }
 
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::StepBackward() {
+  const KeyType key = current_.first;
+  auto guard = buffer_pool_manager_->FetchPageRead(page_id_);
+  auto leaf_page = guard.As<B_PLUS_TREE_LEAF_PAGE_TYPE>();
+  const int size = leaf_page->GetSize();
+  const int index = leaf_page->LowerBound(key, tree_->comparator_, size);
+  // 叶子被合并掉后不再是叶子页；key比叶子里所有key都大时，比key小的key可能已经分裂到右边的新叶子里。这两种情况都从根重新找
+  if (leaf_page->IsLeafPage() && index < size && tree_->PositionBackward(&guard, index - 1, &key, false, this)) {
+    return;
+  }
+  guard.Drop();
+  *this = tree_->ReverseSeek(&key, false);
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::ReadAhead() {
+  // 叶子之间没有物理上的顺序，只能预读链表上的下一个叶子；反向迭代器的前驱指针只是提示，预读错了也无妨
+  const page_id_t page_id = IsReverse() ? leaf_page_->GetPrevPageId() : leaf_page_->GetNextPageId();
+  if (read_ahead_window > 0 && page_id != INVALID_PAGE_ID) {
+    buffer_pool_manager_->PrefetchPages({page_id});
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept {
+  *this = std::move(other);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::operator=(IndexIterator &&other) noexcept -> IndexIterator & {
   std::swap(page_id_, other.page_id_);
-  std::swap(page_, other.page_);
+  std::swap(guard_, other.guard_);
   std::swap(leaf_page_, other.leaf_page_);
   std::swap(index_in_leaf_, other.index_in_leaf_);
+  std::swap(current_, other.current_);
   std::swap(buffer_pool_manager_, other.buffer_pool_manager_);
+  std::swap(tree_, other.tree_);
   return *this;
 }
 
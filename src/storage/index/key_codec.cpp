@@ -0,0 +1,169 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_codec.cpp
+//
+// Identification: src/storage/index/key_codec.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/key_codec.h"
+
+#include <algorithm>
+#include <string>
+
+#include "common/exception.h"
+#include "type/limits.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+constexpr uint64_t DECIMAL_SIGN_BIT = uint64_t{1} << 63;
+constexpr char VARCHAR_NULL = 0x00;
+constexpr char VARCHAR_NOT_NULL = 0x01;
+constexpr char VARCHAR_TERMINATOR = 0x00;
+
+auto EncodeDecimal(double value) -> uint64_t {
+  uint64_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  // 负数全部取反，大小顺序随之反转；正数只翻转符号位，排到所有负数后面
+  return (bits & DECIMAL_SIGN_BIT) != 0 ? ~bits : bits | DECIMAL_SIGN_BIT;
+}
+
+auto DecodeDecimal(uint64_t bits) -> double {
+  bits = (bits & DECIMAL_SIGN_BIT) != 0 ? bits & ~DECIMAL_SIGN_BIT : ~bits;
+  double value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+/** @return NULL of a fixed-width type; ValueFactory has no NULL timestamp, which is BUSTUB_TIMESTAMP_NULL */
+auto NullValue(TypeId type) -> Value {
+  return type == TypeId::TIMESTAMP ? ValueFactory::GetTimestampValue(static_cast<int64_t>(BUSTUB_TIMESTAMP_NULL))
+                                   : ValueFactory::GetNullValueByType(type);
+}
+
+/** @return the bytes the value of a fixed-width column is encoded into */
+auto EncodeFixed(const Value &value, uint64_t *bits) -> size_t {
+  switch (value.GetTypeId()) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      *bits = static_cast<uint64_t>(value.GetAs<int8_t>()) ^ (uint64_t{1} << 7);
+      return 1;
+    case TypeId::SMALLINT:
+      *bits = static_cast<uint64_t>(value.GetAs<int16_t>()) ^ (uint64_t{1} << 15);
+      return 2;
+    case TypeId::INTEGER:
+      *bits = static_cast<uint64_t>(value.GetAs<int32_t>()) ^ (uint64_t{1} << 31);
+      return 4;
+    case TypeId::BIGINT:
+      *bits = static_cast<uint64_t>(value.GetAs<int64_t>()) ^ (uint64_t{1} << 63);
+      return 8;
+    case TypeId::DECIMAL:
+      *bits = EncodeDecimal(value.GetAs<double>());
+      return 8;
+    case TypeId::TIMESTAMP:
+      *bits = value.GetAs<uint64_t>();
+      return 8;
+    default:
+      break;
+  }
+  throw Exception(ExceptionType::UNKNOWN_TYPE, "Unknown type in index key.");
+}
+
+}  // namespace
+
+void KeyCodec::Encode(const Tuple &key, const Schema *key_schema, char *data, size_t size) {
+  memset(data, 0, size);
+  size_t offset = 0;
+  for (uint32_t i = 0; i < key_schema->GetColumnCount() && offset < size; i++) {
+    const Value value = key.GetValue(key_schema, i);
+    if (value.GetTypeId() == TypeId::VARCHAR) {
+      if (value.IsNull()) {
+        data[offset++] = VARCHAR_NULL;
+        continue;
+      }
+      data[offset++] = VARCHAR_NOT_NULL;
+      // 放不下的部分直接截断，只按前缀排序
+      const std::string str = value.ToString();
+      const size_t length = std::min(str.size(), size - offset);
+      memcpy(data + offset, str.data(), length);
+      offset += length;
+      if (offset < size) {
+        data[offset++] = VARCHAR_TERMINATOR;
+      }
+      continue;
+    }
+
+    uint64_t bits = 0;
+    const size_t width = EncodeFixed(value, &bits);
+    if (value.IsNull()) {
+      // TIMESTAMP没有偏移，0是合法的时间戳；NULL沿用BUSTUB_TIMESTAMP_NULL，排在最后
+      bits = value.GetTypeId() == TypeId::TIMESTAMP ? BUSTUB_TIMESTAMP_NULL : 0;
+    }
+    // 定长列放不下时只保留高位字节，仍然保持顺序
+    char buf[sizeof(uint64_t)];
+    StoreBigEndian(bits, width, buf);
+    const size_t length = std::min(width, size - offset);
+    memcpy(data + offset, buf, length);
+    offset += length;
+  }
+}
+
+auto KeyCodec::Decode(const char *data, size_t size, const Schema *key_schema, uint32_t column_idx) -> Value {
+  size_t offset = 0;
+  for (uint32_t i = 0; i <= column_idx; i++) {
+    const TypeId type = key_schema->GetColumn(i).GetType();
+    if (type == TypeId::VARCHAR) {
+      if (offset >= size) {
+        return ValueFactory::GetNullValueByType(type);
+      }
+      const bool is_null = data[offset++] == VARCHAR_NULL;
+      const char *begin = data + offset;
+      const char *end = is_null ? begin : std::find(begin, data + size, VARCHAR_TERMINATOR);
+      offset = std::min(static_cast<size_t>(end - data) + (is_null ? 0 : 1), size);
+      if (i == column_idx) {
+        return is_null ? ValueFactory::GetNullValueByType(type)
+                       : ValueFactory::GetVarcharValue(std::string(begin, end - begin));
+      }
+      continue;
+    }
+
+    const size_t width = Type::GetTypeSize(type);
+    if (offset + width > size) {
+      return NullValue(type);
+    }
+    if (i < column_idx) {
+      offset += width;
+      continue;
+    }
+    const uint64_t bits = LoadBigEndian(data + offset, width);
+    if (type == TypeId::TIMESTAMP ? bits == BUSTUB_TIMESTAMP_NULL : bits == 0) {
+      return NullValue(type);
+    }
+    switch (type) {
+      case TypeId::BOOLEAN:
+        return ValueFactory::GetBooleanValue(static_cast<int8_t>(DecodeInteger(data + offset, width)));
+      case TypeId::TINYINT:
+        return ValueFactory::GetTinyIntValue(static_cast<int8_t>(DecodeInteger(data + offset, width)));
+      case TypeId::SMALLINT:
+        return ValueFactory::GetSmallIntValue(static_cast<int16_t>(DecodeInteger(data + offset, width)));
+      case TypeId::INTEGER:
+        return ValueFactory::GetIntegerValue(static_cast<int32_t>(DecodeInteger(data + offset, width)));
+      case TypeId::BIGINT:
+        return ValueFactory::GetBigIntValue(DecodeInteger(data + offset, width));
+      case TypeId::DECIMAL:
+        return ValueFactory::GetDecimalValue(DecodeDecimal(bits));
+      case TypeId::TIMESTAMP:
+        return ValueFactory::GetTimestampValue(static_cast<int64_t>(bits));
+      default:
+        break;
+    }
+  }
+  throw Exception(ExceptionType::UNKNOWN_TYPE, "Unknown type in index key.");
+}
+
+}  // namespace bustub
@@ -0,0 +1,180 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search.cpp
+//
+// Identification: src/storage/index/key_search.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/index/key_search.h"
+
+#include <cstring>
+#include <limits>
+
+#include "common/exception.h"
+#include "storage/index/key_codec.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+namespace bustub {
+
+namespace {
+
+/** The binary search stops once the keys left fit into this many bytes, and SIMD compares the rest. */
+constexpr int SIMD_WINDOW_BYTES = 256;
+
+template <typename Word>
+inline auto Load(const char *data) -> Word {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  Word word;
+  memcpy(&word, data, sizeof(word));
+  if constexpr (sizeof(Word) == sizeof(uint64_t)) {
+    return __builtin_bswap64(word);
+  } else {
+    return __builtin_bswap32(word);
+  }
+#else
+  return static_cast<Word>(KeyCodec::LoadBigEndian(data, sizeof(Word)));
+#endif
+}
+
+template <typename Word>
+inline auto Before(Word probe, Word target, bool upper) -> bool {
+  return probe < target || (upper && probe == target);
+}
+
+/**
+ * Binary search until at most window keys are left. The loop has no data-dependent branch: the compiler turns
+ * the choice of half into a conditional move, so a mispredicted compare does not stall the search.
+ * @param[out] base the first key that is left; the answer lies in [base, base + returned count]
+ * @return the number of keys left
+ */
+template <typename Word>
+inline auto Narrow(const char *keys, int count, Word target, bool upper, int window, int *base) -> int {
+  *base = 0;
+  while (count > window) {
+    const int half = count / 2;
+    *base = Before(Load<Word>(keys + (*base + half) * sizeof(Word)), target, upper) ? *base + half : *base;
+    count -= half;
+  }
+  return count;
+}
+
+/** @return base plus the number of keys before key in [base, base + count) */
+template <typename Word>
+inline auto CountScalar(const char *keys, int base, int count, Word target, bool upper) -> int {
+  int index = base;
+  for (; index < base + count; index++) {
+    if (!Before(Load<Word>(keys + index * sizeof(Word)), target, upper)) {
+      break;
+    }
+  }
+  return index;
+}
+
+template <typename Word>
+auto SearchScalarImpl(const char *keys, int count, const char *key, bool upper) -> int {
+  const Word target = Load<Word>(key);
+  int base;
+  count = Narrow<Word>(keys, count, target, upper, 1, &base);
+  return CountScalar<Word>(keys, base, count, target, upper);
+}
+
+#if defined(__x86_64__)
+template <typename Word>
+__attribute__((target("avx2"))) auto SearchAvx2Impl(const char *keys, int count, const char *key, bool upper)
+    -> int {
+  constexpr int lanes = sizeof(__m256i) / sizeof(Word);
+  const Word target = Load<Word>(key);
+  int base;
+  count = Narrow<Word>(keys, count, target, upper, SIMD_WINDOW_BYTES / static_cast<int>(sizeof(Word)), &base);
+
+  // 每个lane内把大端字节翻转成本机字节序，再翻转符号位，这样有符号比较的结果就是无符号的大小关系
+  __m256i swap;
+  __m256i sign;
+  __m256i pivot;
+  if constexpr (sizeof(Word) == sizeof(uint64_t)) {
+    swap = _mm256_setr_epi8(7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13,
+                            12, 11, 10, 9, 8);
+    sign = _mm256_set1_epi64x(std::numeric_limits<int64_t>::min());
+    pivot = _mm256_xor_si256(_mm256_set1_epi64x(static_cast<int64_t>(target)), sign);
+  } else {
+    swap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12, 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8,
+                            15, 14, 13, 12);
+    sign = _mm256_set1_epi32(std::numeric_limits<int32_t>::min());
+    pivot = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int32_t>(target)), sign);
+  }
+
+  int index = base;
+  int before = 0;
+  for (; index + lanes <= base + count; index += lanes) {
+    __m256i probe = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + index * sizeof(Word)));
+    probe = _mm256_xor_si256(_mm256_shuffle_epi8(probe, swap), sign);
+    // lower bound数小于key的个数，upper bound数不大于key的个数
+    __m256i mask;
+    if constexpr (sizeof(Word) == sizeof(uint64_t)) {
+      mask = upper ? _mm256_cmpgt_epi64(probe, pivot) : _mm256_cmpgt_epi64(pivot, probe);
+    } else {
+      mask = upper ? _mm256_cmpgt_epi32(probe, pivot) : _mm256_cmpgt_epi32(pivot, probe);
+    }
+    const int bits = _mm256_movemask_epi8(mask);
+    const int matched = __builtin_popcount(static_cast<unsigned>(bits)) / static_cast<int>(sizeof(Word));
+    // 键是有序的，排在key前面的个数加起来就是答案的偏移，不需要分支提前退出
+    before += upper ? lanes - matched : matched;
+  }
+  if (before < index - base) {
+    return base + before;
+  }
+  return CountScalar<Word>(keys, index, base + count - index, target, upper);
+}
+#endif
+
+}  // namespace
+
+auto KeySearch::Search(const char *keys, int count, const char *key, size_t width, bool upper) -> int {
+  static const bool has_simd_support = HasSimdSupport();
+  return has_simd_support ? SearchSimd(keys, count, key, width, upper)
+                          : SearchScalar(keys, count, key, width, upper);
+}
+
+auto KeySearch::HasSimdSupport() -> bool {
+#if defined(__x86_64__)
+  return __builtin_cpu_supports("avx2") != 0;
+#else
+  return false;
+#endif
+}
+
+auto KeySearch::SearchScalar(const char *keys, int count, const char *key, size_t width, bool upper) -> int {
+  switch (width) {
+    case sizeof(uint32_t):
+      return SearchScalarImpl<uint32_t>(keys, count, key, upper);
+    case sizeof(uint64_t):
+      return SearchScalarImpl<uint64_t>(keys, count, key, upper);
+    default:
+      break;
+  }
+  throw Exception(ExceptionType::NOT_IMPLEMENTED, "Key search only supports 4 and 8 byte keys.");
+}
+
+auto KeySearch::SearchSimd(const char *keys, int count, const char *key, size_t width, bool upper) -> int {
+#if defined(__x86_64__)
+  switch (width) {
+    case sizeof(uint32_t):
+      return SearchAvx2Impl<uint32_t>(keys, count, key, upper);
+    case sizeof(uint64_t):
+      return SearchAvx2Impl<uint64_t>(keys, count, key, upper);
+    default:
+      break;
+  }
+  throw Exception(ExceptionType::NOT_IMPLEMENTED, "Key search only supports 4 and 8 byte keys.");
+#else
+  return SearchScalar(keys, count, key, width, upper);
+#endif
+}
+
+}  // namespace bustub
@@ -9,10 +9,12 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <iostream>
 #include <sstream>
 
 #include "common/exception.h"
+#include "storage/index/key_search.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 
 namespace bustub {
@@ -26,6 +28,9 @@ namespace bustub {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  static_assert((INTERNAL_PAGE_HEADER_SIZE + INTERNAL_PAGE_SLOT_COUNT * sizeof(KeyType)) % alignof(ValueType) == 0);
+  // 分裂前会暂时放下max_size + 1个元素
+  BUSTUB_ASSERT(max_size < static_cast<int>(INTERNAL_PAGE_SLOT_COUNT), "internal max_size does not fit into a page");
   SetPageType(IndexPageType::INTERNAL_PAGE);
   SetPageId(page_id);
   SetParentPageId(parent_id);
@@ -40,18 +45,19 @@ INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::KeyAt(int index) const -> KeyType {
   // replace with your own code
   // KeyType key{};
-  return array_[index].first;
+  return Keys()[index];
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyValueAt(int index, const KeyType &key, const ValueType &value) {
-  array_[index] = MappingType{key, value};
+  Keys()[index] = key;
+  Values()[index] = value;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) { array_[index].first = key; }
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetKeyAt(int index, const KeyType &key) { Keys()[index] = key; }
 INDEX_TEMPLATE_ARGUMENTS
-void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetValueAt(int index, const ValueType &value) { array_[index].second = value; }
+void B_PLUS_TREE_INTERNAL_PAGE_TYPE::SetValueAt(int index, const ValueType &value) { Values()[index] = value; }
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Insert(const KeyType &key, const ValueType &value, const KeyComparator &comp) {
@@ -64,14 +70,10 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Insert(const KeyType &key, const ValueType
     throw std::logic_error("B+ Tree leaf page already reached max_size before insert.Should have splitted before");
   }
   // 内部节点从1开始  0节点无效  只指向小于1节点的page
-  int ins_at = 1;
-  while (ins_at < size && comp(array_[ins_at].first, key) < 0) {
-    ++ins_at;
-  }
+  int ins_at = 1 + KeySearch::LowerBound(Keys() + 1, size - 1, key, comp);
 
-  for (int i = size; i > ins_at; --i) {
-    array_[i] = array_[i - 1];
-  }
+  std::move_backward(Keys() + ins_at, Keys() + size, Keys() + size + 1);
+  std::move_backward(Values() + ins_at, Values() + size, Values() + size + 1);
   IncreaseSize(1);
   SetKeyValueAt(ins_at, key, value);
 }
@@ -79,20 +81,22 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::Insert(const KeyType &key, const ValueType
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::FindValue(page_id_t pageid) const -> int {
   int size = GetSize();
-  for (int i = 0; i < size; ++i) {
-    if (array_[i].second == pageid) {
-      return i;
-    }
-  }
-  return -1;
+  auto it = std::find(Values(), Values() + size, pageid);
+  return it == Values() + size ? -1 : static_cast<int>(it - Values());
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ChildIndex(const KeyType &key, const KeyComparator &comp, int size) const
+    -> int {
+  // 第0个key无效；子节点i负责[KeyAt(i), KeyAt(i + 1))，即最后一个不大于key的位置
+  return KeySearch::UpperBound(Keys() + 1, size - 1, key, comp);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAt(int index) {
   int size = GetSize();
-  for (int i = index; i < size - 1; ++i) {
-    array_[i] = array_[i + 1];
-  }
+  std::move(Keys() + index + 1, Keys() + size, Keys() + index);
+  std::move(Values() + index + 1, Values() + size, Values() + index);
   DecreaseSize(1);
 }
 
@@ -101,7 +105,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::RemoveAt(int index) {
  * offset)
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { return array_[index].second; }
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType { return Values()[index]; }
 
 // valuetype for internalNode should be page id_t
 template class BPlusTreeInternalPage<GenericKey<4>, page_id_t, GenericComparator<4>>;
@@ -9,11 +9,13 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <cstring>
 #include <sstream>
 
 #include "common/exception.h"
 #include "common/rid.h"
+#include "storage/index/key_search.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
@@ -29,12 +31,15 @@ namespace bustub {
  */
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, int max_size) {
+  static_assert((LEAF_PAGE_HEADER_SIZE + LEAF_PAGE_SLOT_COUNT * sizeof(KeyType)) % alignof(ValueType) == 0);
+  BUSTUB_ASSERT(max_size <= static_cast<int>(LEAF_PAGE_SLOT_COUNT), "leaf max_size does not fit into a page");
   // 设置page类型为叶页面
   SetPageType(IndexPageType::LEAF_PAGE);
   // 设置pageid
   SetPageId(page_id);
-  // 暂时下一个节点为空
+  // 暂时前后节点都为空
   SetNextPageId(INVALID_PAGE_ID);
+  SetPrevPageId(INVALID_PAGE_ID);
   // 设置父节点
   SetParentPageId(parent_id);
   // 设置页面中键和值对的数量 初始为0，没有键值对
@@ -44,7 +49,7 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::Init(page_id_t page_id, page_id_t parent_id, in
 }
 
 /**
- * Helper methods to set/get next page id
+ * Helper methods to set/get next and previous page id
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return next_page_id_; }
@@ -52,6 +57,12 @@ auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetNextPageId() const -> page_id_t { return nex
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_page_id_ = next_page_id; }
 
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::GetPrevPageId() const -> page_id_t { return prev_page_id_; }
+
+INDEX_TEMPLATE_ARGUMENTS
+void B_PLUS_TREE_LEAF_PAGE_TYPE::SetPrevPageId(page_id_t prev_page_id) { prev_page_id_ = prev_page_id; }
+
 /*
  * Helper method to find and return the key associated with input "index"(a.k.a
  * array offset)
@@ -60,21 +71,24 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::SetNextPageId(page_id_t next_page_id) { next_pa
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyAt(int index) const -> KeyType {
   // replace with your own code
-  return array_[index].first;
+  return Keys()[index];
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_LEAF_PAGE_TYPE::ValueAt(int index) const -> ValueType {
   // replace with your own code
-  return array_[index].second;
+  return Values()[index];
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyValueAt(int index) const -> const MappingType & { return array_[index]; }
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::KeyValueAt(int index) const -> MappingType {
+  return MappingType{Keys()[index], Values()[index]};
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::SetKeyValueAt(int index, KeyType key, ValueType value) {
-  array_[index] = MappingType{key, value};
+  Keys()[index] = key;
+  Values()[index] = value;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -86,35 +100,10 @@ void B_PLUS_TREE_LEAF_PAGE_TYPE::Insert(const KeyType &key, const ValueType &val
               << "maxsize: " << GetMaxSize() << std::endl;
     throw std::logic_error("B+ Tree leaf page already reached max_size before insert.Should have splitted before");
   }
-  int ins_at = 0;
-  if (comp(array_[0].first, key) > 0) {
-    ins_at = 0;
-  } else if (comp(array_[size - 1].first, key) < 0) {
-    ins_at = size;
-  } else {
-    int i = 0;
-    int j = size - 2;
-    while (i <= j) {
-      int mid = i + (j - i) / 2;
-      if (comp(array_[mid].first, key) < 0 && comp(array_[mid + 1].first, key) > 0) {
-        ins_at = mid + 1;
-        break;
-      }
-      if (comp(array_[mid].first, key) < 0) {
-        i = mid + 1;
-      } else {
-        j = mid - 1;
-      }
-    }
-  }
-  //  while (ins_at < size && comp(array_[ins_at].first, key) < 0) {
-  //    ++ins_at;
-  //  }
-  // std::memmove(&array_[ins_at + 1], &array_[ins_at], (size - ins_at) * sizeof(array_[0]));
-  std::move_backward(&array_[ins_at], &array_[size], &array_[size + 1]);
-  //    for (int i = size; i > ins_at; --i) {
-  //      array_[i] = array_[i - 1];
-  //    }
+  int ins_at = LowerBound(key, comp, size);
+  // key和value分开存放，两个数组各自往后挪一格
+  std::move_backward(Keys() + ins_at, Keys() + size, Keys() + size + 1);
+  std::move_backward(Values() + ins_at, Values() + size, Values() + size + 1);
   IncreaseSize(1);
   SetKeyValueAt(ins_at, key, value);
 }
@@ -122,50 +111,32 @@ INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::MoveDataTo(B_PLUS_TREE_LEAF_PAGE_TYPE *new_page, int count) {
   int size = GetSize();
   int start_index = size - count;
-  for (int i = start_index, j = 0; i < size; ++i, ++j) {
-    new_page->SetKeyValueAt(j, array_[i].first, array_[i].second);
-  }
+  std::copy(Keys() + start_index, Keys() + size, new_page->Keys());
+  std::copy(Values() + start_index, Values() + size, new_page->Values());
   new_page->IncreaseSize(count);
   SetSize(size - count);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-auto B_PLUS_TREE_LEAF_PAGE_TYPE::LowerBound(const KeyType &key, const KeyComparator &comp) -> int {
-  int index = 0;
-  int size = GetSize();
-  while (index < size && comp(array_[index].first, key) < 0) {
-    ++index;
-  }
-  return index;
+auto B_PLUS_TREE_LEAF_PAGE_TYPE::LowerBound(const KeyType &key, const KeyComparator &comp, int size) const -> int {
+  return KeySearch::LowerBound(Keys(), size, key, comp);
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::Remove(const KeyType &key, const KeyComparator &comp) {
-  int index = 0;
   int size = GetSize();
-  while (index < size && comp(array_[index].first, key) < 0) {
-    ++index;
-  }
+  int index = LowerBound(key, comp, size);
   // 没找到的情况 直接返回  啥也不改变
-  if (index >= size || comp(array_[index].first, key) > 0) {
+  if (index >= size || comp(Keys()[index], key) > 0) {
     return;
   }
-
-  // std::memmove(&array_[index], &array_[index + 1], (size - index - 1) * sizeof(array_[0]));
-  std::move(&array_[index + 1], &array_[size], &array_[index]);
-  //    for (int i = index; i < size - 1; ++i) {
-  //      array_[i] = array_[i + 1];
-  //    }
-  DecreaseSize(1);
+  RemoveAt(index);
 }
 INDEX_TEMPLATE_ARGUMENTS
 void B_PLUS_TREE_LEAF_PAGE_TYPE::RemoveAt(int index) {
   int size = GetSize();
-  // std::memmove(&array_[index], &array_[index + 1], (size - index - 1) * sizeof(array_[0]));
-  std::move(&array_[index + 1], &array_[size], &array_[index]);
-  //    for (int i = index; i < size - 1; ++i) {
-  //      array_[i] = array_[i + 1];
-  //    }
+  std::move(Keys() + index + 1, Keys() + size, Keys() + index);
+  std::move(Values() + index + 1, Values() + size, Values() + index);
   DecreaseSize(1);
 }
 
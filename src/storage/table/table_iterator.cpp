@@ -11,15 +11,17 @@
 //===----------------------------------------------------------------------===//
 
 #include <cassert>
+#include <vector>
 
 #include "common/exception.h"
 #include "concurrency/transaction.h"
+#include "storage/page/page_guard.h"
 #include "storage/table/table_heap.h"
 
 namespace bustub {
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy)
+    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn), strategy_(strategy) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
     if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_)) {
       throw bustub::Exception("read non-existing tuple");
@@ -39,19 +41,20 @@ auto TableIterator::operator->() -> Tuple * {
 
 auto TableIterator::operator++() -> TableIterator & {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
-  BUSTUB_ENSURE(cur_page != nullptr, "BPM full");  // all pages are pinned
+  auto guard = buffer_pool_manager->FetchPageRead(tuple_->rid_.GetPageId(), strategy_);
+  BUSTUB_ENSURE(guard.IsValid(), "BPM full");  // all pages are pinned
 
-  cur_page->RLatch();
+  auto cur_page = guard.AsPage<TablePage>();
+  ReadAhead(cur_page->GetNextPageId());
   RID next_tuple_rid;
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  &next_tuple_rid)) {  // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
-      cur_page = next_page;
-      cur_page->RLatch();
+      // latch the next page before releasing the current one
+      auto next_guard = buffer_pool_manager->FetchPageRead(cur_page->GetNextPageId(), strategy_);
+      guard = std::move(next_guard);
+      cur_page = guard.AsPage<TablePage>();
+      ReadAhead(cur_page->GetNextPageId());
       if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
         break;
       }
@@ -63,17 +66,36 @@ auto TableIterator::operator++() -> TableIterator & {
     // DO NOT ACQUIRE READ LOCK twice in a single thread otherwise it may deadlock.
     // See https://users.rust-lang.org/t/how-bad-is-the-potential-deadlock-mentioned-in-rwlocks-document/67234
     if (!table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, false)) {
-      cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
       throw bustub::Exception("read non-existing tuple");
     }
   }
   // release until copy the tuple
-  cur_page->RUnlatch();
-  buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
   return *this;
 }
 
+void TableIterator::ReadAhead(page_id_t next_page_id) {
+  if (read_ahead_window == 0 || next_page_id == INVALID_PAGE_ID) {
+    return;
+  }
+  const auto window = static_cast<page_id_t>(read_ahead_window);
+  // 不在上一次的预读窗口里（扫描跳到了别处），重新开始一个窗口
+  if (next_page_id < read_ahead_start_ || next_page_id > read_ahead_end_) {
+    read_ahead_start_ = next_page_id;
+    read_ahead_end_ = next_page_id;
+  }
+  // 已经预读的部分还多于半个窗口，暂时不用推进
+  if (read_ahead_end_ - next_page_id > window / 2) {
+    return;
+  }
+  std::vector<page_id_t> page_ids;
+  for (page_id_t page_id = read_ahead_end_; page_id < next_page_id + window; page_id++) {
+    page_ids.push_back(page_id);
+  }
+  read_ahead_start_ = next_page_id;
+  read_ahead_end_ = next_page_id + window;
+  table_heap_->buffer_pool_manager_->PrefetchPages(page_ids, strategy_);
+}
+
 auto TableIterator::operator++(int) -> TableIterator {
   TableIterator clone(*this);
   ++(*this);
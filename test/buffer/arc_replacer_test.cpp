@@ -0,0 +1,61 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer_test.cpp
+//
+// Identification: test/buffer/arc_replacer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <stdexcept>
+#include <vector>
+
+#include "buffer/arc_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ArcReplacerTest, SampleTest) {
+  ArcReplacer replacer(4);
+
+  // Pages 100..103 in frames 0..3; 100 and 101 are accessed again and move to T2.
+  for (frame_id_t fid = 0; fid < 4; fid++) {
+    replacer.RecordAccess(fid, 100 + fid);
+  }
+  replacer.RecordAccess(0, 100);
+  replacer.RecordAccess(1, 101);
+  ASSERT_EQ(4, replacer.Size());
+  ASSERT_EQ(0, replacer.GetTargetT1Size());
+
+  // T1 is larger than its target size 0, so the least recently used frame of T1 goes to B1.
+  int value;
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+
+  // Page 102 is read back while it is in B1: T1 should have been larger, and the page goes to T2.
+  replacer.RecordAccess(2, 102);
+  ASSERT_EQ(1, replacer.GetTargetT1Size());
+  ASSERT_EQ(std::vector<frame_id_t>({0, 1, 2, 3}), replacer.EvictionCandidates(4));
+
+  // T1 = {3} is not larger than its target any more, so T2 is evicted from, into B2.
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+
+  // Page 100 is read back while it is in B2: the target size of T1 shrinks again.
+  replacer.RecordAccess(0, 100);
+  ASSERT_EQ(0, replacer.GetTargetT1Size());
+
+  // Pinned frames are skipped and removed frames are not remembered.
+  replacer.SetEvictable(3, false);
+  ASSERT_EQ(3, replacer.Size());
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+  replacer.Remove(2);
+  ASSERT_EQ(1, replacer.Size());
+  ASSERT_THROW(replacer.Remove(3), std::logic_error);
+}
+
+}  // namespace bustub
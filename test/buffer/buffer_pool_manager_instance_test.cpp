@@ -12,12 +12,24 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "common/exception.h"
 #include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_memory.h"
 
 namespace bustub {
 
@@ -145,4 +157,738 @@ TEST(BufferPoolManagerInstanceTest, SampleTest) {
   delete disk_manager;
 }
 
+/** A disk manager whose reads of one chosen page block until the test releases them. */
+class BlockingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    if (page_id == blocked_page_id_) {
+      reads_of_blocked_page_++;
+      entered_.set_value();
+      release_.wait();
+    }
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  page_id_t blocked_page_id_{INVALID_PAGE_ID};
+  std::atomic<int> reads_of_blocked_page_{0};
+  std::promise<void> entered_;
+  std::shared_future<void> release_;
+};
+
+// NOLINTNEXTLINE
+// A slow read must not block cache hits, and concurrent misses on the same page must share a single read.
+TEST(BufferPoolManagerInstanceTest, IoOutsideLatchTest) {
+  const size_t buffer_pool_size = 4;
+  const size_t k = 2;
+
+  auto *disk_manager = new BlockingDiskManager();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size + 2; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  // Pages 0 and 1 have been evicted, pages 2..5 are resident.
+
+  std::promise<void> release;
+  disk_manager->release_ = release.get_future().share();
+  disk_manager->blocked_page_id_ = 0;
+
+  auto fetch_page0 = [bpm] {
+    auto *page = bpm->FetchPage(0);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, strcmp(page->GetData(), "page0"));
+    EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  };
+  std::thread reader1(fetch_page0);
+  disk_manager->entered_.get_future().wait();
+  std::thread reader2(fetch_page0);
+
+  // The read of page 0 is stuck on disk, but hits on other pages still go through.
+  auto *page5 = bpm->FetchPage(5);
+  ASSERT_NE(nullptr, page5);
+  EXPECT_EQ(0, strcmp(page5->GetData(), "page5"));
+  EXPECT_EQ(true, bpm->UnpinPage(5, false));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  release.set_value();
+  reader1.join();
+  reader2.join();
+  EXPECT_EQ(1, disk_manager->reads_of_blocked_page_);
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// The page cleaner writes back cold dirty frames so that evictions don't have to.
+TEST(BufferPoolManagerInstanceTest, PageCleanerTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  bpm->RunPageCleanerThread(std::chrono::milliseconds(10), 1.0);
+  for (int i = 0; i < 200 && bpm->GetBackgroundCleanedPages() < buffer_pool_size; i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  bpm->StopPageCleanerThread();
+  EXPECT_EQ(buffer_pool_size, bpm->GetBackgroundCleanedPages());
+
+  // Every frame is clean now, so replacing all of them does not write anything on the foreground path.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(0, bpm->GetForegroundCleanedPages());
+
+  // The contents written by the cleaner come back intact.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::string("page") + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Without the cleaner, evicting the dirty pages again has to write them back in the foreground.
+  for (size_t i = 0; i < buffer_pool_size; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  EXPECT_EQ(buffer_pool_size, bpm->GetForegroundCleanedPages());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Hits go through the lock-free page table while other threads keep evicting frames; every fetch must see its page.
+TEST(BufferPoolManagerInstanceTest, ConcurrentHitAndEvictTest) {
+  const size_t buffer_pool_size = 16;
+  const size_t num_pages = 48;
+  const size_t num_threads = 8;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < num_pages; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([bpm, tid] {
+      std::mt19937 gen(tid);
+      // half of the threads hammer a small hot set, the other half scan everything and force evictions
+      std::uniform_int_distribution<page_id_t> dis(0, tid % 2 == 0 ? 3 : num_pages - 1);
+      for (int i = 0; i < 2000; i++) {
+        page_id_t page_id = dis(gen);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        EXPECT_EQ(page_id, page->GetPageId());
+        page->RLatch();
+        EXPECT_EQ(std::string("page") + std::to_string(page_id), std::string(page->GetData()));
+        page->RUnlatch();
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/** A disk manager that counts the reads of every page. */
+class CountingDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    {
+      std::scoped_lock<std::mutex> lock(mutex_);
+      reads_[page_id]++;
+    }
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  void ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) override {
+    batch_reads_++;
+    DiskManagerUnlimitedMemory::ReadPages(page_ids, page_data);
+  }
+
+  auto GetReads(page_id_t page_id) -> int {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    return reads_[page_id];
+  }
+
+  auto GetBatchReads() -> int { return batch_reads_; }
+
+ private:
+  std::mutex mutex_;
+  std::unordered_map<page_id_t, int> reads_;
+  std::atomic<int> batch_reads_{0};
+};
+
+// NOLINTNEXTLINE
+// Prefetched pages are read in the background, once, and later fetches hit.
+TEST(BufferPoolManagerInstanceTest, PrefetchTest) {
+  const size_t buffer_pool_size = 16;
+  const size_t k = 2;
+
+  auto *disk_manager = new CountingDiskManager();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < 2 * buffer_pool_size; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  // Pages 0..15 have been evicted.
+
+  // Unallocated and resident pages are ignored.
+  bpm->PrefetchPages({0, 1, 2, 3, 20, 1000});
+  for (int i = 0; i < 200; i++) {
+    if (disk_manager->GetReads(0) + disk_manager->GetReads(1) + disk_manager->GetReads(2) + disk_manager->GetReads(3) ==
+        4) {
+      break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  for (page_id_t page_id = 0; page_id < 4; page_id++) {
+    EXPECT_EQ(1, disk_manager->GetReads(page_id));
+  }
+  EXPECT_EQ(0, disk_manager->GetReads(20));
+  EXPECT_EQ(0, disk_manager->GetReads(1000));
+
+  for (page_id_t page_id = 0; page_id < 4; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::string("page") + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    EXPECT_EQ(1, disk_manager->GetReads(page_id));
+  }
+
+  // Fetching pages right after prefetching them never reads a page twice, whoever gets there first.
+  std::vector<page_id_t> page_ids;
+  for (page_id_t page_id = 4; page_id < 12; page_id++) {
+    page_ids.push_back(page_id);
+  }
+  bpm->PrefetchPages(page_ids);
+  for (auto page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::string("page") + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  delete bpm;
+  for (auto page_id : page_ids) {
+    EXPECT_EQ(1, disk_manager->GetReads(page_id));
+  }
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// A large scan with a BufferAccessStrategy only recycles the frames of its own ring and leaves the other pages alone.
+TEST(BufferPoolManagerInstanceTest, AccessStrategyTest) {
+  const size_t buffer_pool_size = 32;
+  const size_t k = 2;
+  const size_t ring_size = 4;
+
+  auto *disk_manager = new CountingDiskManager();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < 4 * buffer_pool_size; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  auto fetch_and_unpin = [&](page_id_t page_id, BufferAccessStrategy *strategy) {
+    auto *page = bpm->FetchPageWithStrategy(page_id, strategy);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::string("page") + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  };
+  // Pages 0..7 are hot and pages 8..15 are warm, they have been accessed only once.
+  for (int i = 0; i < 3; i++) {
+    for (page_id_t page_id = 0; page_id < 8; page_id++) {
+      fetch_and_unpin(page_id, nullptr);
+    }
+  }
+  for (page_id_t page_id = 8; page_id < 16; page_id++) {
+    fetch_and_unpin(page_id, nullptr);
+  }
+
+  // Scan all the other pages, four times as many as the pool holds.
+  BufferAccessStrategy strategy(ring_size);
+  for (auto page_id = 16; page_id < static_cast<page_id_t>(4 * buffer_pool_size); page_id++) {
+    fetch_and_unpin(page_id, &strategy);
+  }
+  for (page_id_t page_id = 0; page_id < 16; page_id++) {
+    fetch_and_unpin(page_id, nullptr);
+    EXPECT_EQ(1, disk_manager->GetReads(page_id));
+  }
+
+  // Read-ahead on behalf of the scan takes its frames from the ring as well.
+  for (auto page_id = 16; page_id < static_cast<page_id_t>(4 * buffer_pool_size); page_id += ring_size) {
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < ring_size; i++) {
+      page_ids.push_back(page_id + static_cast<page_id_t>(i));
+    }
+    bpm->PrefetchPages(page_ids, &strategy);
+    for (auto id : page_ids) {
+      fetch_and_unpin(id, &strategy);
+    }
+  }
+  for (page_id_t page_id = 0; page_id < 16; page_id++) {
+    fetch_and_unpin(page_id, nullptr);
+    EXPECT_EQ(1, disk_manager->GetReads(page_id));
+  }
+  EXPECT_EQ(2, disk_manager->GetReads(64));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Every replacement policy keeps the buffer pool correct under a random workload that does not fit in the pool.
+TEST(BufferPoolManagerInstanceTest, ReplacerTypeTest) {
+  const size_t buffer_pool_size = 10;
+  const size_t page_cnt = 50;
+
+  for (auto replacer_type :
+       {ReplacerType::LRU_K, ReplacerType::LRU, ReplacerType::CLOCK, ReplacerType::TWO_Q, ReplacerType::ARC}) {
+    auto *disk_manager = new DiskManagerUnlimitedMemory();
+    auto *bpm =
+        new BufferPoolManagerInstance(buffer_pool_size, disk_manager, LRUK_REPLACER_K, nullptr, replacer_type);
+
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < page_cnt; i++) {
+      auto *page = bpm->NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page%d", page_id_temp);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<page_id_t> dist(0, page_cnt - 1);
+    for (int i = 0; i < 1000; i++) {
+      // skew the accesses towards the first pages so that the policies have something to keep
+      page_id_t page_id = i % 2 == 0 ? dist(gen) % 5 : dist(gen);
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(std::string("page") + std::to_string(page_id), std::string(page->GetData()));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+
+    // Once every frame is pinned nothing can be evicted.
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    }
+    EXPECT_EQ(nullptr, bpm->FetchPage(static_cast<page_id_t>(buffer_pool_size)));
+    EXPECT_EQ(true, bpm->DeletePage(page_cnt - 1));
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// The frame data lives in the arena whatever huge page mode is asked for, and the metadata does not share cache lines.
+TEST(BufferPoolManagerInstanceTest, FrameArenaTest) {
+  const size_t buffer_pool_size = 16;
+  EXPECT_EQ(0, sizeof(Page) % 64);
+
+  for (auto mode : {HugePageMode::NONE, HugePageMode::TRANSPARENT, HugePageMode::EXPLICIT}) {
+    buffer_pool_huge_pages = mode;
+    auto *disk_manager = new DiskManagerUnlimitedMemory();
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+    buffer_pool_huge_pages = HugePageMode::TRANSPARENT;
+    // an explicit mapping may fall back to transparent huge pages, never the other way round
+    EXPECT_LE(static_cast<int>(bpm->GetFrameArena()->GetHugePageMode()), static_cast<int>(mode));
+
+    page_id_t page_id_temp;
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+      auto *page = bpm->NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      auto frame_id = static_cast<frame_id_t>(page - bpm->GetPages());
+      EXPECT_EQ(bpm->GetFrameArena()->GetFrameData(frame_id), page->GetData());
+      EXPECT_EQ(0, reinterpret_cast<uintptr_t>(page) % 64);
+      snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page%d", page_id_temp);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+    // evict everything and read it back through the arena
+    for (size_t i = 0; i < buffer_pool_size; i++) {
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+    }
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); page_id++) {
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(std::string("page") + std::to_string(page_id), std::string(page->GetData()));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+TEST(BufferPoolManagerInstanceTest, StatsTest) {
+  const size_t buffer_pool_size = 4;
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size * 2; i++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(buffer_pool_size, stats.pool_size_);
+  EXPECT_EQ(buffer_pool_size, stats.evictions_);
+  EXPECT_EQ(buffer_pool_size, stats.dirty_writes_);
+  EXPECT_EQ(0, stats.hits_ + stats.misses_);
+
+  // pages 4..7 are resident, pages 0..3 were evicted
+  ObjectAccessStats object_stats;
+  {
+    AccessStatsScope scope(&object_stats);
+    // the resident pages first, so that reading the evicted ones back does not evict them before they are fetched
+    for (size_t i = 0; i < buffer_pool_size * 2; i++) {
+      auto page_id = static_cast<page_id_t>((i + buffer_pool_size) % (buffer_pool_size * 2));
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+  }
+  // pages 0..3 are resident now
+  ASSERT_NE(nullptr, bpm->FetchPage(buffer_pool_size - 1));
+  stats = bpm->GetStats();
+  EXPECT_EQ(buffer_pool_size, stats.misses_);
+  EXPECT_EQ(buffer_pool_size + 1, stats.hits_);
+  EXPECT_EQ(buffer_pool_size, object_stats.misses_);
+  EXPECT_EQ(buffer_pool_size, object_stats.hits_);
+  EXPECT_EQ(buffer_pool_size, disk_manager->GetNumReads());
+
+  // every frame pinned
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size) - 1; page_id++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(1, bpm->GetStats().failed_fetches_);
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// FetchPages pins hits and misses alike, reads a run of adjacent missing pages in one batch and pins duplicates once per
+// occurrence.
+TEST(BufferPoolManagerInstanceTest, FetchPagesTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t k = 2;
+
+  auto *disk_manager = new CountingDiskManager();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < 2 * buffer_pool_size; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  // Pages 0..7 have been evicted, pages 8..15 are resident.
+
+  std::vector<page_id_t> page_ids{10, 3, 1, 3, 12, 4};
+  auto pages = bpm->FetchPages(page_ids);
+  ASSERT_EQ(page_ids.size(), pages.size());
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(page_ids[i], pages[i]->GetPageId());
+    EXPECT_EQ(std::string("page") + std::to_string(page_ids[i]), std::string(pages[i]->GetData()));
+  }
+  EXPECT_EQ(pages[1], pages[3]);
+  EXPECT_EQ(2, pages[1]->GetPinCount());
+  EXPECT_EQ(1, pages[0]->GetPinCount());
+  EXPECT_EQ(1, disk_manager->GetBatchReads());
+  EXPECT_EQ(1, disk_manager->GetReads(1));
+  EXPECT_EQ(1, disk_manager->GetReads(3));
+  EXPECT_EQ(1, disk_manager->GetReads(4));
+  EXPECT_EQ(0, disk_manager->GetReads(10));
+
+  bpm->UnpinPages(page_ids, false);
+  for (auto *page : pages) {
+    EXPECT_EQ(0, page->GetPinCount());
+  }
+
+  // A batch larger than the pool gets nullptr for the pages that do not fit, and the pages it got stay usable.
+  std::vector<page_id_t> all_page_ids;
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(2 * buffer_pool_size); page_id++) {
+    all_page_ids.push_back(page_id);
+  }
+  pages = bpm->FetchPages(all_page_ids);
+  std::vector<page_id_t> fetched_page_ids;
+  for (size_t i = 0; i < pages.size(); i++) {
+    if (pages[i] != nullptr) {
+      EXPECT_EQ(all_page_ids[i], pages[i]->GetPageId());
+      fetched_page_ids.push_back(all_page_ids[i]);
+    }
+  }
+  EXPECT_EQ(buffer_pool_size, fetched_page_ids.size());
+  bpm->UnpinPages(fetched_page_ids, false);
+  EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Only dirty pages are tracked and flushed, and flushing cleans them.
+TEST(BufferPoolManagerInstanceTest, DirtyPageTableTest) {
+  const size_t buffer_pool_size = 8;
+  const size_t k = 2;
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < 6; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    // pages 3 and 5 stay clean
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, page_id_temp != 3 && page_id_temp != 5));
+  }
+  auto dirty_page_table = bpm->GetDirtyPageTable();
+  std::vector<page_id_t> dirty_page_ids;
+  for (const auto &[page_id, rec_lsn] : dirty_page_table) {
+    dirty_page_ids.push_back(page_id);
+  }
+  EXPECT_EQ((std::vector<page_id_t>{0, 1, 2, 4}), dirty_page_ids);
+
+  // dirtying a page again keeps the LSN it was first dirtied at
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  page->SetLSN(42);
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  EXPECT_EQ(dirty_page_table[0], bpm->GetDirtyPageTable()[0]);
+
+  bpm->FlushAllPages();
+  EXPECT_EQ(4, disk_manager->GetNumWrites());
+  EXPECT_TRUE(bpm->GetDirtyPageTable().empty());
+  bpm->FlushAllPages();
+  EXPECT_EQ(4, disk_manager->GetNumWrites());
+
+  // a flushed page that is dirtied again is tracked with its current LSN
+  page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_FALSE(page->IsDirty());
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  EXPECT_EQ(42, bpm->GetDirtyPageTable()[0]);
+  EXPECT_EQ(true, bpm->FlushPage(0));
+  EXPECT_TRUE(bpm->GetDirtyPageTable().empty());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Deleted pages are handed out again before the file grows, and the page allocation survives a restart.
+TEST(BufferPoolManagerInstanceTest, PageReuseTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t k = 2;
+  remove(db_name.c_str());
+  page_checksums = true;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+
+  page_id_t page_id_temp;
+  for (page_id_t page_id = 0; page_id < 8; page_id++) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(page_id, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  // page 6 is resident, page 1 has been evicted
+  EXPECT_EQ(true, bpm->DeletePage(6));
+  EXPECT_EQ(true, bpm->DeletePage(1));
+  EXPECT_EQ(2U, disk_manager->GetFreeSpaceMap()->GetFreePageCount());
+
+  // a pinned page cannot be deleted and stays allocated
+  ASSERT_NE(nullptr, bpm->FetchPage(3));
+  EXPECT_EQ(false, bpm->DeletePage(3));
+  EXPECT_EQ(true, bpm->UnpinPage(3, false));
+  EXPECT_EQ(false, disk_manager->GetFreeSpaceMap()->IsFree(3));
+
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(1, page_id_temp);
+  EXPECT_EQ(0, bpm->FetchPage(1)->GetData()[0]);
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+  EXPECT_EQ(true, bpm->UnpinPage(1, true));
+  EXPECT_EQ(true, bpm->DeletePage(4));
+
+  // the free page 4 and the high-water mark 8 are saved with the flush and picked up by the next instance
+  bpm->FlushAllPages();
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  disk_manager = new DiskManager(db_name);
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+  EXPECT_EQ(8, disk_manager->GetFreeSpaceMap()->GetNextPageId());
+  for (page_id_t page_id : {4, 6, 8}) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(page_id, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove(db_name.c_str());
+  remove("test.fsm");
+}
+
+// NOLINTNEXTLINE
+// Tables and indexes that grow at the same time still get contiguous page ids from extents of their own.
+TEST(BufferPoolManagerInstanceTest, ExtentAllocationTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const size_t k = 2;
+  remove(db_name.c_str());
+  page_checksums = true;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+  ExtentAllocator table_extent(8);
+  ExtentAllocator index_extent(8);
+
+  // interleaved inserts: the extents grow 1, 2, 4, 8, 8 pages
+  page_id_t page_id_temp;
+  std::vector<page_id_t> table_page_ids;
+  std::vector<page_id_t> index_page_ids;
+  for (int i = 0; i < 20; i++) {
+    ASSERT_NE(nullptr, bpm->NewPageInExtent(&page_id_temp, &table_extent));
+    table_page_ids.push_back(page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    ASSERT_NE(nullptr, bpm->NewPageInExtent(&page_id_temp, &index_extent));
+    index_page_ids.push_back(page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  EXPECT_EQ(5U, table_extent.GetExtentCount());
+  EXPECT_EQ(5U, index_extent.GetExtentCount());
+  EXPECT_EQ(std::vector<page_id_t>({0, 2, 3, 6, 7, 8, 9, 14, 15, 16, 17, 18, 19, 20, 21, 30, 31, 32, 33, 34}),
+            table_page_ids);
+  EXPECT_EQ(std::vector<page_id_t>({1, 4, 5, 10, 11, 12, 13, 22, 23, 24, 25, 26, 27, 28, 29, 38, 39, 40, 41, 42}),
+            index_page_ids);
+
+  // pages without an extent do not take ids from the reserved extents
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(46, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+
+  // a new extent is carved from a run of deleted pages that is long enough
+  for (page_id_t page_id = 10; page_id < 14; page_id++) {
+    EXPECT_EQ(true, bpm->DeletePage(page_id));
+  }
+  EXPECT_EQ(true, bpm->DeletePage(2));
+  ExtentAllocator other_extent(8);
+  ASSERT_NE(nullptr, bpm->NewPageInExtent(&page_id_temp, &other_extent));
+  EXPECT_EQ(2, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  ASSERT_NE(nullptr, bpm->NewPageInExtent(&page_id_temp, &other_extent));
+  EXPECT_EQ(10, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  EXPECT_EQ(2U, disk_manager->GetFreeSpaceMap()->GetFreePageCount());
+
+  // the unused rest of the extents, 35-37, 43-45 and 11, is taken back when the database shuts down
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  disk_manager = new DiskManager(db_name);
+  EXPECT_EQ(9U, disk_manager->GetFreeSpaceMap()->GetFreePageCount());
+  EXPECT_EQ(true, disk_manager->GetFreeSpaceMap()->IsFree(11));
+  EXPECT_EQ(true, disk_manager->GetFreeSpaceMap()->IsFree(45));
+  // an owner that goes on allocating gets a new extent, of 4 pages past the high-water mark
+  EXPECT_EQ(47, other_extent.Allocate(disk_manager->GetFreeSpaceMap()));
+  EXPECT_EQ(3U, other_extent.GetExtentCount());
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove(db_name.c_str());
+  remove("test.fsm");
+}
+
+// NOLINTNEXTLINE
+// A page that fails its checksum is reported to the caller, and its frame goes back to the pool.
+TEST(BufferPoolManagerInstanceTest, CorruptedPageTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+  const size_t k = 2;
+  remove(db_name.c_str());
+  page_checksums = true;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, k);
+  page_id_t page_id_temp;
+  for (int i = 0; i < 4; i++) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "page%d", page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // page 0 has been evicted, damage it on disk
+  int fd = open(db_name.c_str(), O_RDWR);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(1, pwrite(fd, "X", 1, 100));
+  close(fd);
+
+  for (int i = 0; i < 2; i++) {
+    EXPECT_THROW(bpm->FetchPage(0), Exception);
+    EXPECT_THROW(bpm->FetchPages({1, 0}), Exception);
+  }
+  // no frame is left behind pinned or reserved
+  auto *page1 = bpm->FetchPage(1);
+  auto *page2 = bpm->FetchPage(2);
+  ASSERT_NE(nullptr, page1);
+  ASSERT_NE(nullptr, page2);
+  EXPECT_STREQ("page1", page1->GetData());
+  EXPECT_STREQ("page2", page2->GetData());
+  EXPECT_EQ(1, page1->GetPinCount());
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+  EXPECT_EQ(true, bpm->UnpinPage(2, false));
+
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove(db_name.c_str());
+  remove("test.fsm");
+  remove("test.crc");
+  page_checksums = false;
+}
+
 }  // namespace bustub
@@ -9,6 +9,7 @@
 #include <memory>
 #include <random>
 #include <set>
+#include <stdexcept>
 #include <thread>  // NOLINT
 #include <vector>
 
@@ -97,4 +98,78 @@ TEST(LRUKReplacerTest, SampleTest) {
   lru_replacer.Remove(1);
   ASSERT_EQ(0, lru_replacer.Size());
 }
+
+TEST(LRUKReplacerTest, EvictionCandidatesTest) {
+  LRUKReplacer lru_replacer(7, 2);
+
+  for (frame_id_t fid = 1; fid <= 5; fid++) {
+    lru_replacer.RecordAccess(fid);
+    lru_replacer.SetEvictable(fid, true);
+  }
+  lru_replacer.RecordAccess(1);
+  lru_replacer.SetEvictable(3, false);
+
+  // Candidates follow the eviction order [2,4,5,1] and skip non-evictable frames, without evicting anything.
+  ASSERT_EQ(std::vector<frame_id_t>({2, 4, 5, 1}), lru_replacer.EvictionCandidates(7));
+  ASSERT_EQ(std::vector<frame_id_t>({2, 4}), lru_replacer.EvictionCandidates(2));
+  ASSERT_EQ(4, lru_replacer.Size());
+
+  int value;
+  ASSERT_EQ(true, lru_replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+}
+
+TEST(LRUKReplacerTest, BackwardKDistanceTest) {
+  LRUKReplacer lru_replacer(7, 2);
+
+  // Frame 1 is accessed at t0, t1 and t4, frame 2 at t2 and t3. Frame 1 was accessed last, but its second most recent
+  // access (t1) is older than the one of frame 2 (t2), so frame 1 has the larger backward 2-distance.
+  lru_replacer.RecordAccess(1);
+  lru_replacer.RecordAccess(1);
+  lru_replacer.RecordAccess(2);
+  lru_replacer.RecordAccess(2);
+  lru_replacer.RecordAccess(1);
+  ASSERT_EQ(std::vector<frame_id_t>({1, 2}), lru_replacer.EvictionCandidates(7));
+
+  // A frame that is pinned and unpinned again keeps its place: frame 3 was accessed before frame 4.
+  lru_replacer.RecordAccess(3);
+  lru_replacer.RecordAccess(4);
+  lru_replacer.SetEvictable(3, false);
+  lru_replacer.SetEvictable(3, true);
+  ASSERT_EQ(std::vector<frame_id_t>({3, 4, 1, 2}), lru_replacer.EvictionCandidates(7));
+
+  // Frames reaching k accesses while pinned are ordered by their k-th last access once they are unpinned.
+  lru_replacer.SetEvictable(4, false);
+  lru_replacer.RecordAccess(4);
+  lru_replacer.SetEvictable(4, true);
+  ASSERT_EQ(std::vector<frame_id_t>({3, 1, 2, 4}), lru_replacer.EvictionCandidates(7));
+
+  int value;
+  for (frame_id_t expected : {3, 1, 2, 4}) {
+    ASSERT_EQ(true, lru_replacer.Evict(&value));
+    ASSERT_EQ(expected, value);
+  }
+  ASSERT_EQ(false, lru_replacer.Evict(&value));
+  ASSERT_THROW(lru_replacer.RecordAccess(7), std::invalid_argument);
+}
+
+TEST(LRUKReplacerTest, MostlyPinnedTest) {
+  const size_t num_frames = 100000;
+  LRUKReplacer lru_replacer(num_frames, 3);
+
+  // Only every 1000th frame is evictable; they come out in the order of their first access.
+  for (size_t i = 0; i < num_frames; i++) {
+    auto frame_id = static_cast<frame_id_t>(num_frames - 1 - i);
+    lru_replacer.RecordAccess(frame_id);
+    lru_replacer.SetEvictable(frame_id, frame_id % 1000 == 0);
+  }
+  ASSERT_EQ(num_frames / 1000, lru_replacer.Size());
+  int value;
+  for (auto expected = static_cast<frame_id_t>(num_frames - 1000); expected >= 0; expected -= 1000) {
+    ASSERT_EQ(true, lru_replacer.Evict(&value));
+    ASSERT_EQ(expected, value);
+  }
+  ASSERT_EQ(false, lru_replacer.Evict(&value));
+  ASSERT_EQ(0, lru_replacer.Size());
+}
 }  // namespace bustub
@@ -0,0 +1,123 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+#include <atomic>
+#include <random>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, SampleTest) {
+  PageTable page_table(8);
+  frame_id_t frame_id;
+
+  for (page_id_t page_id = 0; page_id < 16; page_id++) {
+    page_table.Insert(page_id, page_id % 8);
+  }
+  for (page_id_t page_id = 0; page_id < 16; page_id++) {
+    ASSERT_TRUE(page_table.Find(page_id, frame_id));
+    EXPECT_EQ(page_id % 8, frame_id);
+  }
+  EXPECT_FALSE(page_table.Find(16, frame_id));
+
+  // Insert overwrites an existing mapping.
+  page_table.Insert(3, 7);
+  ASSERT_TRUE(page_table.Find(3, frame_id));
+  EXPECT_EQ(7, frame_id);
+
+  for (page_id_t page_id = 0; page_id < 16; page_id += 2) {
+    EXPECT_TRUE(page_table.Remove(page_id));
+  }
+  EXPECT_FALSE(page_table.Remove(0));
+  for (page_id_t page_id = 0; page_id < 16; page_id++) {
+    EXPECT_EQ(page_id % 2 == 1, page_table.Find(page_id, frame_id));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, RandomTest) {
+  const size_t num_frames = 64;
+  PageTable page_table(num_frames);
+  std::unordered_map<page_id_t, frame_id_t> expected;
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<page_id_t> page_dis(0, 1000);
+  frame_id_t frame_id;
+
+  // Keep at most 2 * num_frames entries, as a buffer pool does, while churning through inserts and removes.
+  for (int i = 0; i < 100000; i++) {
+    page_id_t page_id = page_dis(gen);
+    if (expected.count(page_id) == 1) {
+      EXPECT_TRUE(page_table.Remove(page_id));
+      expected.erase(page_id);
+    } else if (expected.size() < 2 * num_frames) {
+      page_table.Insert(page_id, i % num_frames);
+      expected[page_id] = i % num_frames;
+    }
+  }
+  for (page_id_t page_id = 0; page_id <= 1000; page_id++) {
+    auto it = expected.find(page_id);
+    ASSERT_EQ(it != expected.end(), page_table.Find(page_id, frame_id));
+    if (it != expected.end()) {
+      EXPECT_EQ(it->second, frame_id);
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, ConcurrentReadTest) {
+  const size_t num_frames = 32;
+  PageTable page_table(num_frames);
+  // Pages 0..num_frames-1 are never removed; page p always maps to frame p.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_frames); page_id++) {
+    page_table.Insert(page_id, page_id);
+  }
+
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < 4; tid++) {
+    readers.emplace_back([&page_table, &stop] {
+      frame_id_t frame_id;
+      while (!stop) {
+        for (page_id_t page_id = 0; page_id < 2 * static_cast<page_id_t>(num_frames); page_id++) {
+          // A lock-free Find may miss, but whatever it returns must be a mapping that was inserted.
+          if (page_table.Find(page_id, frame_id)) {
+            EXPECT_EQ(page_id % static_cast<page_id_t>(num_frames), frame_id);
+          }
+        }
+      }
+    });
+  }
+
+  // The single writer churns pages num_frames..2*num_frames-1, which map to frame page_id - num_frames.
+  for (int round = 0; round < 2000; round++) {
+    for (page_id_t page_id = num_frames; page_id < 2 * static_cast<page_id_t>(num_frames); page_id++) {
+      if (round % 2 == 0) {
+        page_table.Insert(page_id, page_id - num_frames);
+      } else {
+        page_table.Remove(page_id);
+      }
+    }
+  }
+  stop = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,209 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+
+#include <cstdio>
+#include <algorithm>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 5;
+  const size_t num_instances = 5;
+  const size_t k = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, k);
+  EXPECT_EQ(buffer_pool_size * num_instances, bpm->GetPoolSize());
+
+  // New pages are spread round-robin over the instances and every page id routes back to its owner.
+  page_id_t page_id_temp;
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < buffer_pool_size * num_instances; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id_temp);
+    page_ids.push_back(page_id_temp);
+  }
+
+  // Page ids are unique across the instances.
+  std::vector<page_id_t> sorted_ids = page_ids;
+  std::sort(sorted_ids.begin(), sorted_ids.end());
+  EXPECT_EQ(sorted_ids.end(), std::adjacent_find(sorted_ids.begin(), sorted_ids.end()));
+
+  // All frames of all instances are pinned now.
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Unpinning pages in a single instance frees room only in that instance; NewPage must still find it.
+  for (auto page_id : page_ids) {
+    if (static_cast<size_t>(page_id) % num_instances == 2) {
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    }
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(2, page_id_temp % static_cast<page_id_t>(num_instances));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Evicted pages come back from disk with their content intact.
+  for (auto page_id : page_ids) {
+    if (static_cast<size_t>(page_id) % num_instances != 2) {
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    }
+  }
+  for (auto page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  EXPECT_EQ(true, bpm->DeletePage(page_ids[0]));
+  bpm->FlushAllPages();
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ConcurrencyTest) {
+  const std::string db_name = "test.db";
+  const size_t num_threads = 8;
+  const size_t buffer_pool_size = 16;
+  const size_t num_instances = 4;
+  const size_t pages_per_thread = 32;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([bpm] {
+      std::vector<page_id_t> page_ids;
+      for (size_t i = 0; i < pages_per_thread; i++) {
+        page_id_t page_id;
+        auto *page = bpm->NewPage(&page_id);
+        ASSERT_NE(nullptr, page);
+        snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+        page_ids.push_back(page_id);
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+      }
+      for (auto page_id : page_ids) {
+        auto *page = bpm->FetchPage(page_id);
+        ASSERT_NE(nullptr, page);
+        page->RLatch();
+        EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+        page->RUnlatch();
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+// FetchPages on a parallel pool returns the pages in the order asked for, whichever instance and disk read served them.
+TEST(ParallelBufferPoolManagerTest, FetchPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t num_instances = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+
+  std::vector<page_id_t> page_ids;
+  for (size_t i = 0; i < 4 * buffer_pool_size; i++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    page_ids.push_back(page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // the oldest pages were evicted to disk, so this mixes misses and hits of both instances
+  std::vector<page_id_t> batch{page_ids[14], page_ids[0], page_ids[5], page_ids[1], page_ids[0]};
+  auto pages = bpm->FetchPages(batch);
+  ASSERT_EQ(batch.size(), pages.size());
+  for (size_t i = 0; i < batch.size(); i++) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(batch[i], pages[i]->GetPageId());
+    EXPECT_EQ(std::to_string(batch[i]), std::string(pages[i]->GetData()));
+  }
+  EXPECT_EQ(2, pages[1]->GetPinCount());
+  bpm->UnpinPages(batch, false);
+  EXPECT_EQ(0, pages[1]->GetPinCount());
+
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+}
+
+// NOLINTNEXTLINE
+// The contiguous pages of an extent are created in the instances responsible for them.
+TEST(ParallelBufferPoolManagerTest, ExtentAllocationTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t num_instances = 3;
+  remove(db_name.c_str());
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  ExtentAllocator extent(4);
+
+  for (page_id_t expected = 0; expected < 10; expected++) {
+    page_id_t page_id;
+    auto *page = bpm->NewPageInExtent(&page_id, &extent);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(expected, page_id);
+    EXPECT_EQ(page_id, page->GetPageId());
+    snprintf(page->GetData(), BUSTUB_PAGE_SIZE, "%d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  for (page_id_t page_id = 0; page_id < 10; page_id++) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // ordinary new pages go past the extents, into the instances in turn
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_GE(page_id, 11);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+
+  delete bpm;
+  delete disk_manager;
+  remove(db_name.c_str());
+  remove("test.fsm");
+}
+
+}  // namespace bustub
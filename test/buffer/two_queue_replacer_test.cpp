@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// two_queue_replacer_test.cpp
+//
+// Identification: test/buffer/two_queue_replacer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <vector>
+
+#include "buffer/two_queue_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(TwoQueueReplacerTest, SampleTest) {
+  // 8 frames: A1in holds 2 frames before it is evicted from, A1out remembers 4 pages.
+  TwoQueueReplacer replacer(8);
+
+  // Pages 100..103 are read into frames 0..3. Repeated accesses in A1in do not move a frame.
+  for (frame_id_t fid = 0; fid < 4; fid++) {
+    replacer.RecordAccess(fid, 100 + fid);
+  }
+  replacer.RecordAccess(0, 100);
+  ASSERT_EQ(4, replacer.Size());
+  ASSERT_EQ(std::vector<frame_id_t>({0, 1, 2, 3}), replacer.EvictionCandidates(8));
+
+  // A1in is over its target size, so its oldest frame goes and page 100 is remembered in A1out.
+  int value;
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+
+  // Page 100 comes back in frame 0 and goes to Am. A1in is still larger than its target size.
+  replacer.RecordAccess(0, 100);
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(1, value);
+
+  // A1in is down to its target size, so Am is evicted from first now.
+  ASSERT_EQ(std::vector<frame_id_t>({0, 2, 3}), replacer.EvictionCandidates(8));
+
+  // A pinned frame is skipped.
+  replacer.SetEvictable(0, false);
+  ASSERT_EQ(2, replacer.Size());
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(2, value);
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(3, value);
+  ASSERT_EQ(false, replacer.Evict(&value));
+  replacer.SetEvictable(0, true);
+  ASSERT_EQ(true, replacer.Evict(&value));
+  ASSERT_EQ(0, value);
+  ASSERT_EQ(0, replacer.Size());
+
+  // Removed pages are not remembered: page 105 starts over in A1in.
+  replacer.RecordAccess(5, 105);
+  replacer.Remove(5);
+  replacer.RecordAccess(5, 105);
+  replacer.RecordAccess(6, 106);
+  replacer.RecordAccess(7, 107);
+  ASSERT_EQ(std::vector<frame_id_t>({5, 6, 7}), replacer.EvictionCandidates(8));
+}
+
+}  // namespace bustub
@@ -10,6 +10,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <map>
+#include <optional>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -688,4 +691,138 @@ TEST(CatalogTest, DISABLED_IndexInteraction3) {
   remove("catalog_test.log");
 }
 
+// Index construction should pick up every tuple already in the table
+TEST(CatalogTest, CreateIndexOnPopulatedTable) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+
+  const std::string table_name{"foobar"};
+  const std::string index_name{"index1"};
+
+  std::vector<Column> columns{};
+  columns.emplace_back("A", TypeId::BIGINT);
+  columns.emplace_back("B", TypeId::BIGINT);
+  Schema schema{columns};
+  auto *table_info = catalog->CreateTable(txn.get(), table_name, schema);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+
+  // Keys are inserted out of order, and key 0 twice; the index keeps the first one
+  const int64_t num_rows = 2000;
+  std::vector<RID> rids(num_rows);
+  for (int64_t i = 0; i < num_rows; i++) {
+    const int64_t key = (i * 7) % num_rows;
+    Tuple tuple{std::vector<Value>{ValueFactory::GetBigIntValue(key), ValueFactory::GetBigIntValue(i)}, &schema};
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rids[key], txn.get()));
+  }
+  Tuple duplicate{std::vector<Value>{ValueFactory::GetBigIntValue(0), ValueFactory::GetBigIntValue(-1)}, &schema};
+  RID duplicate_rid;
+  ASSERT_TRUE(table_info->table_->InsertTuple(duplicate, &duplicate_rid, txn.get()));
+
+  std::vector<Column> key_columns{};
+  std::vector<uint32_t> key_attrs{};
+  key_columns.emplace_back("A", TypeId::BIGINT);
+  key_attrs.emplace_back(0);
+  Schema key_schema{key_columns};
+
+  auto *index_info = catalog->CreateIndex<BigintKeyType, BigintValueType, BigintComparatorType>(
+      txn.get(), index_name, table_name, schema, key_schema, key_attrs, BIGINT_SIZE, BigintHashFunctionType{});
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+
+  std::vector<RID> results{};
+  for (int64_t key = 0; key < num_rows; key++) {
+    Tuple tuple{std::vector<Value>{ValueFactory::GetBigIntValue(key), ValueFactory::GetBigIntValue(0)}, &schema};
+    results.clear();
+    index_info->index_->ScanKey(tuple.KeyFromTuple(schema, key_schema, key_attrs), &results, txn.get());
+    ASSERT_EQ(1, results.size());
+    ASSERT_EQ(rids[key], results[0]);
+  }
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
+// NOLINTNEXTLINE
+TEST(CatalogTest, ScanIndexRange) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr);
+  auto txn = std::make_unique<Transaction>(0);
+
+  std::vector<Column> columns{};
+  columns.emplace_back("A", TypeId::BIGINT);
+  Schema schema{columns};
+  auto *table_info = catalog->CreateTable(txn.get(), "foobar", schema);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+  std::vector<uint32_t> key_attrs{0};
+  auto *index_info = catalog->CreateIndex<BigintKeyType, BigintValueType, BigintComparatorType>(
+      txn.get(), "index1", "foobar", schema, schema, key_attrs, BIGINT_SIZE, BigintHashFunctionType{});
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+
+  // Even keys from -500 to 1498, inserted out of order
+  const int64_t num_rows = 1000;
+  std::map<int64_t, RID> rids;
+  for (int64_t i = 0; i < num_rows; i++) {
+    const int64_t key = ((i * 7) % num_rows) * 2 - 500;
+    Tuple tuple{std::vector<Value>{ValueFactory::GetBigIntValue(key)}, &schema};
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rids[key], txn.get()));
+    index_info->index_->InsertEntry(tuple, rids[key], txn.get());
+  }
+
+  auto make_key = [&](int64_t key) { return Tuple{std::vector<Value>{ValueFactory::GetBigIntValue(key)}, &schema}; };
+  auto check = [&](std::optional<int64_t> lower, bool lower_inclusive, std::optional<int64_t> upper,
+                   bool upper_inclusive, ScanDirection direction) {
+    IndexRange range;
+    if (lower.has_value()) {
+      range.lower_ = make_key(*lower);
+    }
+    if (upper.has_value()) {
+      range.upper_ = make_key(*upper);
+    }
+    range.lower_inclusive_ = lower_inclusive;
+    range.upper_inclusive_ = upper_inclusive;
+    range.direction_ = direction;
+    std::vector<RID> expected;
+    for (const auto &[key, rid] : rids) {
+      if ((!lower.has_value() || key > *lower || (lower_inclusive && key == *lower)) &&
+          (!upper.has_value() || key < *upper || (upper_inclusive && key == *upper))) {
+        expected.push_back(rid);
+      }
+    }
+    if (direction == ScanDirection::BACKWARD) {
+      std::reverse(expected.begin(), expected.end());
+    }
+    std::vector<RID> results;
+    index_info->index_->ScanRange(range, &results, txn.get());
+    ASSERT_EQ(expected, results);
+  };
+
+  for (auto direction : {ScanDirection::FORWARD, ScanDirection::BACKWARD}) {
+    for (bool lower_inclusive : {true, false}) {
+      for (bool upper_inclusive : {true, false}) {
+        check(10, lower_inclusive, 20, upper_inclusive, direction);
+        check(11, lower_inclusive, 19, upper_inclusive, direction);
+        check(-600, lower_inclusive, 2000, upper_inclusive, direction);
+        check(-500, lower_inclusive, 1498, upper_inclusive, direction);
+        check(100, lower_inclusive, std::nullopt, upper_inclusive, direction);
+        check(std::nullopt, lower_inclusive, 100, upper_inclusive, direction);
+        check(20, lower_inclusive, 20, upper_inclusive, direction);
+        check(20, lower_inclusive, 10, upper_inclusive, direction);
+        check(1500, lower_inclusive, std::nullopt, upper_inclusive, direction);
+      }
+    }
+    check(std::nullopt, true, std::nullopt, true, direction);
+  }
+
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+}
+
 }  // namespace bustub
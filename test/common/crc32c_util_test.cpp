@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_util_test.cpp
+//
+// Identification: test/common/crc32c_util_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "common/util/crc32c_util.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(Crc32cUtilTest, KnownValuesTest) {
+  // check values from RFC 3720, B.4
+  std::vector<char> zeros(32, 0);
+  std::vector<char> ones(32, static_cast<char>(0xff));
+  std::vector<char> ascending(32);
+  for (size_t i = 0; i < ascending.size(); i++) {
+    ascending[i] = static_cast<char>(i);
+  }
+  const std::string digits = "123456789";
+
+  EXPECT_EQ(0U, Crc32cUtil::Crc32c(nullptr, 0));
+  EXPECT_EQ(0xe3069283U, Crc32cUtil::Crc32c(digits.data(), digits.size()));
+  EXPECT_EQ(0x8a9136aaU, Crc32cUtil::Crc32c(zeros.data(), zeros.size()));
+  EXPECT_EQ(0x62a8ab43U, Crc32cUtil::Crc32c(ones.data(), ones.size()));
+  EXPECT_EQ(0x46dd794eU, Crc32cUtil::Crc32c(ascending.data(), ascending.size()));
+  EXPECT_EQ(0xe3069283U, Crc32cUtil::Crc32cSoftware(digits.data(), digits.size()));
+  EXPECT_EQ(0x46dd794eU, Crc32cUtil::Crc32cSoftware(ascending.data(), ascending.size()));
+}
+
+// NOLINTNEXTLINE
+TEST(Crc32cUtilTest, HardwareMatchesSoftwareTest) {
+  if (!Crc32cUtil::HasHardwareSupport()) {
+    GTEST_SKIP() << "no SSE4.2 on this CPU";
+  }
+  std::mt19937 gen(42);
+  std::vector<char> data(BUSTUB_PAGE_SIZE + 7);
+  for (auto &c : data) {
+    c = static_cast<char>(gen());
+  }
+  // every length and misalignment of the 8 byte steps, and a checksum continued over two pieces
+  for (size_t offset = 0; offset < 8; offset++) {
+    for (size_t size : {0UL, 1UL, 7UL, 8UL, 9UL, 63UL, 4096UL}) {
+      EXPECT_EQ(Crc32cUtil::Crc32cSoftware(data.data() + offset, size),
+                Crc32cUtil::Crc32cHardware(data.data() + offset, size));
+    }
+  }
+  const uint32_t first = Crc32cUtil::Crc32cHardware(data.data(), 1000);
+  EXPECT_EQ(Crc32cUtil::Crc32cSoftware(data.data(), 4096), Crc32cUtil::Crc32cHardware(data.data() + 1000, 3096, first));
+}
+
+}  // namespace bustub
@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
@@ -429,4 +431,88 @@ TEST(BPlusTreeConcurrentTest, MixTest2) {
   remove("test.log");
 }
 
+TEST(BPlusTreeConcurrentTest, ReverseScanTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // 小页面让插入、删除不停地分裂、合并叶子
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 5);
+
+  std::vector<int64_t> perserved_keys;
+  std::vector<int64_t> dynamic_keys;
+  int64_t total_keys = 2000;
+  int64_t sieve = 5;
+  for (int64_t i = 1; i <= total_keys; i++) {
+    if (i % sieve == 0) {
+      perserved_keys.push_back(i);
+    } else {
+      dynamic_keys.push_back(i);
+    }
+  }
+  InsertHelper(&tree, perserved_keys, 1);
+
+  // 反向扫描时别的线程在同一批叶子上插入、删除：结果必须严格递减，且一直在树里的key恰好各出现一次
+  std::atomic<bool> writing{true};
+  auto write_task = [&](int tid) {
+    for (int round = 0; round < 3; round++) {
+      InsertHelperSplit(&tree, dynamic_keys, 2, tid);
+      DeleteHelperSplit(&tree, dynamic_keys, 2, tid);
+    }
+  };
+  auto scan_task = [&]() {
+    int scans = 0;
+    while (writing || scans == 0) {
+      int64_t last_key = total_keys + 1;
+      size_t size = 0;
+      for (auto iter = tree.RBegin(); iter != tree.End(); ++iter) {
+        int64_t key = (*iter).first.ToString();
+        ASSERT_LT(key, last_key);
+        last_key = key;
+        if (key % sieve == 0) {
+          size++;
+        }
+      }
+      ASSERT_EQ(size, perserved_keys.size());
+      scans++;
+    }
+  };
+
+  std::vector<std::thread> writers;
+  for (int tid = 0; tid < 2; tid++) {
+    writers.emplace_back(write_task, tid);
+  }
+  std::vector<std::thread> scanners;
+  for (int i = 0; i < 2; i++) {
+    scanners.emplace_back(scan_task);
+  }
+  for (auto &thread : writers) {
+    thread.join();
+  }
+  writing = false;
+  for (auto &thread : scanners) {
+    thread.join();
+  }
+
+  std::vector<int64_t> keys;
+  for (auto iter = tree.RBegin(); iter != tree.End(); ++iter) {
+    keys.push_back((*iter).first.ToString());
+  }
+  ASSERT_TRUE(std::equal(keys.begin(), keys.end(), perserved_keys.rbegin(), perserved_keys.rend()));
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
@@ -163,4 +163,62 @@ TEST(BPlusTreeTests, DeleteTest2) {
   remove("test.db");
   remove("test.log");
 }
+
+// Pages merged away while a reader still pins them are deleted by a later Remove.
+TEST(BPlusTreeTests, DeletePinnedPageTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 3);
+  GenericKey<8> index_key;
+  RID rid;
+  auto *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  for (int64_t key = 1; key <= 10; key++) {
+    rid.Set(0, key);
+    index_key.SetFromInteger(key);
+    tree.Insert(index_key, rid, transaction);
+  }
+
+  // a reader pins every page of the tree while keys are removed
+  auto *free_space_map = disk_manager->GetFreeSpaceMap();
+  const page_id_t num_pages = free_space_map->GetNextPageId();
+  for (page_id_t pid = 1; pid < num_pages; pid++) {
+    ASSERT_NE(nullptr, bpm->FetchPage(pid));
+  }
+  for (int64_t key = 1; key <= 5; key++) {
+    index_key.SetFromInteger(key);
+    tree.Remove(index_key, transaction);
+  }
+  EXPECT_EQ(0U, free_space_map->GetFreePageCount());
+
+  for (page_id_t pid = 1; pid < num_pages; pid++) {
+    EXPECT_EQ(true, bpm->UnpinPage(pid, false));
+  }
+  // even a remove that merges nothing deletes them
+  index_key.SetFromInteger(100);
+  tree.Remove(index_key, transaction);
+  EXPECT_LT(0U, free_space_map->GetFreePageCount());
+
+  std::vector<RID> rids;
+  for (int64_t key = 1; key <= 10; key++) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_EQ(key > 5, tree.GetValue(index_key, &rids));
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+  remove("test.fsm");
+}
 }  // namespace bustub
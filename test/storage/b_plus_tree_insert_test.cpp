@@ -13,6 +13,9 @@
 #include <algorithm>
 #include <cstdio>
 #include <random>
+#include <set>
+#include <tuple>
+#include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
@@ -340,4 +343,195 @@ TEST(BPlusTreeTests, ScaleTest) {  // NOLINT
   remove("test.log");
 }
 
+TEST(BPlusTreeTests, BulkLoadTest) {  // NOLINT
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  // 小页面下树有好几层，默认页面大小下只有两层；各种填充率都要保证每页大小合法
+  std::vector<std::tuple<int, int, double>> configs{{3, 3, 1.0}, {4, 5, 0.5}, {16, 8, 0.9}, {16, 8, 0.0},
+                                                    {254, 254, 0.9}};
+  for (auto [leaf_max_size, internal_max_size, fill_factor] : configs) {
+    for (int64_t scale : {1, 2, 7, 100, 3000}) {
+      auto *disk_manager = new DiskManager("test.db");
+      BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+      // create and fetch header_page
+      page_id_t page_id;
+      auto *header_page = bpm->NewPage(&page_id);
+      (void)header_page;
+
+      BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, leaf_max_size,
+                                                               internal_max_size);
+      auto *transaction = new Transaction(0);
+
+      // 打乱顺序，并把每个key重复一次；重复的key只保留先出现的那个
+      std::vector<std::pair<GenericKey<8>, RID>> entries;
+      for (int64_t key = 0; key < scale; key++) {
+        GenericKey<8> index_key;
+        index_key.SetFromInteger(key);
+        entries.emplace_back(index_key, RID(static_cast<int32_t>(key), 0));
+      }
+      std::shuffle(entries.begin(), entries.end(), std::default_random_engine{});
+      for (int64_t key = 0; key < scale; key++) {
+        GenericKey<8> index_key;
+        index_key.SetFromInteger(key);
+        entries.emplace_back(index_key, RID(static_cast<int32_t>(key), 1));
+      }
+      ASSERT_TRUE(tree.BulkLoad(&entries, fill_factor));
+      ASSERT_EQ(entries.size(), scale);
+
+      std::vector<RID> rids;
+      for (int64_t key = 0; key < scale; key++) {
+        rids.clear();
+        GenericKey<8> index_key;
+        index_key.SetFromInteger(key);
+        ASSERT_TRUE(tree.GetValue(index_key, &rids));
+        ASSERT_EQ(rids.size(), 1);
+        ASSERT_EQ(rids[0], RID(static_cast<int32_t>(key), 0));
+      }
+      int64_t next_key = 0;
+      for (auto it = tree.Begin(); it != tree.End(); ++it) {
+        ASSERT_EQ((*it).second.GetPageId(), next_key);
+        next_key++;
+      }
+      ASSERT_EQ(next_key, scale);
+
+      // 已有数据时不能再批量加载
+      ASSERT_FALSE(tree.BulkLoad(&entries, fill_factor));
+
+      // 加载出来的树要能继续正常插入和删除
+      for (int64_t key = scale; key < 2 * scale; key++) {
+        GenericKey<8> index_key;
+        index_key.SetFromInteger(key);
+        ASSERT_TRUE(tree.Insert(index_key, RID(static_cast<int32_t>(key), 0), transaction));
+      }
+      for (int64_t key = 0; key < 2 * scale; key++) {
+        GenericKey<8> index_key;
+        index_key.SetFromInteger(key);
+        tree.Remove(index_key, transaction);
+      }
+      ASSERT_TRUE(tree.IsEmpty());
+
+      bpm->UnpinPage(HEADER_PAGE_ID, true);
+      delete transaction;
+      delete disk_manager;
+      delete bpm;
+      remove("test.db");
+      remove("test.log");
+    }
+  }
+}
+
+TEST(BPlusTreeTests, ReverseIteratorTest) {  // NOLINT
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  // 小页面下插入、删除会不断分裂、合并，每一步之后前驱指针都要能把叶子从右往左串起来
+  for (auto [leaf_max_size, internal_max_size] : {std::pair{3, 3}, std::pair{5, 4}, std::pair{254, 254}}) {
+    auto *disk_manager = new DiskManager("test.db");
+    BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+    // create and fetch header_page
+    page_id_t page_id;
+    auto *header_page = bpm->NewPage(&page_id);
+    (void)header_page;
+
+    BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, leaf_max_size,
+                                                             internal_max_size);
+    auto *transaction = new Transaction(0);
+    std::set<int64_t> expected;
+    auto check = [&]() {
+      std::vector<int64_t> keys;
+      for (auto it = tree.RBegin(); it != tree.End(); ++it) {
+        keys.push_back((*it).first.ToString());
+        ASSERT_EQ((*it).second.GetSlotNum(), keys.back());
+      }
+      ASSERT_TRUE(std::equal(keys.begin(), keys.end(), expected.rbegin(), expected.rend()));
+
+      // 从不大于key的最后一个元素开始，key在不在树里都一样
+      for (int64_t key : {-1, 0, 1, 7, 150, 299, 300, 1000}) {
+        GenericKey<8> index_key;
+        index_key.SetFromInteger(key);
+        auto it = tree.RBegin(index_key);
+        auto expected_it = expected.upper_bound(key);
+        if (expected_it == expected.begin()) {
+          ASSERT_TRUE(it.IsEnd()) << key;
+          continue;
+        }
+        ASSERT_FALSE(it.IsEnd()) << key;
+        ASSERT_EQ((*it).first.ToString(), *std::prev(expected_it)) << key;
+        ++it;
+        if (std::prev(expected_it) == expected.begin()) {
+          ASSERT_TRUE(it.IsEnd()) << key;
+        } else {
+          ASSERT_EQ((*it).first.ToString(), *std::prev(expected_it, 2)) << key;
+        }
+      }
+    };
+
+    ASSERT_TRUE(tree.RBegin().IsEnd());
+    std::vector<int64_t> keys;
+    for (int64_t key = 0; key < 300; key++) {
+      keys.push_back(key);
+    }
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine{});
+    for (auto key : keys) {
+      GenericKey<8> index_key;
+      index_key.SetFromInteger(key);
+      tree.Insert(index_key, RID(0, key), transaction);
+      expected.insert(key);
+    }
+    check();
+
+    // 删掉一大半，叶子会向左右借元素或者合并
+    std::shuffle(keys.begin(), keys.end(), std::default_random_engine{});
+    for (size_t i = 0; i < keys.size(); i++) {
+      if (i % 4 != 0) {
+        GenericKey<8> index_key;
+        index_key.SetFromInteger(keys[i]);
+        tree.Remove(index_key, transaction);
+        expected.erase(keys[i]);
+      }
+      if (i % 50 == 0) {
+        check();
+      }
+    }
+    check();
+
+    bpm->UnpinPage(HEADER_PAGE_ID, true);
+    delete transaction;
+    delete disk_manager;
+    delete bpm;
+    remove("test.db");
+    remove("test.log");
+  }
+
+  // 批量加载出来的叶子也要有前驱指针
+  auto *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  page_id_t page_id;
+  auto *header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 4);
+  std::vector<std::pair<GenericKey<8>, RID>> entries;
+  for (int64_t key = 0; key < 100; key++) {
+    GenericKey<8> index_key;
+    index_key.SetFromInteger(key);
+    entries.emplace_back(index_key, RID(0, key));
+  }
+  ASSERT_TRUE(tree.BulkLoad(&entries, 1.0));
+  int64_t next_key = 99;
+  for (auto it = tree.RBegin(); it != tree.End(); ++it) {
+    ASSERT_EQ((*it).first.ToString(), next_key);
+    next_key--;
+  }
+  ASSERT_EQ(next_key, -1);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete disk_manager;
+  delete bpm;
+  remove("test.db");
+  remove("test.log");
+}
+
 }  // namespace bustub
@@ -10,11 +10,20 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_mmap.h"
 
 namespace bustub {
 
@@ -24,12 +33,17 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.crc");
+    remove("test.fsm");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.crc");
+    remove("test.fsm");
+    page_checksums = false;
   };
 };
 
@@ -55,6 +69,303 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+// With direct I/O, aligned and unaligned buffers alike read back what was written, one page at a time or in batches.
+TEST_F(DiskManagerTest, DirectIoTest) {
+  auto dm = DiskManager("test.db", true);
+  // the file system may not support O_DIRECT, the disk manager then falls back to buffered I/O
+  if (!dm.IsDirectIo()) {
+    GTEST_LOG_(INFO) << "direct I/O not supported here, testing the fallback";
+  }
+
+  auto *aligned = static_cast<char *>(std::aligned_alloc(BUSTUB_PAGE_SIZE, 4 * BUSTUB_PAGE_SIZE));
+  std::vector<char> unaligned_storage(4 * BUSTUB_PAGE_SIZE + 1);
+  char *unaligned = unaligned_storage.data() + 1;
+  for (int i = 0; i < 4; i++) {
+    snprintf(aligned + i * BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE, "aligned%d", i);
+    snprintf(unaligned + i * BUSTUB_PAGE_SIZE, BUSTUB_PAGE_SIZE, "unaligned%d", i);
+  }
+
+  dm.WritePage(0, aligned);
+  dm.WritePage(1, unaligned);
+  dm.WritePages({2, 3, 5, 4}, {aligned + BUSTUB_PAGE_SIZE, unaligned + BUSTUB_PAGE_SIZE, aligned + 2 * BUSTUB_PAGE_SIZE,
+                               unaligned + 2 * BUSTUB_PAGE_SIZE});
+
+  std::memset(aligned, 0, 4 * BUSTUB_PAGE_SIZE);
+  std::memset(unaligned, 0, 4 * BUSTUB_PAGE_SIZE);
+  dm.ReadPage(1, aligned);
+  EXPECT_STREQ("unaligned0", aligned);
+  dm.ReadPage(0, unaligned);
+  EXPECT_STREQ("aligned0", unaligned);
+  dm.ReadPages({5, 4, 3, 2}, {aligned + BUSTUB_PAGE_SIZE, unaligned + BUSTUB_PAGE_SIZE, aligned + 2 * BUSTUB_PAGE_SIZE,
+                              unaligned + 2 * BUSTUB_PAGE_SIZE});
+  EXPECT_STREQ("aligned2", aligned + BUSTUB_PAGE_SIZE);
+  EXPECT_STREQ("unaligned2", unaligned + BUSTUB_PAGE_SIZE);
+  EXPECT_STREQ("unaligned1", aligned + 2 * BUSTUB_PAGE_SIZE);
+  EXPECT_STREQ("aligned1", unaligned + 2 * BUSTUB_PAGE_SIZE);
+
+  // past the end of the file
+  dm.ReadPage(9, unaligned);
+  EXPECT_EQ(0, unaligned[0]);
+
+  std::free(aligned);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+// The mapped disk manager reads what the file holds, and keeps its own writes in memory without touching the file.
+TEST_F(DiskManagerTest, MmapReadOnlyTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  {
+    auto dm = DiskManager("test.db");
+    for (int i = 0; i < 200; i++) {
+      snprintf(data, sizeof(data), "page%d", i);
+      dm.WritePage(i, data);
+    }
+    dm.ShutDown();
+  }
+
+  auto mmap_dm = DiskManagerMmap("test.db");
+  EXPECT_EQ(200U, mmap_dm.GetMappedPages());
+  // a sequential scan, which reads ahead of itself
+  for (int i = 0; i < 200; i++) {
+    mmap_dm.ReadPage(i, buf);
+    EXPECT_EQ(std::string("page") + std::to_string(i), std::string(buf));
+  }
+  std::vector<char> bufs(2 * BUSTUB_PAGE_SIZE);
+  mmap_dm.ReadPages({150, 7}, {bufs.data(), bufs.data() + BUSTUB_PAGE_SIZE});
+  EXPECT_STREQ("page150", bufs.data());
+  EXPECT_STREQ("page7", bufs.data() + BUSTUB_PAGE_SIZE);
+
+  // past the end of the file
+  mmap_dm.ReadPage(300, buf);
+  EXPECT_EQ(0, buf[0]);
+
+  // writes shadow the file, in memory only
+  std::strncpy(data, "rewritten", sizeof(data));
+  mmap_dm.WritePage(3, data);
+  mmap_dm.WritePage(300, data);
+  mmap_dm.ReadPage(3, buf);
+  EXPECT_STREQ("rewritten", buf);
+  mmap_dm.ReadPage(300, buf);
+  EXPECT_STREQ("rewritten", buf);
+  mmap_dm.ShutDown();
+
+  auto dm = DiskManager("test.db");
+  dm.ReadPage(3, buf);
+  EXPECT_STREQ("page3", buf);
+  dm.ShutDown();
+
+  EXPECT_THROW(DiskManagerMmap("no_such_file.db"), Exception);
+}
+
+// NOLINTNEXTLINE
+// A page that changed on disk behind the disk manager's back is reported instead of being handed out, even after a
+// restart, and even through the mapped disk manager of a replica.
+TEST_F(DiskManagerTest, ChecksumTest) {
+  page_checksums = true;
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  {
+    auto dm = DiskManager("test.db");
+    for (int i = 0; i < 4; i++) {
+      snprintf(data, sizeof(data), "page%d", i);
+      dm.WritePage(i, data);
+    }
+    EXPECT_NE(0U, dm.GetPageChecksums()->Get(2));
+    EXPECT_EQ(0U, dm.GetPageChecksums()->Get(4));
+    dm.ReadPage(2, buf);
+    EXPECT_STREQ("page2", buf);
+
+    // flip a byte of page 2 in the file
+    int fd = open("test.db", O_RDWR);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(1, pwrite(fd, "X", 1, 2 * BUSTUB_PAGE_SIZE + 100));
+    close(fd);
+    try {
+      dm.ReadPage(2, buf);
+      FAIL() << "corrupted page was read";
+    } catch (const Exception &e) {
+      EXPECT_EQ(ExceptionType::CORRUPTION, e.GetType());
+    }
+    std::vector<char> bufs(2 * BUSTUB_PAGE_SIZE);
+    EXPECT_THROW(dm.ReadPages({1, 2}, {bufs.data(), bufs.data() + BUSTUB_PAGE_SIZE}), Exception);
+    EXPECT_STREQ("page1", bufs.data());
+
+    // pages that were never written have no checksum to match
+    dm.ReadPage(10, buf);
+    EXPECT_EQ(0, buf[0]);
+    dm.ShutDown();
+  }
+
+  {
+    // the checksums survive a restart, and rewriting the page repairs it
+    auto dm = DiskManager("test.db");
+    EXPECT_THROW(dm.ReadPage(2, buf), Exception);
+    dm.ReadPage(3, buf);
+    EXPECT_STREQ("page3", buf);
+    snprintf(data, sizeof(data), "page2");
+    dm.WritePage(2, data);
+    dm.ReadPage(2, buf);
+    EXPECT_STREQ("page2", buf);
+
+    // a page cut off by a truncated file does not read as zeros
+    ASSERT_EQ(0, truncate("test.db", 3 * BUSTUB_PAGE_SIZE));
+    EXPECT_THROW(dm.ReadPage(3, buf), Exception);
+
+    // with checksums off, pages are neither verified nor given checksums
+    page_checksums = false;
+    dm.ReadPage(3, buf);
+    EXPECT_EQ(0, buf[0]);
+    dm.WritePage(3, data);
+    page_checksums = true;
+    EXPECT_EQ(0U, dm.GetPageChecksums()->Get(3));
+    dm.ShutDown();
+  }
+
+  auto mmap_dm = DiskManagerMmap("test.db");
+  mmap_dm.ReadPage(1, buf);
+  EXPECT_STREQ("page1", buf);
+  int fd = open("test.db", O_RDWR);
+  ASSERT_GE(fd, 0);
+  ASSERT_EQ(1, pwrite(fd, "X", 1, BUSTUB_PAGE_SIZE + 100));
+  close(fd);
+  EXPECT_THROW(mmap_dm.ReadPage(1, buf), Exception);
+  mmap_dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+// A crash leaves a page that was written since the last sync of the database file either as it was at that sync or as
+// last written, and both read back after a restart, while a page torn between the two is reported.
+TEST_F(DiskManagerTest, ChecksumCrashTest) {
+  page_checksums = true;
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char old_data[BUSTUB_PAGE_SIZE] = {0};
+  char new_data[BUSTUB_PAGE_SIZE] = {0};
+  char newer_data[BUSTUB_PAGE_SIZE] = {0};
+  char zeros[BUSTUB_PAGE_SIZE] = {0};
+  snprintf(old_data, sizeof(old_data), "old");
+  snprintf(new_data, sizeof(new_data), "new");
+  new_data[BUSTUB_PAGE_SIZE - 1] = 'x';
+  snprintf(newer_data, sizeof(newer_data), "newer");
+  {
+    auto dm = DiskManager("test.db");
+    dm.WritePage(1, old_data);
+    dm.WritePage(2, old_data);
+    dm.ShutDown();
+  }
+
+  auto put = [](page_id_t page_id, const char *data, size_t size) {
+    int fd = open("test.db", O_RDWR);
+    ASSERT_GE(fd, 0);
+    ASSERT_EQ(static_cast<ssize_t>(size), pwrite(fd, data, size, page_id * BUSTUB_PAGE_SIZE));
+    close(fd);
+  };
+  // 不关闭dm就重新打开，相当于dm所在的进程崩溃了。重启后的关闭会改写校验和文件，每次崩溃前恢复dm写下的
+  std::string crc_file;
+  auto save_crc_file = [&crc_file] {
+    std::ifstream in("test.crc", std::ios::binary);
+    crc_file.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+  };
+  auto crash = [&](page_id_t page_id, const char *data, size_t size) {
+    std::ofstream("test.crc", std::ios::binary | std::ios::trunc)
+        .write(crc_file.data(), static_cast<std::streamsize>(crc_file.size()));
+    put(page_id, data, size);
+  };
+  auto read_after_restart = [](page_id_t page_id) -> std::string {
+    char buf[BUSTUB_PAGE_SIZE];
+    auto restarted = DiskManager("test.db");
+    try {
+      restarted.ReadPage(page_id, buf);
+    } catch (const Exception &e) {
+      EXPECT_EQ(ExceptionType::CORRUPTION, e.GetType());
+      return "corrupted";
+    }
+    return buf;
+  };
+
+  auto dm = DiskManager("test.db");
+  dm.WritePage(1, new_data);
+  dm.WritePage(5, new_data);
+  save_crc_file();
+  // the page write did not reach the disk, it did, it got half way
+  crash(1, old_data, BUSTUB_PAGE_SIZE);
+  EXPECT_EQ("old", read_after_restart(1));
+  crash(1, new_data, BUSTUB_PAGE_SIZE);
+  EXPECT_EQ("new", read_after_restart(1));
+  crash(1, old_data, BUSTUB_PAGE_SIZE / 2);
+  EXPECT_EQ("corrupted", read_after_restart(1));
+  // pages that were not being written only match their own checksum
+  crash(2, new_data, BUSTUB_PAGE_SIZE);
+  EXPECT_EQ("corrupted", read_after_restart(2));
+  crash(2, old_data, BUSTUB_PAGE_SIZE);
+  EXPECT_EQ("old", read_after_restart(2));
+  // a page is all zeros before its first write reaches the disk, and a torn first write is reported
+  crash(5, zeros, BUSTUB_PAGE_SIZE);
+  EXPECT_EQ("", read_after_restart(5));
+  crash(5, new_data, BUSTUB_PAGE_SIZE / 2);
+  EXPECT_EQ("corrupted", read_after_restart(5));
+
+  // writing a page again syncs the database file first, so the version before the last sync cannot be on disk anymore
+  crash(5, new_data, BUSTUB_PAGE_SIZE);
+  crash(1, new_data, BUSTUB_PAGE_SIZE);
+  dm.WritePage(1, newer_data);
+  save_crc_file();
+  crash(1, old_data, BUSTUB_PAGE_SIZE);
+  EXPECT_EQ("corrupted", read_after_restart(1));
+  crash(1, newer_data, BUSTUB_PAGE_SIZE);
+  EXPECT_EQ("newer", read_after_restart(1));
+
+  // a restart that does not read the page still does not know which of the two is on disk when it shuts down, and a
+  // restart that writes the page reads it first
+  crash(1, new_data, BUSTUB_PAGE_SIZE);
+  DiskManager("test.db").ShutDown();
+  EXPECT_EQ("new", read_after_restart(1));
+  crash(1, new_data, BUSTUB_PAGE_SIZE);
+  {
+    auto restarted = DiskManager("test.db");
+    restarted.WritePage(1, old_data);
+    restarted.ReadPage(1, buf);
+    EXPECT_STREQ("old", buf);
+    restarted.ShutDown();
+  }
+  EXPECT_EQ("old", read_after_restart(1));
+
+  // a clean shutdown keeps only the last checksum
+  crash(1, newer_data, BUSTUB_PAGE_SIZE);
+  dm.ShutDown();
+  put(1, new_data, BUSTUB_PAGE_SIZE);
+  EXPECT_EQ("corrupted", read_after_restart(1));
+}
+
+// NOLINTNEXTLINE
+// A page that was free when the free space map was saved, and was handed out again and written since, is not free
+// after a crash.
+TEST_F(DiskManagerTest, FreeSpaceMapCrashTest) {
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  auto dm = DiskManager("test.db");
+  auto *free_space_map = dm.GetFreeSpaceMap();
+  for (page_id_t page_id = 0; page_id < 4; page_id++) {
+    EXPECT_EQ(page_id, free_space_map->Allocate(1, 0));
+    dm.WritePage(page_id, data);
+  }
+  EXPECT_EQ(true, free_space_map->Deallocate(2));
+  dm.SaveFreeSpaceMap();
+
+  EXPECT_EQ(true, free_space_map->Deallocate(3));
+  EXPECT_EQ(2, free_space_map->Allocate(1, 0));
+  dm.WritePage(2, data);
+  // 不关闭dm就重新打开，相当于dm所在的进程崩溃了
+  {
+    auto restarted = DiskManager("test.db");
+    EXPECT_EQ(false, restarted.GetFreeSpaceMap()->IsFree(2));
+    EXPECT_EQ(true, restarted.GetFreeSpaceMap()->IsFree(3));
+    EXPECT_EQ(4, restarted.GetFreeSpaceMap()->GetNextPageId());
+  }
+  dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
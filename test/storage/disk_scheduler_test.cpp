@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler_test.cpp
+//
+// Identification: test/storage/disk_scheduler_test.cpp
+//
+// Copyright (c) 2015-2023, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <condition_variable>  // NOLINT
+#include <cstring>
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/disk/disk_scheduler.h"
+
+namespace bustub {
+
+class DiskSchedulerTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_F(DiskSchedulerTest, ScheduleWriteReadPageTest) {
+  char buf[BUSTUB_PAGE_SIZE] = {0};
+  char data[BUSTUB_PAGE_SIZE] = {0};
+  auto dm = DiskManager("test.db");
+  auto scheduler = DiskScheduler(&dm);
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  auto write_done = scheduler.Schedule({true, {3}, {data}, {}});
+  write_done.get();
+  auto read_done = scheduler.Schedule({false, {3}, {buf}, {}});
+  read_done.get();
+  EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+
+  // pages past the end of the file read as zeros
+  read_done = scheduler.Schedule({false, {10}, {buf}, {}});
+  read_done.get();
+  EXPECT_EQ(buf[0], 0);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskSchedulerTest, BatchTest) {
+  auto dm = DiskManager("test.db");
+  auto scheduler = DiskScheduler(&dm, 2);
+
+  // two runs of adjacent pages and a single page, not in order
+  std::vector<page_id_t> page_ids{7, 2, 1, 3, 9, 8};
+  std::vector<std::vector<char>> pages(page_ids.size(), std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<const char *> write_data;
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    snprintf(pages[i].data(), BUSTUB_PAGE_SIZE, "page%d", page_ids[i]);
+    write_data.push_back(pages[i].data());
+  }
+  scheduler.WritePages(page_ids, write_data);
+
+  std::vector<std::vector<char>> bufs(page_ids.size(), std::vector<char>(BUSTUB_PAGE_SIZE));
+  std::vector<char *> read_data;
+  for (auto &buf : bufs) {
+    read_data.push_back(buf.data());
+  }
+  scheduler.ReadPages(page_ids, read_data);
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    EXPECT_EQ(std::string("page") + std::to_string(page_ids[i]), std::string(bufs[i].data()));
+  }
+
+  // nothing to do
+  scheduler.ReadPages({}, {});
+
+  dm.ShutDown();
+}
+
+/** A disk manager whose reads wait until the given number of reads are in flight together, and that fails page 13. */
+class RendezvousDiskManager : public DiskManagerUnlimitedMemory {
+ public:
+  void ReadPage(page_id_t page_id, char *page_data) override {
+    if (page_id == 13) {
+      throw Exception(ExceptionType::OUT_OF_RANGE, "bad page");
+    }
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      in_flight_++;
+      max_in_flight_ = std::max(max_in_flight_, in_flight_);
+      cv_.notify_all();
+      cv_.wait_for(lock, std::chrono::seconds(5), [this] { return max_in_flight_ >= expected_in_flight_; });
+      in_flight_--;
+    }
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  int expected_in_flight_{1};
+  int max_in_flight_{0};
+
+ private:
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  int in_flight_{0};
+};
+
+// NOLINTNEXTLINE
+TEST_F(DiskSchedulerTest, QueueDepthTest) {
+  RendezvousDiskManager dm;
+  dm.expected_in_flight_ = 3;
+  auto scheduler = DiskScheduler(&dm, 3);
+
+  // three scattered pages are three requests, served by three workers at the same time
+  std::vector<std::vector<char>> bufs(3, std::vector<char>(BUSTUB_PAGE_SIZE));
+  scheduler.ReadPages({0, 2, 4}, {bufs[0].data(), bufs[1].data(), bufs[2].data()});
+  EXPECT_EQ(3, dm.max_in_flight_);
+
+  // errors of the disk manager reach the caller
+  dm.expected_in_flight_ = 1;
+  auto done = scheduler.Schedule({false, {13}, {bufs[0].data()}, {}});
+  EXPECT_THROW(done.get(), Exception);
+  EXPECT_THROW(scheduler.ReadPages({12, 13, 20}, {bufs[0].data(), bufs[1].data(), bufs[2].data()}), Exception);
+}
+
+}  // namespace bustub
@@ -0,0 +1,200 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_codec_test.cpp
+//
+// Identification: test/storage/key_codec_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <cfloat>
+#include <climits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/index/generic_key.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return the sign of comparing two rows column by column, NULL before every other value */
+auto CompareRows(const std::vector<Value> &lhs, const std::vector<Value> &rhs) -> int {
+  for (size_t i = 0; i < lhs.size(); i++) {
+    if (lhs[i].IsNull() || rhs[i].IsNull()) {
+      if (lhs[i].IsNull() != rhs[i].IsNull()) {
+        return lhs[i].IsNull() ? -1 : 1;
+      }
+      continue;
+    }
+    if (lhs[i].CompareLessThan(rhs[i]) == CmpBool::CmpTrue) {
+      return -1;
+    }
+    if (lhs[i].CompareGreaterThan(rhs[i]) == CmpBool::CmpTrue) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+auto Sign(int cmp) -> int { return static_cast<int>(cmp > 0) - static_cast<int>(cmp < 0); }
+
+/** Check that encoded keys of every pair of rows compare like the rows do, and that they decode back. */
+template <size_t KeySize>
+void CheckOrder(const std::vector<std::vector<Value>> &rows, Schema *schema) {
+  GenericComparator<KeySize> comparator(schema);
+  std::vector<GenericKey<KeySize>> keys(rows.size());
+  for (size_t i = 0; i < rows.size(); i++) {
+    keys[i].SetFromKey(Tuple(rows[i], schema), schema);
+    for (uint32_t col = 0; col < schema->GetColumnCount(); col++) {
+      const Value value = keys[i].ToValue(schema, col);
+      ASSERT_EQ(value.IsNull(), rows[i][col].IsNull());
+      if (!value.IsNull()) {
+        ASSERT_EQ(value.CompareEquals(rows[i][col]), CmpBool::CmpTrue) << value.ToString();
+      }
+    }
+  }
+  for (size_t i = 0; i < rows.size(); i++) {
+    for (size_t j = 0; j < rows.size(); j++) {
+      ASSERT_EQ(Sign(comparator(keys[i], keys[j])), CompareRows(rows[i], rows[j])) << i << " " << j;
+    }
+  }
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(KeyCodecTest, IntegerOrderTest) {
+  std::vector<int64_t> bigints{LLONG_MIN + 1, -1000000000000, -2, -1, 0, 1, 2, 255, 256, 1000000000000, LLONG_MAX};
+  std::vector<int32_t> integers{INT_MIN + 1, -65536, -1, 0, 1, 127, 128, 65536, INT_MAX};
+  std::mt19937_64 gen(0);
+  for (int i = 0; i < 50; i++) {
+    bigints.push_back(static_cast<int64_t>(gen()));
+    integers.push_back(static_cast<int32_t>(gen()));
+  }
+
+  Schema bigint_schema({Column("a", TypeId::BIGINT)});
+  std::vector<std::vector<Value>> bigint_rows{{ValueFactory::GetNullValueByType(TypeId::BIGINT)}};
+  for (auto value : bigints) {
+    bigint_rows.push_back({ValueFactory::GetBigIntValue(value)});
+  }
+  CheckOrder<8>(bigint_rows, &bigint_schema);
+  CheckOrder<16>(bigint_rows, &bigint_schema);
+
+  Schema integer_schema({Column("a", TypeId::INTEGER)});
+  std::vector<std::vector<Value>> integer_rows{{ValueFactory::GetNullValueByType(TypeId::INTEGER)}};
+  for (auto value : integers) {
+    integer_rows.push_back({ValueFactory::GetIntegerValue(value)});
+  }
+  CheckOrder<4>(integer_rows, &integer_schema);
+  CheckOrder<8>(integer_rows, &integer_schema);
+
+  // SetFromInteger与按BIGINT(或INTEGER)列编码的结果一致
+  for (auto value : bigints) {
+    GenericKey<8> from_integer;
+    GenericKey<8> from_tuple;
+    from_integer.SetFromInteger(value);
+    from_tuple.SetFromKey(Tuple({ValueFactory::GetBigIntValue(value)}, &bigint_schema), &bigint_schema);
+    ASSERT_EQ(memcmp(from_integer.data_, from_tuple.data_, 8), 0);
+    ASSERT_EQ(from_integer.ToString(), value);
+  }
+  for (auto value : integers) {
+    GenericKey<4> from_integer;
+    GenericKey<4> from_tuple;
+    from_integer.SetFromInteger(value);
+    from_tuple.SetFromKey(Tuple({ValueFactory::GetIntegerValue(value)}, &integer_schema), &integer_schema);
+    ASSERT_EQ(memcmp(from_integer.data_, from_tuple.data_, 4), 0);
+    ASSERT_EQ(from_integer.ToString(), value);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(KeyCodecTest, DecimalOrderTest) {
+  Schema schema({Column("a", TypeId::DECIMAL)});
+  std::vector<std::vector<Value>> rows{{ValueFactory::GetNullValueByType(TypeId::DECIMAL)}};
+  for (double value : {-DBL_MAX, -1e10, -1.5, -DBL_MIN, 0.0, DBL_MIN, 0.25, 1.5, 1e10, DBL_MAX}) {
+    rows.push_back({ValueFactory::GetDecimalValue(value)});
+  }
+  CheckOrder<8>(rows, &schema);
+}
+
+// NOLINTNEXTLINE
+TEST(KeyCodecTest, TimestampNullTest) {
+  // 时间戳0和NULL的编码不同；NULL沿用BUSTUB_TIMESTAMP_NULL，排在所有时间戳后面
+  Schema schema({Column("a", TypeId::TIMESTAMP)});
+  GenericComparator<8> comparator(&schema);
+  auto make_key = [&](const Value &value) {
+    GenericKey<8> key;
+    key.SetFromKey(Tuple({value}, &schema), &schema);
+    return key;
+  };
+  const Value null_value = ValueFactory::GetTimestampValue(static_cast<int64_t>(BUSTUB_TIMESTAMP_NULL));
+  ASSERT_TRUE(null_value.IsNull());
+  const auto null_key = make_key(null_value);
+  const auto zero_key = make_key(ValueFactory::GetTimestampValue(0));
+  const auto one_key = make_key(ValueFactory::GetTimestampValue(1));
+  const auto max_key = make_key(ValueFactory::GetTimestampValue(BUSTUB_TIMESTAMP_NULL - 1));
+
+  ASSERT_TRUE(null_key.ToValue(&schema, 0).IsNull());
+  ASSERT_FALSE(zero_key.ToValue(&schema, 0).IsNull());
+  ASSERT_EQ(zero_key.ToValue(&schema, 0).GetAs<uint64_t>(), 0);
+  ASSERT_EQ(max_key.ToValue(&schema, 0).GetAs<uint64_t>(), BUSTUB_TIMESTAMP_NULL - 1);
+  ASSERT_LT(comparator(zero_key, one_key), 0);
+  ASSERT_LT(comparator(one_key, max_key), 0);
+  ASSERT_LT(comparator(max_key, null_key), 0);
+  ASSERT_EQ(comparator(null_key, make_key(null_value)), 0);
+
+  // 放不下的时间戳解码成NULL
+  Schema wide_schema({Column("a", TypeId::INTEGER), Column("b", TypeId::TIMESTAMP)});
+  GenericKey<8> key;
+  key.SetFromKey(Tuple({ValueFactory::GetIntegerValue(1), ValueFactory::GetTimestampValue(0)}, &wide_schema),
+                 &wide_schema);
+  ASSERT_TRUE(key.ToValue(&wide_schema, 1).IsNull());
+}
+
+// NOLINTNEXTLINE
+TEST(KeyCodecTest, MultiColumnOrderTest) {
+  Schema schema({Column("a", TypeId::VARCHAR, 16), Column("b", TypeId::SMALLINT), Column("c", TypeId::BOOLEAN)});
+  std::vector<std::vector<Value>> rows;
+  for (const char *str : {"", "a", "ab", "abc", "b", "ba", "zzz"}) {
+    for (int16_t number : {-300, -1, 0, 7, 300}) {
+      for (bool flag : {false, true}) {
+        rows.push_back({ValueFactory::GetVarcharValue(str), ValueFactory::GetSmallIntValue(number),
+                        ValueFactory::GetBooleanValue(flag)});
+      }
+    }
+  }
+  rows.push_back({ValueFactory::GetNullValueByType(TypeId::VARCHAR), ValueFactory::GetSmallIntValue(1),
+                  ValueFactory::GetBooleanValue(true)});
+  rows.push_back({ValueFactory::GetVarcharValue("a"), ValueFactory::GetNullValueByType(TypeId::SMALLINT),
+                  ValueFactory::GetBooleanValue(true)});
+  CheckOrder<16>(rows, &schema);
+}
+
+// NOLINTNEXTLINE
+TEST(KeyCodecTest, TruncatedVarcharTest) {
+  Schema schema({Column("a", TypeId::VARCHAR, 64), Column("b", TypeId::INTEGER)});
+  GenericComparator<8> comparator(&schema);
+  auto make_key = [&](const std::string &str, int32_t number) {
+    GenericKey<8> key;
+    key.SetFromKey(Tuple({ValueFactory::GetVarcharValue(str), ValueFactory::GetIntegerValue(number)}, &schema),
+                   &schema);
+    return key;
+  };
+
+  // 放不下的字符串按能放下的前缀排序，后面的列被丢掉
+  ASSERT_LT(comparator(make_key("abcdef", 1), make_key("abcdeg", 0)), 0);
+  ASSERT_LT(comparator(make_key("abcdefg", 9), make_key("abcdeh", 0)), 0);
+  ASSERT_EQ(comparator(make_key("abcdefgh", 1), make_key("abcdefgx", 2)), 0);
+  ASSERT_EQ(make_key("abcdefgh", 1).ToValue(&schema, 0).ToString(), "abcdefg");
+  ASSERT_TRUE(make_key("abcdefgh", 1).ToValue(&schema, 1).IsNull());
+  // 短字符串后面还能放下整数列
+  ASSERT_LT(comparator(make_key("ab", 1), make_key("ab", 2)), 0);
+  ASSERT_EQ(make_key("ab", 2).ToValue(&schema, 1).GetAs<int32_t>(), 2);
+}
+
+}  // namespace bustub
@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// key_search_test.cpp
+//
+// Identification: test/storage/key_search_test.cpp
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/index/key_search.h"
+
+namespace bustub {
+
+namespace {
+
+/** Check every search path against std::lower_bound and std::upper_bound on sorted keys with duplicates. */
+template <size_t KeySize>
+void CheckSearch(int64_t range) {
+  GenericComparator<KeySize> comparator(nullptr);
+  auto less = [&](const GenericKey<KeySize> &lhs, const GenericKey<KeySize> &rhs) { return comparator(lhs, rhs) < 0; };
+  std::mt19937_64 gen(KeySize);
+  std::uniform_int_distribution<int64_t> dist(-range, range);
+
+  for (int count : {0, 1, 2, 3, 7, 8, 9, 15, 16, 17, 31, 32, 33, 100, 255, 340}) {
+    std::vector<int64_t> numbers(count);
+    for (auto &number : numbers) {
+      number = dist(gen);
+    }
+    std::sort(numbers.begin(), numbers.end());
+    std::vector<GenericKey<KeySize>> keys(count);
+    for (int i = 0; i < count; i++) {
+      keys[i].SetFromInteger(numbers[i]);
+    }
+    const auto *data = reinterpret_cast<const char *>(keys.data());
+
+    std::vector<int64_t> probes{-range - 1, range + 1};
+    for (auto number : numbers) {
+      probes.insert(probes.end(), {number - 1, number, number + 1});
+    }
+    for (auto number : probes) {
+      GenericKey<KeySize> key;
+      key.SetFromInteger(number);
+      const auto *key_data = reinterpret_cast<const char *>(&key);
+      const int lower = std::lower_bound(keys.begin(), keys.end(), key, less) - keys.begin();
+      const int upper = std::upper_bound(keys.begin(), keys.end(), key, less) - keys.begin();
+
+      ASSERT_EQ(KeySearch::LowerBound(keys.data(), count, key, comparator), lower) << count << " " << number;
+      ASSERT_EQ(KeySearch::UpperBound(keys.data(), count, key, comparator), upper) << count << " " << number;
+      if constexpr (KeySize == 4 || KeySize == 8) {
+        ASSERT_EQ(KeySearch::SearchScalar(data, count, key_data, KeySize, false), lower);
+        ASSERT_EQ(KeySearch::SearchScalar(data, count, key_data, KeySize, true), upper);
+        if (KeySearch::HasSimdSupport()) {
+          ASSERT_EQ(KeySearch::SearchSimd(data, count, key_data, KeySize, false), lower);
+          ASSERT_EQ(KeySearch::SearchSimd(data, count, key_data, KeySize, true), upper);
+        }
+      }
+    }
+  }
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(KeySearchTest, SmallKeyTest) {
+  CheckSearch<4>(50);
+  CheckSearch<4>(1000000000);
+  CheckSearch<8>(50);
+  CheckSearch<8>(int64_t{1} << 60);
+}
+
+// NOLINTNEXTLINE
+TEST(KeySearchTest, WideKeyTest) {
+  CheckSearch<16>(50);
+  CheckSearch<16>(int64_t{1} << 60);
+  CheckSearch<64>(50);
+}
+
+// NOLINTNEXTLINE
+TEST(KeySearchTest, SignBitTest) {
+  // 编码后的key按无符号比较，负数和正数之间的顺序要靠翻转的符号位保证
+  std::vector<int64_t> numbers{INT32_MIN + 1, -70000, -256, -1, 0, 1, 255, 70000, INT32_MAX};
+  GenericComparator<8> comparator(nullptr);
+  std::vector<GenericKey<8>> keys(numbers.size());
+  for (size_t i = 0; i < numbers.size(); i++) {
+    keys[i].SetFromInteger(numbers[i]);
+  }
+  const int count = static_cast<int>(keys.size());
+  for (int i = 0; i < count; i++) {
+    ASSERT_EQ(KeySearch::LowerBound(keys.data(), count, keys[i], comparator), i);
+    ASSERT_EQ(KeySearch::UpperBound(keys.data(), count, keys[i], comparator), i + 1);
+  }
+}
+
+}  // namespace bustub
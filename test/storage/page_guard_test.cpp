@@ -0,0 +1,221 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_guard_test.cpp
+//
+// Identification: test/storage/page_guard_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/page/page_guard.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "test_util.h"  // NOLINT
+
+namespace bustub {
+
+TEST(PageGuardTest, BasicGuardTest) {
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
+
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  {
+    BasicPageGuard guard(bpm, page);
+    EXPECT_EQ(page_id, guard.PageId());
+    EXPECT_EQ(1, page->GetPinCount());
+
+    // moving hands the pin over without touching the pin count
+    BasicPageGuard moved(std::move(guard));
+    EXPECT_FALSE(guard.IsValid());  // NOLINT
+    EXPECT_TRUE(moved.IsValid());
+    EXPECT_EQ(1, page->GetPinCount());
+
+    std::strcpy(moved.GetDataMut(), "guarded");  // NOLINT
+    moved.Drop();
+    EXPECT_EQ(0, page->GetPinCount());
+    EXPECT_TRUE(page->IsDirty());
+    // dropping twice is harmless
+    moved.Drop();
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+
+  {
+    auto guard = bpm->FetchPageBasic(page_id);
+    EXPECT_EQ(1, page->GetPinCount());
+    EXPECT_STREQ("guarded", guard.GetData());
+    // assigning another guard releases the page held before
+    page_id_t other_page_id;
+    guard = bpm->NewPageGuarded(&other_page_id);
+    EXPECT_EQ(0, page->GetPinCount());
+    EXPECT_EQ(other_page_id, guard.PageId());
+  }
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(PageGuardTest, ReadWriteGuardTest) {
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
+
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  bpm->UnpinPage(page_id, false);
+  ASSERT_TRUE(bpm->FlushPage(page_id));
+
+  {
+    auto guard1 = bpm->FetchPageRead(page_id);
+    auto guard2 = bpm->FetchPageRead(page_id);
+    EXPECT_EQ(2, page->GetPinCount());
+    EXPECT_FALSE(page->IsDirty());
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+
+  {
+    auto guard = bpm->FetchPageWrite(page_id);
+    std::strcpy(guard.AsMut<char>(), "written");  // NOLINT
+  }
+  EXPECT_EQ(0, page->GetPinCount());
+  EXPECT_TRUE(page->IsDirty());
+
+  // the write latch was released, so a reader gets through
+  {
+    auto guard = bpm->FetchPageRead(page_id);
+    EXPECT_STREQ("written", guard.GetData());
+  }
+
+  // a writer waits until the read guard is dropped
+  auto read_guard = bpm->FetchPageRead(page_id);
+  std::atomic<bool> written{false};
+  std::thread writer([&] {
+    auto guard = bpm->FetchPageWrite(page_id);
+    written = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(written);
+  read_guard.Drop();
+  writer.join();
+  EXPECT_TRUE(written);
+  EXPECT_EQ(0, page->GetPinCount());
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(PageGuardTest, OptimisticGuardTest) {
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(5, disk_manager);
+
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  bpm->UnpinPage(page_id, false);
+
+  auto guard = bpm->FetchPageOptimistic(page_id);
+  EXPECT_TRUE(guard.Validate());
+  // readers do not invalidate what was read
+  bpm->FetchPageRead(page_id).Drop();
+  EXPECT_TRUE(guard.Validate());
+  // a writer does, even if it did not change anything
+  bpm->FetchPageWrite(page_id).Drop();
+  EXPECT_FALSE(guard.Validate());
+
+  // a guard taken while the page is write-latched never validates
+  auto write_guard = bpm->FetchPageWrite(page_id);
+  auto during_write = bpm->FetchPageOptimistic(page_id);
+  write_guard.Drop();
+  EXPECT_FALSE(during_write.Validate());
+  EXPECT_TRUE(bpm->FetchPageOptimistic(page_id).Validate());
+
+  guard.Drop();
+  during_write.Drop();
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(PageGuardTest, OptimisticIndexReadTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  auto *disk_manager = new DiskManagerUnlimitedMemory();
+  auto *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  page_id_t page_id;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  // small nodes, so that the writers split and merge all the time
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 5);
+
+  const int64_t num_keys = 2000;
+  GenericKey<8> index_key;
+  RID rid;
+  Transaction transaction(0);
+  for (int64_t key = 0; key < num_keys; key += 2) {
+    index_key.SetFromInteger(key);
+    rid.Set(0, key);
+    tree.Insert(index_key, rid, &transaction);
+  }
+
+  // even keys are never touched by the writers, odd keys come and go
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 2; i++) {
+    threads.emplace_back([&, i] {
+      Transaction txn(i + 1);
+      GenericKey<8> key;
+      RID value;
+      while (!stop) {
+        for (int64_t k = 1 + 2 * i; k < num_keys; k += 4) {
+          key.SetFromInteger(k);
+          value.Set(0, k);
+          tree.Insert(key, value, &txn);
+        }
+        for (int64_t k = 1 + 2 * i; k < num_keys; k += 4) {
+          key.SetFromInteger(k);
+          tree.Remove(key, &txn);
+        }
+      }
+    });
+  }
+  std::atomic<int64_t> wrong{0};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 2; i++) {
+    readers.emplace_back([&] {
+      GenericKey<8> key;
+      for (int round = 0; round < 3; round++) {
+        for (int64_t k = 0; k < num_keys; k += 2) {
+          key.SetFromInteger(k);
+          std::vector<RID> result;
+          if (!tree.GetValue(key, &result) || result.size() != 1 || result[0].GetSlotNum() != k) {
+            wrong++;
+          }
+        }
+      }
+    });
+  }
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, wrong);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,198 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/config.h"
+#include "concurrency/transaction.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/generic_key.h"
+#include "test_util.h"  // NOLINT
+
+#include <sys/time.h>
+
+auto ClockMs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
+}
+
+static const uint64_t BUSTUB_B_PLUS_TREE_BENCH_DURATION_MS = 2000;
+static const size_t BUSTUB_B_PLUS_TREE_BENCH_KEYS = 100000;
+static const size_t BUSTUB_B_PLUS_TREE_BENCH_READERS = 4;
+static const size_t BUSTUB_B_PLUS_TREE_BENCH_WRITERS = 1;
+static const size_t BUSTUB_B_PLUS_TREE_BENCH_POOL_SIZE = 4096;
+
+using Tree = bustub::BPlusTree<bustub::GenericKey<8>, bustub::RID, bustub::GenericComparator<8>>;
+using InternalPage = bustub::BPlusTreeInternalPage<bustub::GenericKey<8>, bustub::page_id_t, bustub::GenericComparator<8>>;
+
+struct RunResult {
+  uint64_t lookups_{0};
+  uint64_t writes_{0};
+  uint64_t fallbacks_{0};
+  uint64_t elapsed_ms_{1};
+};
+
+/** @return the number of levels of the tree, 0 if it is empty */
+auto TreeHeight(Tree *tree, bustub::BufferPoolManager *bpm) -> size_t {
+  size_t height = 0;
+  auto page_id = tree->GetRootPageId();
+  while (page_id != bustub::INVALID_PAGE_ID) {
+    auto guard = bpm->FetchPageRead(page_id);
+    height++;
+    auto tree_page = guard.As<bustub::BPlusTreePage>();
+    page_id = tree_page->IsLeafPage() ? bustub::INVALID_PAGE_ID : guard.As<InternalPage>()->ValueAt(0);
+  }
+  return height;
+}
+
+/**
+ * Point lookups of the even keys by readers, while writers keep inserting and removing the odd keys, so that leaves
+ * split and merge under the readers.
+ */
+auto RunLookups(Tree *tree, size_t num_keys, size_t num_readers, size_t num_writers, uint64_t duration_ms)
+    -> RunResult {
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> lookups{0};
+  std::atomic<uint64_t> writes{0};
+  auto fallbacks_before = tree->GetOptimisticFallbacks();
+
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < num_readers; i++) {
+    threads.emplace_back([&, i] {
+      std::mt19937 gen(i);
+      std::uniform_int_distribution<int64_t> dist(0, static_cast<int64_t>(num_keys / 2) - 1);
+      bustub::GenericKey<8> key;
+      uint64_t local = 0;
+      while (!stop) {
+        key.SetFromInteger(2 * dist(gen));
+        std::vector<bustub::RID> result;
+        tree->GetValue(key, &result);
+        local++;
+      }
+      lookups += local;
+    });
+  }
+  for (size_t i = 0; i < num_writers; i++) {
+    threads.emplace_back([&, i] {
+      bustub::Transaction txn(static_cast<bustub::txn_id_t>(i));
+      bustub::GenericKey<8> key;
+      bustub::RID rid;
+      uint64_t local = 0;
+      while (!stop) {
+        for (size_t k = 1 + 2 * i; k < num_keys && !stop; k += 2 * num_writers) {
+          key.SetFromInteger(static_cast<int64_t>(k));
+          rid.Set(0, k);
+          tree->Insert(key, rid, &txn);
+          local++;
+        }
+        for (size_t k = 1 + 2 * i; k < num_keys && !stop; k += 2 * num_writers) {
+          key.SetFromInteger(static_cast<int64_t>(k));
+          tree->Remove(key, &txn);
+          local++;
+        }
+      }
+      writes += local;
+    });
+  }
+
+  auto start = ClockMs();
+  std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  RunResult result;
+  result.elapsed_ms_ = std::max<uint64_t>(ClockMs() - start, 1);
+  result.lookups_ = lookups;
+  result.writes_ = writes;
+  result.fallbacks_ = tree->GetOptimisticFallbacks() - fallbacks_before;
+  return result;
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-b-plus-tree-bench");
+  program.add_argument("--duration").help("run each configuration for n milliseconds");
+  program.add_argument("--keys").help("number of keys, half of them are looked up and half are written");
+  program.add_argument("--readers").help("number of threads doing point lookups");
+  program.add_argument("--writers").help("number of threads inserting and removing keys");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  uint64_t duration_ms = BUSTUB_B_PLUS_TREE_BENCH_DURATION_MS;
+  size_t num_keys = BUSTUB_B_PLUS_TREE_BENCH_KEYS;
+  size_t num_readers = BUSTUB_B_PLUS_TREE_BENCH_READERS;
+  size_t num_writers = BUSTUB_B_PLUS_TREE_BENCH_WRITERS;
+  if (program.present("--duration")) {
+    duration_ms = std::stoul(program.get("--duration"));
+  }
+  if (program.present("--keys")) {
+    num_keys = std::max<size_t>(std::stoul(program.get("--keys")), 2);
+  }
+  if (program.present("--readers")) {
+    num_readers = std::stoul(program.get("--readers"));
+  }
+  if (program.present("--writers")) {
+    num_writers = std::stoul(program.get("--writers"));
+  }
+
+  auto key_schema = bustub::ParseCreateStatement("a bigint");
+  bustub::GenericComparator<8> comparator(key_schema.get());
+  auto disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(BUSTUB_B_PLUS_TREE_BENCH_POOL_SIZE,
+                                                                  disk_manager.get());
+  bustub::page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  Tree tree("bench_pk", bpm.get(), comparator);
+
+  bustub::Transaction txn(0);
+  bustub::GenericKey<8> key;
+  bustub::RID rid;
+  for (size_t k = 0; k < num_keys; k += 2) {
+    key.SetFromInteger(static_cast<int64_t>(k));
+    rid.Set(0, k);
+    tree.Insert(key, rid, &txn);
+  }
+  auto height = TreeHeight(&tree, bpm.get());
+
+  fmt::print("<<< BEGIN\n");
+  fmt::print("keys={} readers={} writers={} height={} duration_ms={}\n", num_keys, num_readers, num_writers, height,
+             duration_ms);
+  fmt::print("{:>12} {:>14} {:>12} {:>14} {:>12} {:>16}\n", "mode", "lookups/s", "ns/lookup", "writes/s", "fallbacks",
+             "latches/lookup");
+  for (bool optimistic : {false, true}) {
+    bustub::optimistic_index_reads = optimistic;
+    auto result = RunLookups(&tree, num_keys, num_readers, num_writers, duration_ms);
+    auto lookups = std::max<uint64_t>(result.lookups_, 1);
+    // 悲观查找每层都要加读锁；乐观查找只有退回时才加锁
+    double latches = optimistic ? static_cast<double>(result.fallbacks_ * height) / static_cast<double>(lookups)
+                                : static_cast<double>(height);
+    // 每个读线程上一次查找的平均耗时
+    double ns_per_lookup =
+        static_cast<double>(result.elapsed_ms_ * num_readers) * 1000000 / static_cast<double>(lookups);
+    fmt::print("{:>12} {:>14.0f} {:>12.0f} {:>14.0f} {:>12} {:>16.3f}\n", optimistic ? "optimistic" : "pessimistic",
+               static_cast<double>(result.lookups_) / static_cast<double>(result.elapsed_ms_) * 1000, ns_per_lookup,
+               static_cast<double>(result.writes_) / static_cast<double>(result.elapsed_ms_) * 1000, result.fallbacks_,
+               latches);
+  }
+  fmt::print(">>> END\n");
+
+  bpm->UnpinPage(header_page_id, true);
+  return 0;
+}
@@ -0,0 +1,440 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/page_table.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "container/hash/extendible_hash_table.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager_memory.h"
+
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+auto ClockMs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
+}
+
+static const size_t BUSTUB_BPM_BENCH_POOL_SIZE = 1024;
+static const size_t BUSTUB_BPM_BENCH_INSTANCES = 8;
+static const size_t BUSTUB_BPM_BENCH_MAX_THREADS = 32;
+static const uint64_t BUSTUB_BPM_BENCH_DURATION_MS = 2000;
+static const size_t BUSTUB_BPM_BENCH_SCAN_PAGES = 2048;
+static const uint64_t BUSTUB_BPM_BENCH_READ_LATENCY_US = 100;
+static const size_t BUSTUB_BPM_BENCH_ARENA_POOL_SIZE = 65536;
+
+/** A hardware event counted for the calling thread with perf_event_open(2). Reads -1 if the event is unavailable. */
+class PerfCounter {
+ public:
+  PerfCounter(uint32_t type, uint64_t config) {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+  }
+
+  ~PerfCounter() {
+    if (fd_ >= 0) {
+      close(fd_);
+    }
+  }
+
+  void Start() {
+    if (fd_ >= 0) {
+      ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+      ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+  }
+
+  auto Stop() -> int64_t {
+    int64_t count = -1;
+    if (fd_ < 0) {
+      return count;
+    }
+    ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+    if (read(fd_, &count, sizeof(count)) != sizeof(count)) {
+      count = -1;
+    }
+    return count;
+  }
+
+ private:
+  int fd_;
+};
+
+/** An in-memory disk manager where every read takes a fixed time, like a device with a given access latency. */
+class SlowDiskManager : public bustub::DiskManagerUnlimitedMemory {
+ public:
+  explicit SlowDiskManager(uint64_t read_latency_us) : read_latency_us_(read_latency_us) {}
+
+  void ReadPage(bustub::page_id_t page_id, char *page_data) override {
+    std::this_thread::sleep_for(std::chrono::microseconds(read_latency_us_));
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+ private:
+  uint64_t read_latency_us_;
+};
+
+/**
+ * Every thread repeatedly fetches and unpins uniformly random pages until the deadline is reached. The working set is
+ * smaller than the pool, so after the warm-up all accesses are hits and the measured cost is dominated by the buffer
+ * pool latch(es) rather than by the disk.
+ */
+auto RunFetchUnpin(bustub::BufferPoolManager *bpm, const std::vector<bustub::page_id_t> &page_ids,
+                   size_t thread_cnt, uint64_t duration_ms) -> double {
+  std::atomic<uint64_t> total_ops{0};
+  std::vector<std::thread> threads;
+  auto start = ClockMs();
+  for (size_t thread_id = 0; thread_id < thread_cnt; thread_id++) {
+    threads.emplace_back([&, thread_id] {
+      std::mt19937 gen(thread_id);
+      std::uniform_int_distribution<size_t> dis(0, page_ids.size() - 1);
+      uint64_t ops = 0;
+      while (ClockMs() - start < duration_ms) {
+        for (size_t i = 0; i < 256; i++) {
+          auto page_id = page_ids[dis(gen)];
+          auto *page = bpm->FetchPage(page_id);
+          if (page == nullptr) {
+            continue;
+          }
+          bpm->UnpinPage(page_id, false);
+          ops++;
+        }
+      }
+      total_ops += ops;
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = ClockMs() - start;
+  return static_cast<double>(total_ops) / static_cast<double>(elapsed) * 1000;
+}
+
+/**
+ * Every thread repeatedly looks up uniformly random resident pages in the page table until the deadline is reached.
+ * This isolates the cost of the page table lookup on the FetchPage hit path.
+ */
+template <typename FindFn>
+auto RunPageTableFind(FindFn find, size_t page_cnt, size_t thread_cnt, uint64_t duration_ms) -> double {
+  std::atomic<uint64_t> total_ops{0};
+  std::vector<std::thread> threads;
+  auto start = ClockMs();
+  for (size_t thread_id = 0; thread_id < thread_cnt; thread_id++) {
+    threads.emplace_back([&, thread_id] {
+      std::mt19937 gen(thread_id);
+      std::uniform_int_distribution<bustub::page_id_t> dis(0, page_cnt - 1);
+      uint64_t ops = 0;
+      while (ClockMs() - start < duration_ms) {
+        for (size_t i = 0; i < 256; i++) {
+          bustub::frame_id_t frame_id;
+          if (find(dis(gen), &frame_id)) {
+            ops++;
+          }
+        }
+      }
+      total_ops += ops;
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  auto elapsed = ClockMs() - start;
+  return static_cast<double>(total_ops) / static_cast<double>(elapsed) * 1000;
+}
+
+auto PreparePages(bustub::BufferPoolManager *bpm, size_t page_cnt) -> std::vector<bustub::page_id_t> {
+  std::vector<bustub::page_id_t> page_ids;
+  for (size_t i = 0; i < page_cnt; i++) {
+    bustub::page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    if (page == nullptr) {
+      break;
+    }
+    page_ids.push_back(page_id);
+    bpm->UnpinPage(page_id, true);
+  }
+  return page_ids;
+}
+
+/**
+ * Scan scan_pages pages in order on a cold buffer pool, keeping read_ahead_window pages prefetched in front of the
+ * scan the way TableIterator does. Returns the scan throughput in pages per second.
+ */
+auto RunColdScan(size_t pool_size, size_t scan_pages, size_t read_ahead_window, uint64_t read_latency_us) -> double {
+  auto disk_manager = std::make_unique<SlowDiskManager>(read_latency_us);
+  auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(pool_size, disk_manager.get());
+  // write the pages out, then push them all out of the pool so that the scan starts cold
+  auto page_ids = PreparePages(bpm.get(), scan_pages);
+  bpm->FlushAllPages();
+  PreparePages(bpm.get(), pool_size);
+
+  auto start = ClockMs();
+  size_t read_ahead_end = 0;
+  for (size_t i = 0; i < page_ids.size(); i++) {
+    if (read_ahead_window > 0 && read_ahead_end < i + read_ahead_window / 2 + 1) {
+      std::vector<bustub::page_id_t> prefetch;
+      for (size_t j = std::max(read_ahead_end, i + 1); j < std::min(i + 1 + read_ahead_window, page_ids.size()); j++) {
+        prefetch.push_back(page_ids[j]);
+      }
+      read_ahead_end = i + 1 + read_ahead_window;
+      bpm->PrefetchPages(prefetch);
+    }
+    auto *page = bpm->FetchPage(page_ids[i]);
+    if (page != nullptr) {
+      bpm->UnpinPage(page_ids[i], false);
+    }
+  }
+  auto elapsed = std::max<uint64_t>(ClockMs() - start, 1);
+  return static_cast<double>(page_ids.size()) / static_cast<double>(elapsed) * 1000;
+}
+
+/** An in-memory disk manager that counts the reads of the pages below a given page id. */
+class HotReadCountingDiskManager : public bustub::DiskManagerUnlimitedMemory {
+ public:
+  explicit HotReadCountingDiskManager(bustub::page_id_t hot_page_end) : hot_page_end_(hot_page_end) {}
+
+  void ReadPage(bustub::page_id_t page_id, char *page_data) override {
+    if (page_id < hot_page_end_) {
+      hot_reads_++;
+    }
+    DiskManagerUnlimitedMemory::ReadPage(page_id, page_data);
+  }
+
+  auto GetHotReads() const -> uint64_t { return hot_reads_; }
+
+ private:
+  bustub::page_id_t hot_page_end_;
+  std::atomic<uint64_t> hot_reads_{0};
+};
+
+/**
+ * One thread does point lookups on a hot set of half the pool while another thread scans scan_pages other pages over
+ * and over, with or without a BufferAccessStrategy. Returns the hit rate of the point lookups.
+ */
+auto RunScanPollution(size_t pool_size, size_t scan_pages, bool use_strategy, uint64_t duration_ms) -> double {
+  const size_t hot_cnt = pool_size / 2;
+  auto disk_manager = std::make_unique<HotReadCountingDiskManager>(static_cast<bustub::page_id_t>(hot_cnt));
+  auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(pool_size, disk_manager.get());
+  auto hot_pages = PreparePages(bpm.get(), hot_cnt);
+  auto scan_page_ids = PreparePages(bpm.get(), scan_pages);
+  bpm->FlushAllPages();
+  for (auto page_id : hot_pages) {
+    if (bpm->FetchPage(page_id) != nullptr) {
+      bpm->UnpinPage(page_id, false);
+    }
+  }
+  const uint64_t hot_reads_before = disk_manager->GetHotReads();
+
+  std::atomic<bool> stop{false};
+  std::thread scanner([&] {
+    while (!stop) {
+      bustub::BufferAccessStrategy strategy;
+      for (auto page_id : scan_page_ids) {
+        if (bpm->FetchPageWithStrategy(page_id, use_strategy ? &strategy : nullptr) != nullptr) {
+          bpm->UnpinPage(page_id, false);
+        }
+      }
+    }
+  });
+  uint64_t lookups = 0;
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<size_t> dist(0, hot_pages.size() - 1);
+  auto start = ClockMs();
+  while (ClockMs() - start < duration_ms) {
+    auto page_id = hot_pages[dist(gen)];
+    if (bpm->FetchPage(page_id) != nullptr) {
+      bpm->UnpinPage(page_id, false);
+    }
+    lookups++;
+  }
+  stop = true;
+  scanner.join();
+  auto misses = static_cast<double>(disk_manager->GetHotReads() - hot_reads_before);
+  return 1 - misses / static_cast<double>(std::max<uint64_t>(lookups, 1));
+}
+
+struct ArenaResult {
+  bustub::HugePageMode actual_mode_;
+  double ns_per_fetch_;
+  double dtlb_misses_per_fetch_;
+};
+
+/**
+ * Fetch uniformly random resident pages of a large pool from one thread and read a word at a random offset of each,
+ * with the frames backed as requested by mode. Counts the data TLB misses of the loop with perf counters.
+ */
+auto RunArenaFetch(bustub::HugePageMode mode, size_t pool_size, uint64_t duration_ms) -> ArenaResult {
+  bustub::buffer_pool_huge_pages = mode;
+  auto disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(pool_size, disk_manager.get());
+  bustub::buffer_pool_huge_pages = bustub::HugePageMode::TRANSPARENT;
+  auto page_ids = PreparePages(bpm.get(), pool_size);
+
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<size_t> page_dis(0, page_ids.size() - 1);
+  std::uniform_int_distribution<size_t> offset_dis(0, bustub::BUSTUB_PAGE_SIZE / sizeof(uint64_t) - 1);
+  PerfCounter dtlb_misses(PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                                                  (PERF_COUNT_HW_CACHE_RESULT_MISS << 16));
+  uint64_t ops = 0;
+  uint64_t checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+  auto deadline = start + std::chrono::milliseconds(duration_ms);
+  dtlb_misses.Start();
+  while (std::chrono::steady_clock::now() < deadline) {
+    for (size_t i = 0; i < 256; i++) {
+      auto page_id = page_ids[page_dis(gen)];
+      auto *page = bpm->FetchPage(page_id);
+      checksum += reinterpret_cast<const uint64_t *>(page->GetData())[offset_dis(gen)];
+      bpm->UnpinPage(page_id, false);
+      ops++;
+    }
+  }
+  auto misses = dtlb_misses.Stop();
+  auto elapsed = std::chrono::steady_clock::now() - start;
+  if (checksum != 0) {
+    fmt::print("unexpected non-zero page data\n");
+  }
+  return {bpm->GetFrameArena()->GetHugePageMode(),
+          static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+              static_cast<double>(ops),
+          misses < 0 ? -1 : static_cast<double>(misses) / static_cast<double>(ops)};
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-bpm-bench");
+  program.add_argument("--duration").help("run each configuration for n milliseconds");
+  program.add_argument("--pool-size").help("total number of frames in the buffer pool");
+  program.add_argument("--instances").help("number of instances of the parallel buffer pool");
+  program.add_argument("--max-threads").help("largest thread count to run with");
+  program.add_argument("--scan-pages").help("number of pages in the cold scan");
+  program.add_argument("--read-latency-us").help("simulated latency of a page read in the cold scan");
+  program.add_argument("--arena-pool-size").help("number of frames in the huge page comparison");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  uint64_t duration_ms = BUSTUB_BPM_BENCH_DURATION_MS;
+  size_t pool_size = BUSTUB_BPM_BENCH_POOL_SIZE;
+  size_t num_instances = BUSTUB_BPM_BENCH_INSTANCES;
+  size_t max_threads = BUSTUB_BPM_BENCH_MAX_THREADS;
+  if (program.present("--duration")) {
+    duration_ms = std::stoul(program.get("--duration"));
+  }
+  if (program.present("--pool-size")) {
+    pool_size = std::stoul(program.get("--pool-size"));
+  }
+  if (program.present("--instances")) {
+    num_instances = std::stoul(program.get("--instances"));
+  }
+  if (program.present("--max-threads")) {
+    max_threads = std::stoul(program.get("--max-threads"));
+  }
+  size_t scan_pages = BUSTUB_BPM_BENCH_SCAN_PAGES;
+  uint64_t read_latency_us = BUSTUB_BPM_BENCH_READ_LATENCY_US;
+  if (program.present("--scan-pages")) {
+    scan_pages = std::stoul(program.get("--scan-pages"));
+  }
+  if (program.present("--read-latency-us")) {
+    read_latency_us = std::stoul(program.get("--read-latency-us"));
+  }
+  size_t arena_pool_size = BUSTUB_BPM_BENCH_ARENA_POOL_SIZE;
+  if (program.present("--arena-pool-size")) {
+    arena_pool_size = std::stoul(program.get("--arena-pool-size"));
+  }
+
+  auto single_disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+  auto parallel_disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+  auto single = std::make_unique<bustub::BufferPoolManagerInstance>(pool_size, single_disk_manager.get());
+  auto parallel = std::make_unique<bustub::ParallelBufferPoolManager>(num_instances, pool_size / num_instances,
+                                                                      parallel_disk_manager.get());
+
+  // keep the working set inside the pool so that the benchmark measures latch contention only
+  auto single_pages = PreparePages(single.get(), pool_size / 2);
+  auto parallel_pages = PreparePages(parallel.get(), pool_size / 2);
+
+  fmt::print("<<< BEGIN\n");
+  fmt::print("pool_size={} instances={} duration_ms={}\n", pool_size, num_instances, duration_ms);
+  fmt::print("{:>8} {:>16} {:>16} {:>8}\n", "threads", "single ops/s", "parallel ops/s", "speedup");
+  for (size_t thread_cnt = 1; thread_cnt <= max_threads; thread_cnt *= 2) {
+    auto single_ops = RunFetchUnpin(single.get(), single_pages, thread_cnt, duration_ms);
+    auto parallel_ops = RunFetchUnpin(parallel.get(), parallel_pages, thread_cnt, duration_ms);
+    fmt::print("{:>8} {:>16.0f} {:>16.0f} {:>8.2f}\n", thread_cnt, single_ops, parallel_ops, parallel_ops / single_ops);
+  }
+
+  // the same comparison for the page table alone: the old extendible hash table vs. the lock-free page table
+  bustub::ExtendibleHashTable<bustub::page_id_t, bustub::frame_id_t> extendible_table(4);
+  bustub::PageTable page_table(pool_size);
+  for (size_t i = 0; i < pool_size; i++) {
+    extendible_table.Insert(i, i);
+    page_table.Insert(i, i);
+  }
+  fmt::print("{:>8} {:>16} {:>16} {:>8}\n", "threads", "extendible ops/s", "page table ops/s", "speedup");
+  for (size_t thread_cnt = 1; thread_cnt <= max_threads; thread_cnt *= 2) {
+    auto extendible_ops = RunPageTableFind(
+        [&](bustub::page_id_t page_id, bustub::frame_id_t *frame_id) {
+          return extendible_table.Find(page_id, *frame_id);
+        },
+        pool_size, thread_cnt, duration_ms);
+    auto page_table_ops = RunPageTableFind(
+        [&](bustub::page_id_t page_id, bustub::frame_id_t *frame_id) { return page_table.Find(page_id, *frame_id); },
+        pool_size, thread_cnt, duration_ms);
+    fmt::print("{:>8} {:>16.0f} {:>16.0f} {:>8.2f}\n", thread_cnt, extendible_ops, page_table_ops,
+               page_table_ops / extendible_ops);
+  }
+
+  // cold sequential scan with and without read-ahead
+  fmt::print("cold scan: pages={} read_latency_us={} ideal pages/s={:.0f}\n", scan_pages, read_latency_us,
+             1e6 / static_cast<double>(std::max<uint64_t>(read_latency_us, 1)) * bustub::PREFETCH_WORKER_NUM);
+  fmt::print("{:>8} {:>16}\n", "window", "pages/s");
+  for (size_t window : {0, 4, 8, 16, 32}) {
+    fmt::print("{:>8} {:>16.0f}\n", window, RunColdScan(pool_size, scan_pages, window, read_latency_us));
+  }
+
+  // point lookups on a hot set while a large table is scanned concurrently
+  fmt::print("scan pollution: hot_pages={} scan_pages={}\n", pool_size / 2, scan_pages);
+  fmt::print("{:>16} {:>16}\n", "no strategy hit", "strategy hit");
+  fmt::print("{:>16.4f} {:>16.4f}\n", RunScanPollution(pool_size, scan_pages, false, duration_ms),
+             RunScanPollution(pool_size, scan_pages, true, duration_ms));
+
+  // random hits on a large pool with the frames backed by ordinary, transparent huge and explicit huge pages
+  fmt::print("frame arena: pool_size={} ({} MB)\n", arena_pool_size,
+             arena_pool_size * bustub::BUSTUB_PAGE_SIZE >> 20);
+  fmt::print("{:>12} {:>12} {:>12} {:>16}\n", "requested", "actual", "ns/fetch", "dTLB miss/fetch");
+  const char *mode_names[] = {"none", "transparent", "explicit"};
+  for (auto mode : {bustub::HugePageMode::NONE, bustub::HugePageMode::TRANSPARENT, bustub::HugePageMode::EXPLICIT}) {
+    auto result = RunArenaFetch(mode, arena_pool_size, duration_ms);
+    auto dtlb = result.dtlb_misses_per_fetch_ < 0 ? std::string("n/a")
+                                                  : fmt::format("{:.3f}", result.dtlb_misses_per_fetch_);
+    fmt::print("{:>12} {:>12} {:>12.1f} {:>16}\n", mode_names[static_cast<int>(mode)],
+               mode_names[static_cast<int>(result.actual_mode_)], result.ns_per_fetch_, dtlb);
+  }
+  fmt::print(">>> END\n");
+
+  return 0;
+}
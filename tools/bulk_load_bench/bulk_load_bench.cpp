@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "catalog/catalog.h"
+#include "common/config.h"
+#include "concurrency/transaction.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "type/value_factory.h"
+
+static const size_t BUSTUB_BULK_LOAD_BENCH_ROWS = 100000;
+static const size_t BUSTUB_BULK_LOAD_BENCH_POOL_SIZE = 1024;
+
+using KeyType = bustub::GenericKey<8>;
+using ComparatorType = bustub::GenericComparator<8>;
+using Index = bustub::BPlusTreeIndex<KeyType, bustub::RID, ComparatorType>;
+
+/** @return the number of leaves of the index, found by walking its leaf chain */
+auto CountLeaves(Index *index) -> size_t {
+  size_t leaves = 0;
+  auto prev_page_id = bustub::INVALID_PAGE_ID;
+  for (auto it = index->GetBeginIterator(); it != index->GetEndIterator(); ++it) {
+    if (it.GetPageId() != prev_page_id) {
+      leaves++;
+      prev_page_id = it.GetPageId();
+    }
+  }
+  return leaves;
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-bulk-load-bench");
+  program.add_argument("--rows").help("rows in the table the index is created on");
+  program.add_argument("--fill-factor").help("fill factor of the bulk-loaded index");
+  program.add_argument("--pool-size").help("frames of the buffer pool");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  size_t num_rows = BUSTUB_BULK_LOAD_BENCH_ROWS;
+  size_t pool_size = BUSTUB_BULK_LOAD_BENCH_POOL_SIZE;
+  if (program.present("--rows")) {
+    num_rows = std::stoul(program.get("--rows"));
+  }
+  if (program.present("--fill-factor")) {
+    bustub::index_fill_factor = std::stod(program.get("--fill-factor"));
+  }
+  if (program.present("--pool-size")) {
+    pool_size = std::stoul(program.get("--pool-size"));
+  }
+
+  auto disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+  auto bpm = std::make_unique<bustub::BufferPoolManagerInstance>(pool_size, disk_manager.get());
+  bustub::page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+  auto catalog = std::make_unique<bustub::Catalog>(bpm.get(), nullptr, nullptr);
+  bustub::Transaction txn(0);
+
+  bustub::Schema schema({bustub::Column("a", bustub::TypeId::BIGINT), bustub::Column("b", bustub::TypeId::BIGINT)});
+  bustub::Schema key_schema({bustub::Column("a", bustub::TypeId::BIGINT)});
+  const std::vector<uint32_t> key_attrs{0};
+  auto *table_info = catalog->CreateTable(&txn, "t", schema);
+
+  // 表里的key是乱序的，逐条插入时每个key都落在树上随机的位置
+  std::vector<int64_t> keys(num_rows);
+  std::iota(keys.begin(), keys.end(), 0);
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(0));
+  for (auto key : keys) {
+    bustub::Tuple tuple({bustub::ValueFactory::GetBigIntValue(key), bustub::ValueFactory::GetBigIntValue(key)},
+                        &schema);
+    bustub::RID rid;
+    table_info->table_->InsertTuple(tuple, &rid, &txn);
+  }
+
+  fmt::print("<<< BEGIN\n");
+  fmt::print("rows={} pool_size={} fill_factor={}\n", num_rows, pool_size, bustub::index_fill_factor);
+  fmt::print("{:>8} {:>10} {:>12} {:>8}\n", "mode", "ms", "rows/s", "leaves");
+  auto print_result = [num_rows](const char *mode, std::chrono::steady_clock::duration elapsed, Index *index) {
+    const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count();
+    fmt::print("{:>8} {:>10} {:>12.0f} {:>8}\n", mode, ms,
+               static_cast<double>(num_rows) * 1000.0 / static_cast<double>(std::max<int64_t>(ms, 1)),
+               CountLeaves(index));
+  };
+
+  // 只扫描表并取出key，两种建索引方式都要付出这部分开销
+  {
+    auto start = std::chrono::steady_clock::now();
+    size_t key_bytes = 0;
+    bustub::BufferAccessStrategy strategy;
+    for (auto tuple = table_info->table_->Begin(&txn, &strategy); tuple != table_info->table_->End(); ++tuple) {
+      key_bytes += tuple->KeyFromTuple(schema, key_schema, key_attrs).GetLength();
+    }
+    const auto ms =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    fmt::print("{:>8} {:>10} {:>12.0f} {:>8}\n", "scan", ms,
+               static_cast<double>(key_bytes / 8) * 1000.0 / static_cast<double>(std::max<int64_t>(ms, 1)), "-");
+  }
+
+  // 原来CreateIndex的做法：扫描表，每个tuple从根节点插入一次
+  {
+    auto start = std::chrono::steady_clock::now();
+    auto meta = std::make_unique<bustub::IndexMetadata>("t_insert", "t", &schema, key_attrs);
+    Index index(std::move(meta), bpm.get());
+    bustub::BufferAccessStrategy strategy;
+    for (auto tuple = table_info->table_->Begin(&txn, &strategy); tuple != table_info->table_->End(); ++tuple) {
+      index.InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), &txn);
+    }
+    print_result("insert", std::chrono::steady_clock::now() - start, &index);
+  }
+
+  {
+    auto start = std::chrono::steady_clock::now();
+    auto *index_info = catalog->CreateIndex<KeyType, bustub::RID, ComparatorType>(
+        &txn, "t_bulk", "t", schema, key_schema, key_attrs, 8, bustub::HashFunction<KeyType>{});
+    print_result("bulk", std::chrono::steady_clock::now() - start, dynamic_cast<Index *>(index_info->index_.get()));
+  }
+  fmt::print(">>> END\n");
+  return 0;
+}
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "common/config.h"
+#include "common/util/crc32c_util.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+
+static const size_t BUSTUB_CHECKSUM_BENCH_PAGES = 8192;
+static const size_t BUSTUB_CHECKSUM_BENCH_ROUNDS = 20;
+static const size_t BUSTUB_CHECKSUM_BENCH_BATCH = 64;
+
+/** @return the nanoseconds fn takes per call, over rounds calls */
+template <typename Fn>
+auto NsPerCall(size_t rounds, Fn fn) -> double {
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < rounds; i++) {
+    fn();
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+         static_cast<double>(rounds);
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-checksum-bench");
+  program.add_argument("--pages").help("number of pages checksummed, written and read per round");
+  program.add_argument("--rounds").help("number of rounds");
+  program.add_argument("--file").help("database file to run against, it is created and removed by the benchmark");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  size_t num_pages = BUSTUB_CHECKSUM_BENCH_PAGES;
+  size_t rounds = BUSTUB_CHECKSUM_BENCH_ROUNDS;
+  std::string db_file = "checksum_bench.db";
+  if (program.present("--pages")) {
+    num_pages = std::max<size_t>(std::stoul(program.get("--pages")), 1);
+  }
+  if (program.present("--rounds")) {
+    rounds = std::max<size_t>(std::stoul(program.get("--rounds")), 1);
+  }
+  if (program.present("--file")) {
+    db_file = program.get("--file");
+  }
+
+  std::vector<char> data(num_pages * bustub::BUSTUB_PAGE_SIZE);
+  std::mt19937 gen(0);
+  for (auto &c : data) {
+    c = static_cast<char>(gen());
+  }
+  const double page_bytes = bustub::BUSTUB_PAGE_SIZE;
+
+  fmt::print("<<< BEGIN\n");
+  fmt::print("pages={} rounds={} page_size={} sse4.2={}\n", num_pages, rounds, bustub::BUSTUB_PAGE_SIZE,
+             bustub::Crc32cUtil::HasHardwareSupport() ? "yes" : "no");
+
+  // 只算校验和：每个page的开销
+  fmt::print("{:>10} {:>12} {:>10}\n", "crc32c", "ns/page", "GB/s");
+  uint32_t sink = 0;
+  auto crc_run = [&](const char *name, auto crc) {
+    const double ns = NsPerCall(rounds, [&] {
+                        for (size_t i = 0; i < num_pages; i++) {
+                          sink ^= crc(data.data() + i * bustub::BUSTUB_PAGE_SIZE, bustub::BUSTUB_PAGE_SIZE, 0);
+                        }
+                      }) /
+                      static_cast<double>(num_pages);
+    fmt::print("{:>10} {:>12.1f} {:>10.2f}\n", name, ns, page_bytes / ns);
+  };
+  crc_run("software", bustub::Crc32cUtil::Crc32cSoftware);
+  if (bustub::Crc32cUtil::HasHardwareSupport()) {
+    crc_run("hardware", bustub::Crc32cUtil::Crc32cHardware);
+  }
+
+  // 经过DiskManager写入和读回（page cache里），打开和关闭校验和
+  fmt::print("{:>10} {:>14} {:>14} {:>14}\n", "checksums", "write ns/page", "batch ns/page", "read ns/page");
+  std::vector<char> buf(bustub::BUSTUB_PAGE_SIZE);
+  // 和page cleaner、FlushAllPages一样成批写，一批的校验和只sync一次
+  std::vector<bustub::page_id_t> batch_ids;
+  std::vector<const char *> batch_data;
+  for (bool checksums : {false, true}) {
+    bustub::page_checksums = checksums;
+    auto *disk_manager = new bustub::DiskManager(db_file);
+    const double write_ns = NsPerCall(rounds, [&] {
+                              for (size_t i = 0; i < num_pages; i++) {
+                                // 每轮都改一下page，和换出的脏页一样每次写的内容都是新的
+                                data[i * bustub::BUSTUB_PAGE_SIZE]++;
+                                disk_manager->WritePage(static_cast<bustub::page_id_t>(i),
+                                                        data.data() + i * bustub::BUSTUB_PAGE_SIZE);
+                              }
+                            }) /
+                            static_cast<double>(num_pages);
+    const double batch_ns = NsPerCall(rounds, [&] {
+                              for (size_t first = 0; first < num_pages; first += BUSTUB_CHECKSUM_BENCH_BATCH) {
+                                batch_ids.clear();
+                                batch_data.clear();
+                                for (size_t i = first; i < std::min(first + BUSTUB_CHECKSUM_BENCH_BATCH, num_pages);
+                                     i++) {
+                                  data[i * bustub::BUSTUB_PAGE_SIZE]++;
+                                  batch_ids.push_back(static_cast<bustub::page_id_t>(i));
+                                  batch_data.push_back(data.data() + i * bustub::BUSTUB_PAGE_SIZE);
+                                }
+                                disk_manager->WritePages(batch_ids, batch_data);
+                              }
+                            }) /
+                            static_cast<double>(num_pages);
+    const double read_ns = NsPerCall(rounds, [&] {
+                             for (size_t i = 0; i < num_pages; i++) {
+                               disk_manager->ReadPage(static_cast<bustub::page_id_t>(i), buf.data());
+                             }
+                           }) /
+                           static_cast<double>(num_pages);
+    fmt::print("{:>10} {:>14.1f} {:>14.1f} {:>14.1f}\n", checksums ? "on" : "off", write_ns, batch_ns, read_ns);
+    disk_manager->ShutDown();
+    delete disk_manager;
+    std::remove(db_file.c_str());
+  }
+  bustub::page_checksums = true;
+  fmt::print(">>> END\n");
+
+  auto base_name = db_file.substr(0, db_file.rfind('.'));
+  std::remove((base_name + ".log").c_str());
+  std::remove((base_name + ".fsm").c_str());
+  std::remove((base_name + ".crc").c_str());
+  return sink == 0xdeadbeef ? 1 : 0;
+}
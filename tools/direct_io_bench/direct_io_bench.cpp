@@ -0,0 +1,171 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/config.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+auto ClockMs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
+}
+
+static const uint64_t BUSTUB_DIRECT_IO_BENCH_DURATION_MS = 2000;
+static const size_t BUSTUB_DIRECT_IO_BENCH_PAGES = 32768;
+static const size_t BUSTUB_DIRECT_IO_BENCH_POOL_SIZE = 4096;
+static const size_t BUSTUB_DIRECT_IO_BENCH_THREADS = 4;
+
+/** Drop the pages of the file from the page cache of the kernel, so that every mode starts cold. */
+void DropPageCache(const std::string &file) {
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return;
+  }
+  fdatasync(fd);
+  posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED);
+  close(fd);
+}
+
+/** @return the number of bytes of the file that sit in the page cache of the kernel */
+auto PageCacheBytes(const std::string &file) -> size_t {
+  int fd = open(file.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return 0;
+  }
+  const off_t length = lseek(fd, 0, SEEK_END);
+  size_t resident = 0;
+  void *addr = length > 0 ? mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED;
+  if (addr != MAP_FAILED) {
+    const size_t os_page_size = sysconf(_SC_PAGESIZE);
+    std::vector<unsigned char> residency((length + os_page_size - 1) / os_page_size);
+    if (mincore(addr, length, residency.data()) == 0) {
+      resident = std::count_if(residency.begin(), residency.end(), [](unsigned char v) { return (v & 1) != 0; }) *
+                 os_page_size;
+    }
+    munmap(addr, length);
+  }
+  close(fd);
+  return resident;
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-direct-io-bench");
+  program.add_argument("--duration").help("run each mode for n milliseconds");
+  program.add_argument("--pages").help("size of the database file in pages");
+  program.add_argument("--pool-size").help("frames of the buffer pool");
+  program.add_argument("--threads").help("number of threads fetching random pages");
+  program.add_argument("--file").help("database file to run against, it is created and removed by the benchmark");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  uint64_t duration_ms = BUSTUB_DIRECT_IO_BENCH_DURATION_MS;
+  size_t num_pages = BUSTUB_DIRECT_IO_BENCH_PAGES;
+  size_t pool_size = BUSTUB_DIRECT_IO_BENCH_POOL_SIZE;
+  size_t num_threads = BUSTUB_DIRECT_IO_BENCH_THREADS;
+  std::string db_file = "direct_io_bench.db";
+  if (program.present("--duration")) {
+    duration_ms = std::stoul(program.get("--duration"));
+  }
+  if (program.present("--pages")) {
+    num_pages = std::max<size_t>(std::stoul(program.get("--pages")), 1);
+  }
+  if (program.present("--pool-size")) {
+    pool_size = std::max<size_t>(std::stoul(program.get("--pool-size")), num_threads);
+  }
+  if (program.present("--threads")) {
+    num_threads = std::max<size_t>(std::stoul(program.get("--threads")), 1);
+  }
+  if (program.present("--file")) {
+    db_file = program.get("--file");
+  }
+
+  {
+    bustub::DiskManager disk_manager(db_file);
+    std::vector<char> page(bustub::BUSTUB_PAGE_SIZE, 'x');
+    for (size_t i = 0; i < num_pages; i++) {
+      disk_manager.WritePage(static_cast<bustub::page_id_t>(i), page.data());
+    }
+    disk_manager.ShutDown();
+  }
+
+  fmt::print("<<< BEGIN\n");
+  fmt::print("file={} pages={} pool_size={} threads={} duration_ms={}\n", db_file, num_pages, pool_size, num_threads,
+             duration_ms);
+  fmt::print("{:>10} {:>8} {:>12} {:>10} {:>14} {:>10}\n", "mode", "direct", "fetches/s", "pool_MB", "page_cache_MB",
+             "total_MB");
+  for (bool direct_io : {false, true}) {
+    DropPageCache(db_file);
+    auto *disk_manager = new bustub::DiskManager(db_file, direct_io);
+    auto *bpm = new bustub::BufferPoolManagerInstance(pool_size, disk_manager);
+    // 让BPM知道这些page已经分配过了
+    for (size_t i = 0; i < num_pages; i++) {
+      bustub::page_id_t page_id;
+      bpm->NewPage(&page_id);
+      bpm->UnpinPage(page_id, false);
+    }
+
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> fetches{0};
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < num_threads; t++) {
+      threads.emplace_back([&, t] {
+        std::mt19937 gen(t);
+        std::uniform_int_distribution<bustub::page_id_t> dist(0, static_cast<bustub::page_id_t>(num_pages) - 1);
+        uint64_t local = 0;
+        while (!stop) {
+          auto page_id = dist(gen);
+          if (bpm->FetchPage(page_id) != nullptr) {
+            bpm->UnpinPage(page_id, false);
+            local++;
+          }
+        }
+        fetches += local;
+      });
+    }
+    auto start = ClockMs();
+    std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+    stop = true;
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    auto elapsed_ms = std::max<uint64_t>(ClockMs() - start, 1);
+
+    const double pool_mb = static_cast<double>(pool_size * bustub::BUSTUB_PAGE_SIZE) / (1024 * 1024);
+    const double cache_mb = static_cast<double>(PageCacheBytes(db_file)) / (1024 * 1024);
+    fmt::print("{:>10} {:>8} {:>12.0f} {:>10.1f} {:>14.1f} {:>10.1f}\n", direct_io ? "direct" : "buffered",
+               disk_manager->IsDirectIo() ? "yes" : "no",
+               static_cast<double>(fetches) / static_cast<double>(elapsed_ms) * 1000, pool_mb, cache_mb,
+               pool_mb + cache_mb);
+
+    delete bpm;
+    disk_manager->ShutDown();
+    delete disk_manager;
+  }
+  fmt::print(">>> END\n");
+
+  std::remove(db_file.c_str());
+  auto log_file = db_file.substr(0, db_file.rfind('.')) + ".log";
+  std::remove(log_file.c_str());
+  return 0;
+}
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <cstdio>
+#include <future>  // NOLINT
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "common/config.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
+
+#include <sys/time.h>
+
+auto ClockMs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
+}
+
+static const uint64_t BUSTUB_DISK_SCHEDULER_BENCH_DURATION_MS = 2000;
+static const size_t BUSTUB_DISK_SCHEDULER_BENCH_PAGES = 16384;
+static const size_t BUSTUB_DISK_SCHEDULER_BENCH_MAX_WORKERS = 16;
+
+struct RunResult {
+  uint64_t ios_{0};
+  uint64_t elapsed_ms_{1};
+};
+
+/**
+ * Random single-page requests from one thread, which keeps queue_depth of them in flight: every round schedules
+ * queue_depth requests and waits for all of them.
+ */
+auto RunRandomIo(bustub::DiskManager *disk_manager, size_t num_workers, size_t queue_depth, size_t num_pages,
+                 bool write, uint64_t duration_ms) -> RunResult {
+  bustub::DiskScheduler scheduler(disk_manager, num_workers);
+  std::vector<std::vector<char>> bufs(queue_depth, std::vector<char>(bustub::BUSTUB_PAGE_SIZE, 'x'));
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<bustub::page_id_t> dist(0, static_cast<bustub::page_id_t>(num_pages) - 1);
+
+  RunResult result;
+  auto start = ClockMs();
+  std::vector<std::future<void>> futures;
+  while (ClockMs() - start < duration_ms) {
+    futures.clear();
+    for (auto &buf : bufs) {
+      futures.push_back(scheduler.Schedule({write, {dist(gen)}, {buf.data()}, {}}));
+    }
+    for (auto &future : futures) {
+      future.get();
+    }
+    result.ios_ += queue_depth;
+  }
+  result.elapsed_ms_ = std::max<uint64_t>(ClockMs() - start, 1);
+  return result;
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-disk-scheduler-bench");
+  program.add_argument("--duration").help("run each configuration for n milliseconds");
+  program.add_argument("--pages").help("size of the database file in pages");
+  program.add_argument("--max-workers").help("largest number of worker threads, the runs double it from 1");
+  program.add_argument("--file").help("database file to run against, it is created and removed by the benchmark");
+  program.add_argument("--write").help("issue writes instead of reads").default_value(false).implicit_value(true);
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  uint64_t duration_ms = BUSTUB_DISK_SCHEDULER_BENCH_DURATION_MS;
+  size_t num_pages = BUSTUB_DISK_SCHEDULER_BENCH_PAGES;
+  size_t max_workers = BUSTUB_DISK_SCHEDULER_BENCH_MAX_WORKERS;
+  std::string db_file = "disk_scheduler_bench.db";
+  bool write = program.get<bool>("--write");
+  if (program.present("--duration")) {
+    duration_ms = std::stoul(program.get("--duration"));
+  }
+  if (program.present("--pages")) {
+    num_pages = std::max<size_t>(std::stoul(program.get("--pages")), 1);
+  }
+  if (program.present("--max-workers")) {
+    max_workers = std::max<size_t>(std::stoul(program.get("--max-workers")), 1);
+  }
+  if (program.present("--file")) {
+    db_file = program.get("--file");
+  }
+
+  auto *disk_manager = new bustub::DiskManager(db_file);
+  {
+    // 先把文件写满，随机读不会读到文件末尾之外
+    bustub::DiskScheduler scheduler(disk_manager);
+    std::vector<char> page(bustub::BUSTUB_PAGE_SIZE, 'x');
+    std::vector<bustub::page_id_t> page_ids;
+    std::vector<const char *> page_data;
+    for (size_t i = 0; i < num_pages; i++) {
+      page_ids.push_back(static_cast<bustub::page_id_t>(i));
+      page_data.push_back(page.data());
+    }
+    scheduler.WritePages(page_ids, page_data);
+  }
+
+  fmt::print("<<< BEGIN\n");
+  fmt::print("file={} pages={} op={} duration_ms={}\n", db_file, num_pages, write ? "write" : "read", duration_ms);
+  fmt::print("{:>8} {:>12} {:>12} {:>12}\n", "workers", "queue_depth", "IOPS", "MB/s");
+  for (size_t num_workers = 1; num_workers <= max_workers; num_workers *= 2) {
+    // 队列深度取worker数的两倍，worker取走一个请求时队列里总还有下一个
+    size_t queue_depth = 2 * num_workers;
+    auto result = RunRandomIo(disk_manager, num_workers, queue_depth, num_pages, write, duration_ms);
+    double iops = static_cast<double>(result.ios_) / static_cast<double>(result.elapsed_ms_) * 1000;
+    fmt::print("{:>8} {:>12} {:>12.0f} {:>12.1f}\n", num_workers, queue_depth, iops,
+               iops * bustub::BUSTUB_PAGE_SIZE / (1024 * 1024));
+  }
+  fmt::print(">>> END\n");
+
+  disk_manager->ShutDown();
+  delete disk_manager;
+  std::remove(db_file.c_str());
+  auto log_file = db_file.substr(0, db_file.rfind('.')) + ".log";
+  std::remove(log_file.c_str());
+  return 0;
+}
@@ -0,0 +1,183 @@
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/config.h"
+#include "concurrency/transaction.h"
+#include "fmt/core.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/index/b_plus_tree.h"
+#include "storage/index/generic_key.h"
+#include "storage/page/table_page.h"
+#include "storage/table/table_heap.h"
+#include "test_util.h"  // NOLINT
+#include "type/value_factory.h"
+
+static const size_t BUSTUB_EXTENT_BENCH_TABLES = 4;
+static const size_t BUSTUB_EXTENT_BENCH_INDEXES = 4;
+static const size_t BUSTUB_EXTENT_BENCH_ROWS = 5000;
+static const size_t BUSTUB_EXTENT_BENCH_POOL_SIZE = 256;
+/** Pages of the file that count as one region for the locality of a chain, 256 KB. */
+static const bustub::page_id_t BUSTUB_EXTENT_BENCH_REGION_PAGES = 64;
+
+using Tree = bustub::BPlusTree<bustub::GenericKey<8>, bustub::RID, bustub::GenericComparator<8>>;
+using InternalPage = bustub::BPlusTreeInternalPage<bustub::GenericKey<8>, bustub::page_id_t, bustub::GenericComparator<8>>;
+using LeafPage = bustub::BPlusTreeLeafPage<bustub::GenericKey<8>, bustub::RID, bustub::GenericComparator<8>>;
+
+/** How the pages of a chain, in the order a scan visits them, lie in the file. */
+struct ChainLayout {
+  size_t pages_{0};
+  /** Maximal runs of pages that follow each other in the file. */
+  size_t runs_{0};
+  /** Distinct regions of the file the chain touches. */
+  size_t regions_{0};
+
+  void Add(const std::vector<bustub::page_id_t> &chain) {
+    std::set<bustub::page_id_t> regions;
+    for (size_t i = 0; i < chain.size(); i++) {
+      if (i == 0 || chain[i] != chain[i - 1] + 1) {
+        runs_++;
+      }
+      regions.insert(chain[i] / BUSTUB_EXTENT_BENCH_REGION_PAGES);
+    }
+    pages_ += chain.size();
+    regions_ += regions.size();
+  }
+};
+
+/** @return the pages of the table in the order a sequential scan visits them */
+auto TableChain(bustub::TableHeap *table, bustub::BufferPoolManager *bpm) -> std::vector<bustub::page_id_t> {
+  std::vector<bustub::page_id_t> chain;
+  auto page_id = table->GetFirstPageId();
+  while (page_id != bustub::INVALID_PAGE_ID) {
+    chain.push_back(page_id);
+    auto *page = reinterpret_cast<bustub::TablePage *>(bpm->FetchPage(page_id));
+    const auto next_page_id = page->GetNextPageId();
+    bpm->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return chain;
+}
+
+/** @return the leaves of the tree in the order a range scan visits them */
+auto LeafChain(Tree *tree, bustub::BufferPoolManager *bpm) -> std::vector<bustub::page_id_t> {
+  std::vector<bustub::page_id_t> chain;
+  auto page_id = tree->GetRootPageId();
+  while (page_id != bustub::INVALID_PAGE_ID) {
+    auto guard = bpm->FetchPageRead(page_id);
+    if (guard.As<bustub::BPlusTreePage>()->IsLeafPage()) {
+      break;
+    }
+    page_id = guard.As<InternalPage>()->ValueAt(0);
+  }
+  while (page_id != bustub::INVALID_PAGE_ID) {
+    chain.push_back(page_id);
+    auto guard = bpm->FetchPageRead(page_id);
+    page_id = guard.As<LeafPage>()->GetNextPageId();
+  }
+  return chain;
+}
+
+void PrintLayout(const std::string &mode, const std::string &kind, const ChainLayout &layout) {
+  fmt::print("{:>10} {:>8} {:>8} {:>8} {:>14.1f} {:>10}\n", mode, kind, layout.pages_, layout.runs_,
+             static_cast<double>(layout.pages_) / static_cast<double>(std::max<size_t>(layout.runs_, 1)),
+             layout.regions_);
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-extent-bench");
+  program.add_argument("--tables").help("number of tables inserted into at the same time");
+  program.add_argument("--indexes").help("number of indexes inserted into at the same time");
+  program.add_argument("--rows").help("rows inserted into every table and index");
+  program.add_argument("--extent-size").help("maximum extent size in pages of the extent mode");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  size_t num_tables = BUSTUB_EXTENT_BENCH_TABLES;
+  size_t num_indexes = BUSTUB_EXTENT_BENCH_INDEXES;
+  size_t num_rows = BUSTUB_EXTENT_BENCH_ROWS;
+  size_t max_extent_size = bustub::extent_size;
+  if (program.present("--tables")) {
+    num_tables = std::stoul(program.get("--tables"));
+  }
+  if (program.present("--indexes")) {
+    num_indexes = std::stoul(program.get("--indexes"));
+  }
+  if (program.present("--rows")) {
+    num_rows = std::stoul(program.get("--rows"));
+  }
+  if (program.present("--extent-size")) {
+    max_extent_size = std::max<size_t>(std::stoul(program.get("--extent-size")), 1);
+  }
+
+  auto schema = bustub::ParseCreateStatement("a bigint,b varchar(100)");
+  auto key_schema = bustub::ParseCreateStatement("a bigint");
+  bustub::GenericComparator<8> comparator(key_schema.get());
+
+  fmt::print("<<< BEGIN\n");
+  fmt::print("tables={} indexes={} rows={} region_pages={}\n", num_tables, num_indexes, num_rows,
+             BUSTUB_EXTENT_BENCH_REGION_PAGES);
+  fmt::print("{:>10} {:>8} {:>8} {:>8} {:>14} {:>10}\n", "mode", "kind", "pages", "runs", "pages/run", "regions");
+  for (size_t mode_extent_size : {static_cast<size_t>(1), max_extent_size}) {
+    bustub::extent_size = mode_extent_size;
+    auto disk_manager = std::make_unique<bustub::DiskManagerUnlimitedMemory>();
+    auto bpm =
+        std::make_unique<bustub::BufferPoolManagerInstance>(BUSTUB_EXTENT_BENCH_POOL_SIZE, disk_manager.get());
+    bustub::page_id_t header_page_id;
+    bpm->NewPage(&header_page_id);
+    bpm->UnpinPage(header_page_id, false);
+
+    bustub::Transaction txn(0);
+    std::vector<std::unique_ptr<bustub::TableHeap>> tables;
+    std::vector<std::unique_ptr<Tree>> trees;
+    for (size_t i = 0; i < num_tables; i++) {
+      tables.emplace_back(std::make_unique<bustub::TableHeap>(bpm.get(), nullptr, nullptr, &txn));
+    }
+    for (size_t i = 0; i < num_indexes; i++) {
+      trees.emplace_back(std::make_unique<Tree>(fmt::format("index_{}", i), bpm.get(), comparator));
+    }
+
+    // 所有表和索引轮流插入，模拟并发增长的工作负载
+    const std::string payload(100, 'x');
+    bustub::GenericKey<8> key;
+    for (size_t row = 0; row < num_rows; row++) {
+      bustub::Tuple tuple({bustub::ValueFactory::GetBigIntValue(static_cast<int64_t>(row)),
+                           bustub::ValueFactory::GetVarcharValue(payload)},
+                          schema.get());
+      bustub::RID rid;
+      for (auto &table : tables) {
+        table->InsertTuple(tuple, &rid, &txn);
+      }
+      key.SetFromInteger(static_cast<int64_t>(row));
+      for (auto &tree : trees) {
+        tree->Insert(key, rid, &txn);
+      }
+    }
+
+    ChainLayout table_layout;
+    ChainLayout index_layout;
+    for (auto &table : tables) {
+      table_layout.Add(TableChain(table.get(), bpm.get()));
+    }
+    for (auto &tree : trees) {
+      index_layout.Add(LeafChain(tree.get(), bpm.get()));
+    }
+    const std::string mode = mode_extent_size == 1 ? "global" : fmt::format("extent{}", mode_extent_size);
+    PrintLayout(mode, "table", table_layout);
+    PrintLayout(mode, "index", index_layout);
+  }
+  fmt::print(">>> END\n");
+  return 0;
+}
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "common/config.h"
+#include "common/rid.h"
+#include "fmt/core.h"
+#include "storage/index/key_search.h"
+
+static const size_t BUSTUB_KEY_SEARCH_BENCH_PAGES = 4096;
+static const size_t BUSTUB_KEY_SEARCH_BENCH_SEARCHES = 4000000;
+
+/** @return the nanoseconds fn takes per call, over rounds calls */
+template <typename Fn>
+auto NsPerCall(size_t rounds, Fn fn) -> double {
+  const auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < rounds; i++) {
+    fn(i);
+  }
+  const auto elapsed = std::chrono::steady_clock::now() - start;
+  return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+         static_cast<double>(rounds);
+}
+
+/** Search full leaf pages of KeySize-byte integer keys, the way the tree did before and with KeySearch. */
+template <size_t KeySize>
+void Run(size_t num_pages, size_t num_searches) {
+  using KeyType = bustub::GenericKey<KeySize>;
+  // 和叶子页一样，每页放满(key, RID)；只有key参与查找，连续存放
+  const int count = (bustub::BUSTUB_PAGE_SIZE - 32) / (KeySize + sizeof(bustub::RID));
+  std::vector<KeyType> keys(num_pages * count);
+  for (size_t page = 0; page < num_pages; page++) {
+    for (int i = 0; i < count; i++) {
+      keys[page * count + i].SetFromInteger(static_cast<int64_t>(i) * 2);
+    }
+  }
+  std::mt19937_64 gen(0);
+  std::vector<std::pair<size_t, KeyType>> probes(num_searches);
+  for (auto &[page, key] : probes) {
+    page = gen() % num_pages;
+    key.SetFromInteger(static_cast<int64_t>(gen() % (count * 2)));
+  }
+
+  bustub::GenericComparator<KeySize> comparator(nullptr);
+  int64_t sink = 0;
+  auto run = [&](const char *mode, auto search) {
+    const double ns = NsPerCall(num_searches, [&](size_t i) {
+      const auto &[page, key] = probes[i];
+      sink += search(keys.data() + page * count, key);
+    });
+    fmt::print("{:>6} {:>10} {:>8} {:>12.1f}\n", KeySize, mode, count, ns);
+  };
+
+  // 改动前LookupLeaf的写法：每次比较都调用comparator的二分查找
+  run("compare", [&](const KeyType *page_keys, const KeyType &key) {
+    int low = 0;
+    int high = count - 1;
+    while (low <= high) {
+      int mid = low + (high - low) / 2;
+      auto cmp = comparator(page_keys[mid], key);
+      if (cmp == 0) {
+        return mid;
+      }
+      if (cmp < 0) {
+        low = mid + 1;
+      } else {
+        high = mid - 1;
+      }
+    }
+    return low;
+  });
+  if constexpr (KeySize == 4 || KeySize == 8) {
+    run("scalar", [&](const KeyType *page_keys, const KeyType &key) {
+      return bustub::KeySearch::SearchScalar(reinterpret_cast<const char *>(page_keys), count,
+                                             reinterpret_cast<const char *>(&key), KeySize, false);
+    });
+    if (bustub::KeySearch::HasSimdSupport()) {
+      run("simd", [&](const KeyType *page_keys, const KeyType &key) {
+        return bustub::KeySearch::SearchSimd(reinterpret_cast<const char *>(page_keys), count,
+                                             reinterpret_cast<const char *>(&key), KeySize, false);
+      });
+    }
+  }
+  run("default", [&](const KeyType *page_keys, const KeyType &key) {
+    return bustub::KeySearch::LowerBound(page_keys, count, key, comparator);
+  });
+  if (sink == -1) {
+    fmt::print("\n");
+  }
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-key-search-bench");
+  program.add_argument("--pages").help("number of leaf pages the searches are spread over");
+  program.add_argument("--searches").help("number of searches for each key size and mode");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  size_t num_pages = BUSTUB_KEY_SEARCH_BENCH_PAGES;
+  size_t num_searches = BUSTUB_KEY_SEARCH_BENCH_SEARCHES;
+  if (program.present("--pages")) {
+    num_pages = std::max<size_t>(std::stoul(program.get("--pages")), 1);
+  }
+  if (program.present("--searches")) {
+    num_searches = std::max<size_t>(std::stoul(program.get("--searches")), 1);
+  }
+
+  fmt::print("<<< BEGIN\n");
+  fmt::print("pages={} searches={} avx2={}\n", num_pages, num_searches,
+             bustub::KeySearch::HasSimdSupport() ? "yes" : "no");
+  fmt::print("{:>6} {:>10} {:>8} {:>12}\n", "key", "mode", "keys", "ns/search");
+  Run<4>(num_pages, num_searches);
+  Run<8>(num_pages, num_searches);
+  Run<16>(num_pages, num_searches);
+  fmt::print(">>> END\n");
+  return 0;
+}
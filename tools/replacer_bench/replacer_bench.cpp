@@ -0,0 +1,236 @@
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "buffer/arc_replacer.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "buffer/two_queue_replacer.h"
+#include "fmt/core.h"
+
+#include <sys/time.h>
+
+auto ClockMs() -> uint64_t {
+  struct timeval tm;
+  gettimeofday(&tm, nullptr);
+  return static_cast<uint64_t>(tm.tv_sec * 1000) + static_cast<uint64_t>(tm.tv_usec / 1000);
+}
+
+static const uint64_t BUSTUB_REPLACER_BENCH_DURATION_MS = 1000;
+static const size_t BUSTUB_REPLACER_BENCH_K = 2;
+static const double BUSTUB_REPLACER_BENCH_PINNED_RATIO = 0.9;
+static const size_t BUSTUB_REPLACER_BENCH_TRACE_POOL_SIZE = 1024;
+static const size_t BUSTUB_REPLACER_BENCH_TRACE_LENGTH = 1000000;
+
+/**
+ * Drive the replacer the way the buffer pool does: a hit records an access and pins and unpins the frame, a miss
+ * evicts a frame and records the first access of the new page. pinned_ratio of the frames stay pinned all the time,
+ * which is the worst case for a replacer that has to skip over pinned frames. Returns {hit ops/s, miss ops/s}.
+ */
+auto RunReplacer(size_t num_frames, size_t k, double pinned_ratio, uint64_t duration_ms) -> std::pair<double, double> {
+  bustub::LRUKReplacer replacer(num_frames, k);
+  const auto pinned_cnt = static_cast<size_t>(pinned_ratio * static_cast<double>(num_frames));
+  for (size_t i = 0; i < num_frames; i++) {
+    auto frame_id = static_cast<bustub::frame_id_t>(i);
+    replacer.RecordAccess(frame_id);
+    replacer.SetEvictable(frame_id, i >= pinned_cnt);
+  }
+  std::mt19937 gen(0);
+  std::uniform_int_distribution<size_t> dist(pinned_cnt, num_frames - 1);
+
+  uint64_t hits = 0;
+  auto start = ClockMs();
+  while (ClockMs() - start < duration_ms) {
+    for (int i = 0; i < 1000; i++) {
+      auto frame_id = static_cast<bustub::frame_id_t>(dist(gen));
+      replacer.RecordAccess(frame_id);
+      replacer.SetEvictable(frame_id, false);
+      replacer.SetEvictable(frame_id, true);
+    }
+    hits += 1000;
+  }
+  auto hit_elapsed = std::max<uint64_t>(ClockMs() - start, 1);
+
+  uint64_t misses = 0;
+  start = ClockMs();
+  while (ClockMs() - start < duration_ms) {
+    for (int i = 0; i < 1000; i++) {
+      bustub::frame_id_t frame_id;
+      if (!replacer.Evict(&frame_id)) {
+        std::cerr << "nothing to evict" << std::endl;
+        return {0, 0};
+      }
+      replacer.RecordAccess(frame_id);
+    }
+    misses += 1000;
+  }
+  auto miss_elapsed = std::max<uint64_t>(ClockMs() - start, 1);
+  return {static_cast<double>(hits) / static_cast<double>(hit_elapsed) * 1000,
+          static_cast<double>(misses) / static_cast<double>(miss_elapsed) * 1000};
+}
+
+auto MakeReplacer(bustub::ReplacerType type, size_t num_frames, size_t k) -> std::unique_ptr<bustub::Replacer> {
+  switch (type) {
+    case bustub::ReplacerType::LRU_K:
+      return std::make_unique<bustub::LRUKReplacer>(num_frames, k);
+    case bustub::ReplacerType::LRU:
+      return std::make_unique<bustub::LRUReplacer>(num_frames);
+    case bustub::ReplacerType::CLOCK:
+      return std::make_unique<bustub::ClockReplacer>(num_frames);
+    case bustub::ReplacerType::TWO_Q:
+      return std::make_unique<bustub::TwoQueueReplacer>(num_frames);
+    case bustub::ReplacerType::ARC:
+      return std::make_unique<bustub::ArcReplacer>(num_frames);
+  }
+  return nullptr;
+}
+
+/** Read a page access trace: page ids separated by whitespace. */
+auto LoadTrace(const std::string &path) -> std::vector<bustub::page_id_t> {
+  std::ifstream in(path);
+  std::vector<bustub::page_id_t> trace;
+  bustub::page_id_t page_id;
+  while (in >> page_id) {
+    trace.push_back(page_id);
+  }
+  return trace;
+}
+
+/**
+ * Synthetic traces for when no trace file is given, each on a database four times the size of the pool:
+ * zipf-like point lookups, the same lookups interleaved with a sequential scan over the whole database, and a loop
+ * over slightly more pages than the pool holds, the worst case of LRU.
+ */
+auto MakeTraces(size_t pool_size, size_t length) -> std::vector<std::pair<std::string, std::vector<bustub::page_id_t>>> {
+  const size_t db_pages = 4 * pool_size;
+  std::mt19937 gen(0);
+  // 按指数分布取page，少数page占大部分访问
+  std::exponential_distribution<double> skew(8.0 / static_cast<double>(db_pages));
+  auto skewed_page = [&] { return static_cast<bustub::page_id_t>(static_cast<size_t>(skew(gen)) % db_pages); };
+
+  std::vector<bustub::page_id_t> lookups;
+  std::vector<bustub::page_id_t> lookups_and_scan;
+  std::vector<bustub::page_id_t> loop;
+  size_t scan_pos = 0;
+  for (size_t i = 0; i < length; i++) {
+    lookups.push_back(skewed_page());
+    lookups_and_scan.push_back(i % 2 == 0 ? skewed_page() : static_cast<bustub::page_id_t>(scan_pos++ % db_pages));
+    loop.push_back(static_cast<bustub::page_id_t>(i % (pool_size + pool_size / 10)));
+  }
+  return {{"zipf", std::move(lookups)}, {"zipf+scan", std::move(lookups_and_scan)}, {"loop", std::move(loop)}};
+}
+
+/**
+ * Replay a trace through a buffer pool of pool_size frames using the given replacer: a hit records an access and pins
+ * and unpins the frame, a miss takes a free frame or evicts one. Returns {hit ratio, ns per access}.
+ */
+auto ReplayTrace(bustub::Replacer *replacer, size_t pool_size, const std::vector<bustub::page_id_t> &trace)
+    -> std::pair<double, double> {
+  std::unordered_map<bustub::page_id_t, bustub::frame_id_t> page_table;
+  std::vector<bustub::page_id_t> frame_pages(pool_size, bustub::INVALID_PAGE_ID);
+  size_t next_free_frame = 0;
+  uint64_t hits = 0;
+
+  auto start = std::chrono::steady_clock::now();
+  for (auto page_id : trace) {
+    auto it = page_table.find(page_id);
+    if (it != page_table.end()) {
+      hits++;
+      replacer->RecordAccess(it->second, page_id);
+      replacer->SetEvictable(it->second, false);
+      replacer->SetEvictable(it->second, true);
+      continue;
+    }
+    bustub::frame_id_t frame_id;
+    if (next_free_frame < pool_size) {
+      frame_id = static_cast<bustub::frame_id_t>(next_free_frame++);
+    } else {
+      if (!replacer->Evict(&frame_id)) {
+        return {0, 0};
+      }
+      page_table.erase(frame_pages[frame_id]);
+    }
+    page_table[page_id] = frame_id;
+    frame_pages[frame_id] = page_id;
+    replacer->RecordAccess(frame_id, page_id);
+  }
+  auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+  return {static_cast<double>(hits) / static_cast<double>(std::max<size_t>(trace.size(), 1)),
+          elapsed / static_cast<double>(std::max<size_t>(trace.size(), 1))};
+}
+
+// NOLINTNEXTLINE
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-replacer-bench");
+  program.add_argument("--duration").help("run each configuration for n milliseconds");
+  program.add_argument("--k").help("lookback constant k of the LRU-K replacer");
+  program.add_argument("--pinned-ratio").help("fraction of the frames that stay pinned");
+  program.add_argument("--trace").help("file with a page access trace to replay, page ids separated by whitespace");
+  program.add_argument("--trace-pool-size").help("number of frames to replay the traces with");
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  uint64_t duration_ms = BUSTUB_REPLACER_BENCH_DURATION_MS;
+  size_t k = BUSTUB_REPLACER_BENCH_K;
+  double pinned_ratio = BUSTUB_REPLACER_BENCH_PINNED_RATIO;
+  if (program.present("--duration")) {
+    duration_ms = std::stoul(program.get("--duration"));
+  }
+  if (program.present("--k")) {
+    k = std::stoul(program.get("--k"));
+  }
+  if (program.present("--pinned-ratio")) {
+    pinned_ratio = std::stod(program.get("--pinned-ratio"));
+  }
+
+  fmt::print("<<< BEGIN\n");
+  fmt::print("k={} pinned_ratio={} duration_ms={}\n", k, pinned_ratio, duration_ms);
+  fmt::print("{:>10} {:>16} {:>16}\n", "frames", "hit ops/s", "evict ops/s");
+  for (size_t num_frames : {10000, 100000, 1000000}) {
+    auto [hit_ops, miss_ops] = RunReplacer(num_frames, k, pinned_ratio, duration_ms);
+    fmt::print("{:>10} {:>16.0f} {:>16.0f}\n", num_frames, hit_ops, miss_ops);
+  }
+
+  size_t trace_pool_size = BUSTUB_REPLACER_BENCH_TRACE_POOL_SIZE;
+  if (program.present("--trace-pool-size")) {
+    trace_pool_size = std::stoul(program.get("--trace-pool-size"));
+  }
+  std::vector<std::pair<std::string, std::vector<bustub::page_id_t>>> traces;
+  if (program.present("--trace")) {
+    traces.emplace_back(program.get("--trace"), LoadTrace(program.get("--trace")));
+  } else {
+    traces = MakeTraces(trace_pool_size, BUSTUB_REPLACER_BENCH_TRACE_LENGTH);
+  }
+  const std::vector<std::pair<std::string, bustub::ReplacerType>> policies = {{"lru-k", bustub::ReplacerType::LRU_K},
+                                                                              {"lru", bustub::ReplacerType::LRU},
+                                                                              {"clock", bustub::ReplacerType::CLOCK},
+                                                                              {"2q", bustub::ReplacerType::TWO_Q},
+                                                                              {"arc", bustub::ReplacerType::ARC}};
+  fmt::print("trace replay: pool_size={}\n", trace_pool_size);
+  fmt::print("{:>12} {:>8} {:>10} {:>10}\n", "trace", "policy", "hit ratio", "ns/op");
+  for (const auto &[trace_name, trace] : traces) {
+    for (const auto &[policy_name, type] : policies) {
+      auto replacer = MakeReplacer(type, trace_pool_size, k);
+      auto [hit_ratio, ns_per_op] = ReplayTrace(replacer.get(), trace_pool_size, trace);
+      fmt::print("{:>12} {:>8} {:>10.4f} {:>10.1f}\n", trace_name, policy_name, hit_ratio, ns_per_op);
+    }
+  }
+  fmt::print(">>> END\n");
+
+  return 0;
+}
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <stdexcept>
 #include <string>
 #include "binder/binder.h"
 #include "common/bustub_instance.h"
@@ -27,24 +28,42 @@ auto GetWidthOfUtf8(const void *beg, const void *end, size_t *width) -> int {
 auto main(int argc, char **argv) -> int {
   ft_set_u8strwid_func(&GetWidthOfUtf8);
 
-  auto bustub = std::make_unique<bustub::BustubInstance>("test.db");
-
   auto default_prompt = "bustub> ";
   auto emoji_prompt = "\U0001f6c1> ";  // the bathtub emoji
   bool use_emoji_prompt = false;
   bool disable_tty = false;
+  bool read_only = false;
+  size_t buffer_pool_size = bustub::DEFAULT_INSTANCE_BUFFER_POOL_SIZE;
 
   for (int i = 1; i < argc; i++) {
     if (strcmp(argv[i], "--emoji-prompt") == 0) {
       use_emoji_prompt = true;
-      break;
-    }
-    if (strcmp(argv[i], "--disable-tty") == 0) {
+    } else if (strcmp(argv[i], "--disable-tty") == 0) {
       disable_tty = true;
-      break;
+    } else if (strcmp(argv[i], "--read-only") == 0) {
+      read_only = true;
+    } else if (strcmp(argv[i], "--buffer-pool-size") == 0 && i + 1 < argc) {
+      try {
+        buffer_pool_size = std::stoul(argv[++i]);
+      } catch (const std::logic_error &e) {
+        buffer_pool_size = 0;
+      }
+      if (buffer_pool_size == 0) {
+        std::cerr << "--buffer-pool-size expects a positive number of frames" << std::endl;
+        return 1;
+      }
     }
   }
 
+  std::unique_ptr<bustub::BustubInstance> bustub;
+  try {
+    bustub = std::make_unique<bustub::BustubInstance>("test.db", buffer_pool_size, read_only);
+  } catch (const bustub::Exception &ex) {
+    // a read-only instance needs an existing database file
+    std::cerr << ex.what() << std::endl;
+    return 1;
+  }
+
   bustub->GenerateMockTable();
 
   if (bustub->buffer_pool_manager_ != nullptr) {